@@ -0,0 +1,241 @@
+//---------------------------------------------------------------------
+
+/*
+    Per cookie memory arena
+
+    Everything a registered file allocates comes from its own arena,
+    and the arena gets its memory from the allocator set with
+    BorDebugSetAllocator.  Small blocks are carved out of chunks and
+    only given back when the whole arena is released.  Large blocks,
+    like the name index and the sstNames copy, get a chunk of their
+    own, which is given back as soon as it is freed, so a vector that
+    grows doesn't leave its old storage behind.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdlib.h>
+
+#include <mutex>
+#include <new>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_ARENA_CHUNK  = 0x10000,
+    BD_ARENA_LARGE  = 0x4000,
+    BD_ARENA_ALIGN  = 16,
+};
+
+
+/*
+    Every chunk starts with one of these, and all chunks of an arena
+    are on a list, so they can be given back one by one.
+*/
+
+struct BdChunk
+{
+    BdChunk *   prev;
+    BdChunk *   next;
+    size_t      size;
+    size_t      pad;
+};
+
+
+struct BdArena
+{
+    std::mutex          lock;
+    BorDebugAllocator   allocator;          // the one the chunks came from
+    BdChunk *           chunks;
+    char *              next;               // free space in the last small chunk
+    char *              end;
+    uint64_t            size;               // of all chunks
+};
+
+
+// Neither has a destructor, so both stay usable for the watcher
+// thread while the process exits
+static std::mutex           bdAllocatorLock;
+static BorDebugAllocator    bdAllocator;
+
+
+static void *   bdMalloc(void *, size_t size)
+{
+    return malloc(size);
+}
+
+
+static void bdFree(void *, void * block, size_t)
+{
+    free(block);
+}
+
+
+static size_t   bdAlign(size_t size)
+{
+    return (size + BD_ARENA_ALIGN - 1) & ~(size_t)(BD_ARENA_ALIGN - 1);
+}
+
+
+// A new chunk with room for "size" bytes, on the chunk list.
+// The caller holds the lock, if there is one.
+static BdChunk *    bdNewChunk(BdArena * arena, const BorDebugAllocator & allocator, size_t size)
+{
+    if  (size > SIZE_MAX - sizeof(BdChunk))
+        throw std::bad_alloc();
+
+    BdChunk * chunk = static_cast<BdChunk *>(allocator.alloc(allocator.context, sizeof(BdChunk) + size));
+
+    if  (!chunk)
+        throw std::bad_alloc();
+
+    chunk->prev = 0;
+    chunk->next = arena ? arena->chunks : 0;
+    chunk->size = sizeof(BdChunk) + size;
+
+    if  (arena)
+    {
+        arena->size += chunk->size;
+
+        if  (arena->chunks)
+            arena->chunks->prev = chunk;
+
+        arena->chunks = chunk;
+    }
+
+    return chunk;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    The arena lives at the start of its first chunk.
+*/
+
+BdArena *   bdArenaCreate()
+{
+    BorDebugAllocator   allocator;
+
+    {
+        std::lock_guard<std::mutex> hold(bdAllocatorLock);
+
+        allocator = bdAllocator;
+    }
+
+    if  (!allocator.alloc)
+    {
+        allocator.alloc   = bdMalloc;
+        allocator.free    = bdFree;
+        allocator.context = 0;
+    }
+
+    BdChunk   * first = bdNewChunk(0, allocator, BD_ARENA_CHUNK);
+    char      * start = reinterpret_cast<char *>(first + 1);
+    BdArena   * arena = new (start) BdArena();
+
+    arena->allocator = allocator;
+    arena->chunks    = first;
+    arena->size      = first->size;
+    arena->next      = start + bdAlign(sizeof(BdArena));
+    arena->end       = start + BD_ARENA_CHUNK;
+
+    return arena;
+}
+
+
+void *  bdArenaAlloc(BdArena * arena, size_t size)
+{
+    if  (!arena)
+        return ::operator new(size);
+
+    std::lock_guard<std::mutex> hold(arena->lock);
+
+    if  (size > BD_ARENA_LARGE)
+        return bdNewChunk(arena, arena->allocator, size) + 1;
+
+    size = bdAlign(size ? size : 1);
+
+    if  (size > (size_t)(arena->end - arena->next))
+    {
+        BdChunk * chunk = bdNewChunk(arena, arena->allocator, BD_ARENA_CHUNK);
+
+        arena->next = reinterpret_cast<char *>(chunk + 1);
+        arena->end  = arena->next + BD_ARENA_CHUNK;
+    }
+
+    void    * block = arena->next;
+
+    arena->next += size;
+    return block;
+}
+
+
+void    bdArenaFree(BdArena * arena, void * block, size_t size)
+{
+    if  (!arena)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    if  (!block || size <= BD_ARENA_LARGE)
+        return;
+
+    std::lock_guard<std::mutex> hold(arena->lock);
+
+    BdChunk * chunk = static_cast<BdChunk *>(block) - 1;
+
+    if  (chunk->prev)
+        chunk->prev->next = chunk->next;
+    else
+        arena->chunks = chunk->next;
+
+    if  (chunk->next)
+        chunk->next->prev = chunk->prev;
+
+    arena->size -= chunk->size;
+
+    arena->allocator.free(arena->allocator.context, chunk, chunk->size);
+}
+
+
+uint64_t    bdArenaSize(BdArena * arena)
+{
+    std::lock_guard<std::mutex> hold(arena->lock);
+
+    return arena->size;
+}
+
+
+void    bdArenaRelease(BdArena * arena)
+{
+    BorDebugAllocator   allocator = arena->allocator;
+    BdChunk           * chunk     = arena->chunks;
+
+    // the arena itself is in the last chunk on the list
+    arena->~BdArena();
+
+    while (chunk)
+    {
+        BdChunk * next = chunk->next;
+
+        allocator.free(allocator.context, chunk, chunk->size);
+        chunk = next;
+    }
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugSetAllocator(const BorDebugAllocator * allocator)
+{
+    std::lock_guard<std::mutex> hold(bdAllocatorLock);
+
+    if  (allocator && allocator->alloc && allocator->free)
+        bdAllocator = *allocator;
+    else
+        bdAllocator = BorDebugAllocator();
+}
@@ -0,0 +1,771 @@
+//---------------------------------------------------------------------
+
+/*
+    Index cache
+
+    The type and name indexes of a file are kept in a sidecar file,
+    so a later registration of the same, unchanged file maps them
+    instead of scanning sstGlobalTypes and sstNames again.
+
+    The sidecar is "<file>.bdx" next to the file, or a file in the
+    directory set with BorDebugSetIndexCacheDir.  It is written in
+    native byte order, and is only used on machines of the same
+    byte order:
+
+        DWORD   magic           'BDX1'
+        DWORD   cbHeader        size of the header, with the stamps
+        QWORD   fileSize        size of the debug file
+        DWORD   typesSignature  signature of sstGlobalTypes
+        DWORD   typesDeclared   cTypes of sstGlobalTypes
+        DWORD   namesSize       size of sstNames
+        DWORD   namesDeclared   cNames of sstNames
+        DWORD   cModules
+        DWORD   cTypes          entries in typeOffsets
+        DWORD   cNames          entries in nameOffsets
+        DWORD   stamps[cModules]
+        DWORD   typeOffsets[cTypes]
+        DWORD   nameOffsets[cNames]
+
+    Everything up to the stamps is the key: when any of it differs
+    from the debug file, the sidecar is built again.
+
+    BORDEBUG_REGISTER_SHAREDINDEX keeps the same layout in shared
+    memory instead, see below.
+*/
+
+//---------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_CACHE_MAGIC      = 0x31584442,       // 'BDX1'
+    BD_CACHE_HEADER     = 48,
+};
+
+
+struct BdCacheKey
+{
+    uint64_t                fileSize;
+    uint32_t                typesSignature;
+    uint32_t                typesDeclared;
+    uint32_t                namesSize;
+    uint32_t                namesDeclared;
+    std::vector<uint32_t>   stamps;
+};
+
+
+struct BdCacheDir
+{
+    std::mutex      lock;
+    std::string     dir;                // see BorDebugSetIndexCacheDir
+};
+
+
+// Never destroyed: the watcher thread may still register files while
+// the process exits
+static BdCacheDir & bdCacheDir()
+{
+    static BdCacheDir   * cacheDir = new BdCacheDir();
+
+    return *cacheDir;
+}
+
+
+static bool bdReadKey(BdFile * f, BdCacheKey & key)
+{
+    const BdSubSection  * types = bdFindSubSection(f, BORDEBUG_SSTGLOBALTYPES);
+    const BdSubSection  * names = bdFindSubSection(f, BORDEBUG_SSTNAMES);
+    unsigned char         buf[8];
+
+    memset(buf, 0, sizeof(buf));
+
+    key.fileSize       = f->fileSize;
+    key.typesSignature = 0;
+    key.typesDeclared  = 0;
+    key.namesSize      = 0;
+    key.namesDeclared  = 0;
+
+    if  (types && types->size >= 8)
+    {
+        if  (!bdReadAt(f, types->offset, buf, 8))
+            return false;
+
+        key.typesSignature = bdGet32(buf);
+        key.typesDeclared  = bdGet32(buf + 4);
+    }
+
+    if  (names && names->size >= 4)
+    {
+        if  (!bdReadAt(f, names->offset, buf, 4))
+            return false;
+
+        key.namesSize     = names->size;
+        key.namesDeclared = bdGet32(buf);
+    }
+
+    bdModuleTimeStamps(f, key.stamps);
+    return true;
+}
+
+
+static void bdKeyHeader(const BdCacheKey & key, uint32_t * header)
+{
+    header[0]  = BD_CACHE_MAGIC;
+    header[1]  = (uint32_t)(BD_CACHE_HEADER + key.stamps.size() * 4);
+    header[2]  = (uint32_t)key.fileSize;
+    header[3]  = (uint32_t)(key.fileSize >> 32);
+    header[4]  = key.typesSignature;
+    header[5]  = key.typesDeclared;
+    header[6]  = key.namesSize;
+    header[7]  = key.namesDeclared;
+    header[8]  = (uint32_t)key.stamps.size();
+    header[9]  = 0;
+    header[10] = 0;
+    header[11] = 0;
+}
+
+
+// FNV-1a, to give every debug file its own name in the cache directory
+static uint64_t bdHashPath(const char * path)
+{
+    uint64_t    hash = 0xcbf29ce484222325ULL;
+
+    for (; *path; path++)
+    {
+        hash ^= (unsigned char)*path;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+/*
+    The options that change what goes into the indexes, so that each
+    combination gets a sidecar and a shared object of its own
+*/
+
+enum
+{
+    BD_INDEX_OPTIONS    = BORDEBUG_REGISTER_SKIPMODULES | BORDEBUG_REGISTER_SKIPTYPES,
+};
+
+
+static std::string bdSidecarName(const BdFile * f)
+{
+    std::string     dir;
+    char            suffix[16] = ".bdx";
+
+    if  (f->options & BD_INDEX_OPTIONS)
+        snprintf(suffix, sizeof(suffix), "-%03x.bdx", f->options & BD_INDEX_OPTIONS);
+
+    {
+        BdCacheDir                & cacheDir = bdCacheDir();
+        std::lock_guard<std::mutex> hold(cacheDir.lock);
+
+        dir = cacheDir.dir;
+    }
+
+    if  (dir.empty())
+        return f->path + suffix;
+
+    char            full[PATH_MAX];
+    const char    * path  = realpath(f->path.c_str(), full) ? full : f->path.c_str();
+    const char    * slash = strrchr(path, '/');
+    char            hash[40];
+
+    snprintf(hash, sizeof(hash), ".%016llx%s", (unsigned long long)bdHashPath(path), suffix);
+
+    return dir + "/" + (slash ? slash + 1 : path) + hash;
+}
+
+
+/*
+    Point the indexes into a mapped sidecar, when its key matches and
+    its contents are sane.  The caller owns the mapping.
+*/
+
+static bool bdAttachIndex(BdFile * f, void * map, size_t size, const BdCacheKey & key)
+{
+    if  (size < BD_CACHE_HEADER)
+        return false;
+
+    const uint32_t  * p = static_cast<const uint32_t *>(map);
+    uint32_t          want[BD_CACHE_HEADER / 4];
+
+    bdKeyHeader(key, want);
+
+    uint64_t    types = p[9];
+    uint64_t    names = p[10];
+
+    bool    valid = memcmp(p, want, 9 * 4) == 0 &&
+                    size == want[1] + (types + names) * 4 &&
+                    memcmp(p + BD_CACHE_HEADER / 4, key.stamps.data(), key.stamps.size() * 4) == 0 &&
+                    types <= key.typesDeclared &&
+                    names <= key.namesDeclared;
+
+    const uint32_t      * typeIndex = p + want[1] / 4;
+    const uint32_t      * nameIndex = typeIndex + types;
+    const BdSubSection  * typesSub  = bdFindSubSection(f, BORDEBUG_SSTGLOBALTYPES);
+    const BdSubSection  * namesSub  = bdFindSubSection(f, BORDEBUG_SSTNAMES);
+
+    // the type records that follow the offset table; each offset must
+    // leave room for the length and kind of its record
+    uint64_t    typesData = 0;
+
+    if  (valid && types)
+    {
+        if  (!typesSub || typesSub->size < 8 + (uint64_t)key.typesDeclared * 4)
+            valid = false;
+        else
+            typesData = typesSub->size - 8 - (uint64_t)key.typesDeclared * 4;
+    }
+
+    for (uint32_t i = 0; valid && i < types; i++)
+    {
+        if  ((uint64_t)typeIndex[i] + 4 > typesData || (i && typeIndex[i] <= typeIndex[i - 1]))
+            valid = false;
+    }
+
+    // bdNameSpan relies on the name offsets going up
+    for (uint32_t i = 0; valid && i < names; i++)
+    {
+        if  (nameIndex[i] >= key.namesSize || (i && nameIndex[i] <= nameIndex[i - 1]))
+            valid = false;
+    }
+
+    if  (!valid)
+        return false;
+
+    if  (typesSub)
+    {
+        f->typesOffset    = typesSub->offset;
+        f->typesSize      = typesSub->size;
+        f->typesSignature = key.typesSignature;
+        f->typesData      = typesSub->offset + 8 + (uint64_t)key.typesDeclared * 4;
+    }
+
+    if  (namesSub)
+    {
+        f->namesOffset = namesSub->offset;
+        f->namesSize   = namesSub->size;
+    }
+
+    f->typeCount = (uint32_t)types;
+    f->typeIndex = typeIndex;
+    f->nameCount = (uint32_t)names;
+    f->nameIndex = nameIndex;
+
+    return true;
+}
+
+
+// Keep the mapping the indexes point into, instead of any earlier one
+static void bdKeepMap(BdFile * f, void * map, size_t size)
+{
+    if  (f->cacheMapSize)
+        munmap(f->cacheMap, f->cacheMapSize);
+
+    f->cacheMap     = map;
+    f->cacheMapSize = size;
+}
+
+
+// Map a whole file or shared memory object read-only
+static void *   bdMapAll(int fd, size_t * size)
+{
+    struct stat     st;
+
+    if  (fstat(fd, &st) != 0 || st.st_size < BD_CACHE_HEADER || (uint64_t)st.st_size > SIZE_MAX)
+        return MAP_FAILED;
+
+    *size = (size_t)st.st_size;
+
+    return mmap(0, *size, PROT_READ, MAP_SHARED, fd, 0);
+}
+
+
+static bool bdMapSidecar(BdFile * f, const std::string & name, const BdCacheKey & key)
+{
+    int fd = open(name.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if  (fd < 0)
+        return false;
+
+    size_t    size;
+    void    * map = bdMapAll(fd, &size);
+
+    close(fd);
+
+    if  (map == MAP_FAILED)
+        return false;
+
+    if  (!bdAttachIndex(f, map, size, key))
+    {
+        munmap(map, size);
+        return false;
+    }
+
+    bdKeepMap(f, map, size);
+    return true;
+}
+
+
+/*
+    The pieces of a sidecar, in order.  The header array must have
+    BD_CACHE_HEADER / 4 entries.
+*/
+
+struct BdPart
+{
+    const void  * data;
+    size_t        size;
+};
+
+
+static void bdSidecarParts(const BdFile * f, const BdCacheKey & key, uint32_t * header, BdPart * parts)
+{
+    bdKeyHeader(key, header);
+    header[9]  = f->typeCount;
+    header[10] = f->nameCount;
+
+    parts[0].data = header;             parts[0].size = BD_CACHE_HEADER;
+    parts[1].data = key.stamps.data();  parts[1].size = key.stamps.size() * 4;
+    parts[2].data = f->typeIndex;       parts[2].size = (size_t)f->typeCount * 4;
+    parts[3].data = f->nameIndex;       parts[3].size = (size_t)f->nameCount * 4;
+}
+
+
+/*
+    Write the sidecar under a temporary name and rename it, so a
+    reader never sees half of it.  Failing to write it is not an
+    error, the next registration just builds the indexes again.
+*/
+
+static void bdWriteSidecar(const BdFile * f, const std::string & name, const BdCacheKey & key)
+{
+    static std::atomic<unsigned int>    serial(0);
+
+    char    suffix[48];
+
+    snprintf(suffix, sizeof(suffix), ".%ld.%u.tmp", (long)getpid(), serial++);
+
+    std::string     temp = name + suffix;
+    int             fd   = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+
+    if  (fd < 0)
+        return;
+
+    uint32_t    header[BD_CACHE_HEADER / 4];
+    BdPart      parts[4];
+    bool        ok = true;
+
+    bdSidecarParts(f, key, header, parts);
+
+    for (size_t i = 0; ok && i < 4; i++)
+    {
+        const char  * p   = static_cast<const char *>(parts[i].data);
+        size_t        len = parts[i].size;
+
+        while (ok && len)
+        {
+            ssize_t done = write(fd, p, len);
+
+            ok   = done > 0;
+            p   += ok ? done : 0;
+            len -= ok ? (size_t)done : 0;
+        }
+    }
+
+    if  (close(fd) != 0)
+        ok = false;
+
+    if  (!ok || rename(temp.c_str(), name.c_str()) != 0)
+        unlink(temp.c_str());
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Shared memory index, see BORDEBUG_REGISTER_SHAREDINDEX
+
+    The same layout as a sidecar, in a POSIX shared memory object
+    named after the file and the options that change the key.  The
+    process that creates the object holds an exclusive flock on it
+    until it is filled in, and stores the magic last.  Other processes
+    take a shared flock before they map it, so they wait for the
+    writer instead of building their own.
+
+    An object is only removed by a process that holds the exclusive
+    flock on it and has checked that the name still refers to it:
+
+    - one with a different key belongs to an older version of the
+      file;
+    - one that is still empty after a few tries was left behind by a
+      writer that died.
+
+    An empty object may also be one whose writer is between shm_open
+    and flock, so empty objects get some time first.  A writer that
+    finds its new object was removed in that window just starts over.
+    Processes that have an old object mapped keep using it.
+*/
+
+enum
+{
+    BD_SHARED_TRIES     = 20,
+    BD_SHARED_EMPTY     = 10,       // tries before an empty object is stale
+    BD_SHARED_WAIT      = 2000,     // microseconds between tries
+};
+
+
+enum BdSharedState
+{
+    BD_SHARED_MAPPED,
+    BD_SHARED_MISSING,
+    BD_SHARED_EMPTY_NOW,
+};
+
+
+static std::string  bdSharedName(const char * fileName, unsigned int options)
+{
+    char    full[PATH_MAX];
+    char    name[64];
+
+    snprintf(name, sizeof(name), "/bordebug-%016llx-%03x",
+             (unsigned long long)bdHashPath(realpath(fileName, full) ? full : fileName),
+             options & BD_INDEX_OPTIONS);
+
+    return name;
+}
+
+
+// Whether name still refers to the object open at fd
+static bool bdSameShared(int fd, const std::string & name)
+{
+    int     other = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+
+    if  (other < 0)
+        return false;
+
+    struct stat     mine;
+    struct stat     theirs;
+    bool            same = fstat(fd, &mine) == 0 && fstat(other, &theirs) == 0 &&
+                           mine.st_dev == theirs.st_dev && mine.st_ino == theirs.st_ino;
+
+    close(other);
+    return same;
+}
+
+
+// Whether the object at fd has no magic yet
+static bool bdSharedEmpty(int fd)
+{
+    uint32_t    magic = 0;
+
+    return pread(fd, &magic, sizeof(magic), 0) != (ssize_t)sizeof(magic) ||
+           magic != BD_CACHE_MAGIC;
+}
+
+
+/*
+    Remove a stale object: with the exclusive flock, if the name still
+    refers to it, and, for one that was empty, if it still is.
+*/
+
+static void bdRemoveShared(int fd, const std::string & name, bool empty)
+{
+    flock(fd, LOCK_EX);
+
+    if  ((!empty || bdSharedEmpty(fd)) && bdSameShared(fd, name))
+        shm_unlink(name.c_str());
+
+    flock(fd, LOCK_UN);
+}
+
+
+static BdSharedState    bdAttachShared(BdFile * f, const std::string & name,
+                                       const BdCacheKey & key, bool giveUp)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+
+    if  (fd < 0)
+        return BD_SHARED_MISSING;
+
+    size_t    size = 0;
+    void    * map;
+
+    flock(fd, LOCK_SH);
+    map = bdMapAll(fd, &size);
+    flock(fd, LOCK_UN);
+
+    if  (map != MAP_FAILED)
+    {
+        const uint32_t  * magic = static_cast<const uint32_t *>(map);
+
+        if  (__atomic_load_n(magic, __ATOMIC_ACQUIRE) == BD_CACHE_MAGIC)
+        {
+            if  (bdAttachIndex(f, map, size, key))
+            {
+                close(fd);
+                bdKeepMap(f, map, size);
+                return BD_SHARED_MAPPED;
+            }
+
+            // the key differs: an object for an older version of the file
+            munmap(map, size);
+            bdRemoveShared(fd, name, false);
+            close(fd);
+            return BD_SHARED_MISSING;
+        }
+
+        munmap(map, size);
+    }
+
+    if  (giveUp)
+        bdRemoveShared(fd, name, true);
+
+    close(fd);
+    return giveUp ? BD_SHARED_MISSING : BD_SHARED_EMPTY_NOW;
+}
+
+
+/*
+    The new object, locked, or -1 if it exists already or can't be
+    made.  If it was removed before the flock was in place, this is
+    -1 as well and the caller tries again.
+*/
+
+static int  bdCreateShared(const std::string & name)
+{
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+
+    if  (fd < 0)
+        return -1;
+
+    flock(fd, LOCK_EX);
+
+    if  (!bdSameShared(fd, name))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+
+/*
+    Fill in a new shared memory object from the indexes just built or
+    mapped from the sidecar, then use the shared copy and drop our own.
+*/
+
+static bool bdFillShared(BdFile * f, int fd, const BdCacheKey & key)
+{
+    uint32_t    header[BD_CACHE_HEADER / 4];
+    BdPart      parts[4];
+    size_t      size = 0;
+
+    bdSidecarParts(f, key, header, parts);
+
+    for (size_t i = 0; i < 4; i++)
+        size += parts[i].size;
+
+    if  (ftruncate(fd, (off_t)size) != 0)
+        return false;
+
+    void    * map = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if  (map == MAP_FAILED)
+        return false;
+
+    char    * p = static_cast<char *>(map);
+
+    header[0] = 0;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        if  (parts[i].size)
+            memcpy(p, parts[i].data, parts[i].size);
+
+        p += parts[i].size;
+    }
+
+    __atomic_store_n(static_cast<uint32_t *>(map), (uint32_t)BD_CACHE_MAGIC, __ATOMIC_RELEASE);
+    mprotect(map, size, PROT_READ);
+
+    if  (!bdAttachIndex(f, map, size, key))
+    {
+        munmap(map, size);
+        return false;
+    }
+
+    bdKeepMap(f, map, size);
+
+    BdVector<uint32_t>(f->indexArena).swap(f->typeOffsets);
+    BdVector<uint32_t>(f->indexArena).swap(f->nameOffsets);
+
+    return true;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Both indexes are stored together, so the cache is only used when
+    both are wanted, and only for files that have a name.
+*/
+
+static bool bdCacheApplies(const BdFile * f)
+{
+    return (f->options & (BORDEBUG_REGISTER_INDEXCACHE | BORDEBUG_REGISTER_SHAREDINDEX)) &&
+           !(f->options & BORDEBUG_REGISTER_SKIPNAMES) &&
+           !f->path.empty();
+}
+
+
+static void bdUseCache(BdFile * f, unsigned int * result)
+{
+    bool            shared  = (f->options & BORDEBUG_REGISTER_SHAREDINDEX) != 0;
+    bool            sidecar = (f->options & BORDEBUG_REGISTER_INDEXCACHE) != 0;
+    BdCacheKey      key;
+    std::string     sharedName;
+    std::string     sidecarName;
+    int             shm     = -1;
+    bool            mapped  = false;
+
+    if  (!bdReadKey(f, key))
+        return;
+
+    if  (shared)
+    {
+        sharedName = bdSharedName(f->path.c_str(), f->options);
+
+        // when another process creates the object first, wait for it
+        for (int tries = 0, empty = 0; !mapped && shm < 0 && tries < BD_SHARED_TRIES; tries++)
+        {
+            BdSharedState   state = bdAttachShared(f, sharedName, key, empty >= BD_SHARED_EMPTY);
+
+            mapped = state == BD_SHARED_MAPPED;
+
+            if  (state == BD_SHARED_MISSING)
+                shm = bdCreateShared(sharedName);
+            else if (state == BD_SHARED_EMPTY_NOW)
+            {
+                empty++;
+                usleep(BD_SHARED_WAIT);
+            }
+        }
+    }
+
+    if  (sidecar && !mapped)
+    {
+        sidecarName = bdSidecarName(f);
+        mapped      = bdMapSidecar(f, sidecarName, key);
+    }
+
+    if  (!mapped)
+    {
+        *result = bdBuildIndexes(f);
+
+        if  (*result == BD_FAIL_NONE && sidecar)
+            bdWriteSidecar(f, sidecarName, key);
+    }
+    else if ((f->options & BORDEBUG_REGISTER_CACHENAMES) && !f->image && f->namesSize &&
+             (!f->budget || f->namesSize <= f->budget))
+    {
+        // the name text, which isn't in the sidecar
+        BdVector<char>  names(f->namesSize, 0, f->indexArena);
+
+        if  (bdReadAt(f, f->namesOffset, &names[0], names.size()))
+        {
+            f->nameCache.swap(names);
+            f->nameText = f->nameCache.data();
+        }
+    }
+
+    // still holding the exclusive flock, so no other process removes it
+    if  (shm >= 0)
+    {
+        if  ((*result != BD_FAIL_NONE || !bdFillShared(f, shm, key)) &&
+             bdSameShared(shm, sharedName))
+            shm_unlink(sharedName.c_str());
+
+        flock(shm, LOCK_UN);
+        close(shm);
+    }
+
+    f->cacheUsed = true;
+}
+
+
+//---------------------------------------------------------------------
+
+bool    bdUseIndexCache(BdFile * f, unsigned int * result)
+{
+    *result = BD_FAIL_NONE;
+
+    if  (!bdCacheApplies(f))
+        return false;
+
+    std::call_once(f->cacheOnce, [f, result]
+    {
+        try
+        {
+            bdUseCache(f, result);
+        }
+        catch (const std::bad_alloc &)
+        {
+        }
+    });
+
+    return f->cacheUsed;
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugSetIndexCacheDir(const char * dir)
+{
+    BdCacheDir                & cacheDir = bdCacheDir();
+    std::lock_guard<std::mutex> hold(cacheDir.lock);
+
+    cacheDir.dir = dir ? dir : "";
+
+    while (cacheDir.dir.size() > 1 && cacheDir.dir[cacheDir.dir.size() - 1] == '/')
+        cacheDir.dir.erase(cacheDir.dir.size() - 1);
+}
+
+
+void    BorDebugRemoveSharedIndex(const char * fileName)
+{
+    if  (!fileName)
+        return;
+
+    // every combination of the options that are part of the name
+    for (unsigned int options = 0; ; options = (options - BD_INDEX_OPTIONS) & BD_INDEX_OPTIONS)
+    {
+        shm_unlink(bdSharedName(fileName, options).c_str());
+
+        if  (options == BD_INDEX_OPTIONS)
+            break;
+    }
+}
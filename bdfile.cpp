@@ -0,0 +1,1672 @@
+//---------------------------------------------------------------------
+
+/*
+    File registration, low level file access, and the subsection,
+    sstModule, sstGlobalSym and sstGlobalTypes header API's.
+*/
+
+//---------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <new>
+#include <string>
+
+#include "bdpriv.h"
+
+
+//---------------------------------------------------------------------
+
+/*
+    Low level file access
+*/
+
+enum
+{
+    BD_WINDOW_SIZE  = 0x4000,
+    BD_MAX_DIRS     = 64,
+};
+
+
+bool    bdReadAt(BdFile * f, uint64_t offset, void * buf, size_t len)
+{
+    unsigned char * dest = static_cast<unsigned char *>(buf);
+
+    if  (offset > f->fileSize || len > f->fileSize - offset)
+        return false;
+
+    if  (f->image)
+    {
+        memcpy(dest, f->image + offset, len);
+        return true;
+    }
+
+    if  (f->prefetch && bdPrefetchRead(f, offset, dest, len))
+        return true;
+
+    if  (f->prefetch && !f->prefetch->readThrough)
+        return false;
+
+    while (len && f->io.read)
+    {
+        size_t  got = f->io.read(f->ioContext, offset, dest, len);
+
+        if  (got == 0 || got > len)
+            return false;
+
+        dest   += got;
+        offset += got;
+        len    -= got;
+    }
+
+    while (len)
+    {
+        ssize_t got = pread(f->fd, dest, len, (off_t)offset);
+
+        if  (got <= 0)
+            return false;
+
+        dest   += got;
+        offset += (uint64_t)got;
+        len    -= (size_t)got;
+    }
+
+    return true;
+}
+
+
+const unsigned char *   bdPeek(BdFile * f, uint64_t offset, uint32_t len)
+{
+    if  (f->image && offset <= f->fileSize && len <= f->fileSize - offset)
+        return f->image + offset;
+
+    if  (offset >= f->windowStart &&
+         offset + len <= f->windowStart + f->windowLen)
+    {
+        return &f->window[offset - f->windowStart];
+    }
+
+    uint32_t    want = len > BD_WINDOW_SIZE ? len : (uint32_t)BD_WINDOW_SIZE;
+
+    if  (f->window.size() < want)
+        f->window.resize(want);
+
+    // Read a full window from the requested offset on, or as much as
+    // is left in the file.
+    f->windowStart = offset;
+    f->windowLen   = 0;
+
+    if  (offset < f->fileSize)
+    {
+        uint64_t    avail = f->fileSize - offset;
+        uint32_t    chunk = avail < want ? (uint32_t)avail : want;
+
+        if  (bdReadAt(f, offset, &f->window[0], chunk))
+            f->windowLen = chunk;
+    }
+
+    if  (f->windowLen < len)
+    {
+        memset(&f->window[f->windowLen], 0, len - f->windowLen);
+        f->windowLen = 0;
+    }
+
+    return &f->window[0];
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    BdCursor
+*/
+
+unsigned int    BdCursor::u8()
+{
+    unsigned int    value = has(1) ? bdPeek(f, pos, 1)[0] : 0;
+
+    pos += 1;
+    return value;
+}
+
+
+unsigned int    BdCursor::u16()
+{
+    unsigned int    value = has(2) ? bdGet16(bdPeek(f, pos, 2)) : 0;
+
+    pos += 2;
+    return value;
+}
+
+
+unsigned int    BdCursor::u32()
+{
+    unsigned int    value = has(4) ? bdGet32(bdPeek(f, pos, 4)) : 0;
+
+    pos += 4;
+    return value;
+}
+
+
+uint64_t    BdCursor::u64()
+{
+    uint64_t    value = has(8) ? bdGet64(bdPeek(f, pos, 8)) : 0;
+
+    pos += 8;
+    return value;
+}
+
+
+/*
+    A numeric leaf is either a value below BORDEBUG_LF_CHAR, or one
+    of the BORDEBUG_LF_CHAR ... BORDEBUG_LF_REAL48 leaves followed by
+    the value.  Signed values are sign extended, reals are returned
+    as their raw bits.
+*/
+
+uint64_t    BdCursor::numeric()
+{
+    unsigned int    leaf = u16();
+
+    if  (leaf < BORDEBUG_LF_CHAR)
+        return leaf;
+
+    switch (leaf)
+    {
+        case BORDEBUG_LF_CHAR:      return (uint64_t)(int64_t)(signed char)u8();
+        case BORDEBUG_LF_SHORT:     return (uint64_t)(int64_t)(short)u16();
+        case BORDEBUG_LF_USHORT:    return u16();
+        case BORDEBUG_LF_LONG:      return (uint64_t)(int64_t)(int)u32();
+        case BORDEBUG_LF_ULONG:     return u32();
+        case BORDEBUG_LF_QUADWORD:
+        case BORDEBUG_LF_UQUADWORD: return u64();
+    }
+
+    skip(bdNumericSize(leaf));
+    return 0;
+}
+
+
+void    BdCursor::skipNumeric()
+{
+    unsigned int    leaf = u16();
+
+    if  (leaf >= BORDEBUG_LF_CHAR)
+        skip(bdNumericSize(leaf));
+}
+
+
+unsigned int    BdCursor::bytes(void * dest, uint32_t n)
+{
+    uint32_t    avail = pos < end ? (uint32_t)(end - pos < n ? end - pos : n) : 0;
+
+    if  (avail)
+        memcpy(dest, bdPeek(f, pos, avail), avail);
+
+    pos += n;
+    return avail;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Registration
+*/
+
+static bool bdKnownExtension(const char * fileName, bool * isTds)
+{
+    const char  * dot = strrchr(fileName, '.');
+
+    if  (!dot || strchr(dot, '/'))
+        return false;
+
+    *isTds = strcasecmp(dot, ".tds") == 0;
+
+    return *isTds ||
+           strcasecmp(dot, ".exe") == 0 ||
+           strcasecmp(dot, ".dll") == 0;
+}
+
+
+static bool bdIsSignature(unsigned int signature)
+{
+    return signature == BD_SIGNATURE_FB09 || signature == BD_SIGNATURE_FB0A;
+}
+
+
+/*
+    Find lfaBase and the directory offset.  A .tds file starts with the
+    debug header, an .exe or .dll has a trailer at its end pointing
+    back to the debug header.  A .tds file is also allowed to carry
+    the trailer form.
+*/
+
+static unsigned int bdFindDebugInfo(BdFile * f, bool isTds)
+{
+    unsigned char   buf[8];
+
+    if  (f->fileSize < 8)
+        return BD_FAIL_NODEBUG;
+
+    if  (isTds)
+    {
+        if  (!bdReadAt(f, 0, buf, 8))
+            return BD_FAIL_READ;
+
+        if  (bdIsSignature(bdGet32(buf)))
+        {
+            f->base      = 0;
+            f->signature = bdGet32(buf);
+            f->dirOffset = bdGet32(buf + 4);
+            return BD_FAIL_NONE;
+        }
+    }
+
+    if  (!bdReadAt(f, f->fileSize - 8, buf, 8))
+        return BD_FAIL_READ;
+
+    uint64_t    back = bdGet32(buf + 4);
+
+    if  (!bdIsSignature(bdGet32(buf)) || back < 8 || back > f->fileSize)
+        return BD_FAIL_NODEBUG;
+
+    f->base = f->fileSize - back;
+
+    if  (!bdReadAt(f, f->base, buf, 8))
+        return BD_FAIL_READ;
+
+    if  (!bdIsSignature(bdGet32(buf)))
+        return BD_FAIL_NODEBUG;
+
+    f->signature = bdGet32(buf);
+    f->dirOffset = f->base + bdGet32(buf + 4);
+    return BD_FAIL_NONE;
+}
+
+
+/*
+    Whether the BORDEBUG_REGISTER_SKIPXXXX options leave out this
+    subsection type
+*/
+
+static bool bdSkipped(unsigned int options, uint32_t type)
+{
+    switch (type)
+    {
+        case BORDEBUG_SSTMODULE:        return (options & BORDEBUG_REGISTER_SKIPMODULES) != 0;
+        case BORDEBUG_SSTALIGNSYM:      return (options & BORDEBUG_REGISTER_SKIPSYMBOLS) != 0;
+        case BORDEBUG_SSTSRCMODULE:     return (options & BORDEBUG_REGISTER_SKIPLINES) != 0;
+        case BORDEBUG_SSTGLOBALSYM:
+        case BORDEBUG_SSTGLOBALPUB:     return (options & BORDEBUG_REGISTER_SKIPGLOBALSYMS) != 0;
+        case BORDEBUG_SSTGLOBALTYPES:   return (options & BORDEBUG_REGISTER_SKIPTYPES) != 0;
+    }
+
+    return false;
+}
+
+
+static unsigned int bdReadDirectory(BdFile * f)
+{
+    uint64_t    dir = f->dirOffset;
+
+    for (int dirs = 0; dirs < BD_MAX_DIRS; dirs++)
+    {
+        unsigned char   header[16];
+
+        if  (!bdReadAt(f, dir, header, sizeof(header)))
+            return BD_FAIL_READ;
+
+        unsigned int    cbHeader = bdGet16(header);
+        unsigned int    cbEntry  = bdGet16(header + 2);
+        unsigned int    count    = bdGet32(header + 4);
+        unsigned int    nextDir  = bdGet32(header + 8);
+
+        if  (cbHeader < 16 || cbEntry < 12)
+            return BD_FAIL_NODEBUG;
+
+        if  ((uint64_t)count * cbEntry > f->fileSize)
+            return BD_FAIL_READ;
+
+        std::vector<unsigned char>  entries((size_t)count * cbEntry);
+
+        if  (count && !bdReadAt(f, dir + cbHeader, &entries[0], entries.size()))
+            return BD_FAIL_READ;
+
+        f->subSections.reserve(f->subSections.size() + count);
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const unsigned char * e = &entries[(size_t)i * cbEntry];
+            BdSubSection          sub;
+
+            sub.type   = bdGet16(e);
+            sub.module = bdGet16(e + 2);
+            sub.offset = f->base + bdGet32(e + 4);
+            sub.size   = bdGet32(e + 8);
+
+            if  (bdSkipped(f->options, sub.type))
+                continue;
+
+            // a mapped file is parsed in place, so a damaged entry
+            // mustn't point past its end
+            if  (sub.offset > f->fileSize || sub.size > f->fileSize - sub.offset)
+                return BD_FAIL_READ;
+
+            f->subSections.push_back(sub);
+        }
+
+        if  (!nextDir)
+            return BD_FAIL_NONE;
+
+        dir = f->base + nextDir;
+    }
+
+    return BD_FAIL_READ;
+}
+
+
+const BdSubSection *    bdFindSubSection(BdFile * f, uint32_t type)
+{
+    for (size_t i = 0; i < f->subSections.size(); i++)
+    {
+        if  (f->subSections[i].type == type)
+            return &f->subSections[i];
+    }
+
+    return 0;
+}
+
+
+static unsigned int bdLoadTypes(BdFile * f)
+{
+    const BdSubSection  * sub = bdFindSubSection(f, BORDEBUG_SSTGLOBALTYPES);
+    unsigned char         header[8];
+
+    if  (!sub || sub->size < sizeof(header))
+        return BD_FAIL_NONE;
+
+    if  (!bdReadAt(f, sub->offset, header, sizeof(header)))
+        return BD_FAIL_READ;
+
+    uint32_t    count = bdGet32(header + 4);
+
+    if  (count > (sub->size - sizeof(header)) / 4)
+        return BD_FAIL_READ;
+
+    std::vector<unsigned char>  table((size_t)count * 4);
+
+    if  (count && !bdReadAt(f, sub->offset + sizeof(header), &table[0], table.size()))
+        return BD_FAIL_READ;
+
+    f->typesOffset    = sub->offset;
+    f->typesSize      = sub->size;
+    f->typesSignature = bdGet32(header);
+    f->typesData      = sub->offset + sizeof(header) + table.size();
+
+    f->typeOffsets.resize(count);
+
+    for (uint32_t i = 0; i < count; i++)
+        f->typeOffsets[i] = bdGet32(&table[(size_t)i * 4]);
+
+    f->typeCount = count;
+    f->typeIndex = f->typeOffsets.data();
+
+    return BD_FAIL_NONE;
+}
+
+
+/*
+    Build the name index: the offset of the length byte of each name,
+    relative to the start of the sstNames subsection.  The length byte
+    can't describe names over 255 characters, so when the byte after
+    the name isn't the terminator, look for the terminator instead.
+*/
+
+static unsigned int bdLoadNames(BdFile * f, unsigned int cacheNames)
+{
+    const BdSubSection  * sub = bdFindSubSection(f, BORDEBUG_SSTNAMES);
+
+    if  (!sub || sub->size < 4)
+        return BD_FAIL_NONE;
+
+    // a copy that doesn't fit the budget is paged in instead
+    if  (f->budget && sub->size > f->budget)
+        cacheNames = 0;
+
+    // only a copy that is kept goes into the arena
+    BdVector<char>          names(cacheNames && !f->image ? f->indexArena : 0);
+    const unsigned char   * p    = 0;
+    uint32_t                size = sub->size;
+    uint32_t                count;
+    BdReuse                 reuse;
+
+    // a rebuilt file that isn't kept in memory only reads the part
+    // that changed, see bdReuseHead
+    if  (f->image)
+        p = f->image + sub->offset;
+    else if (f->prefetch && !cacheNames)
+        p = bdPrefetchData(f, sub->offset, size);
+
+    if  (!p && (cacheNames || !f->previous))
+    {
+        names.resize(size);
+
+        if  (!bdReadAt(f, sub->offset, &names[0], names.size()))
+            return BD_FAIL_READ;
+
+        p = reinterpret_cast<const unsigned char *>(&names[0]);
+    }
+
+    if  (p)
+        count = bdGet32(p);
+    else
+    {
+        unsigned char   header[4];
+
+        if  (!bdReadAt(f, sub->offset, header, sizeof(header)))
+            return BD_FAIL_READ;
+
+        count = bdGet32(header);
+    }
+
+    f->nameOffsets.reserve(count < size / 2 ? count : size / 2);
+
+    // a rebuilt file takes what didn't change from the previous build
+    if  (!bdReuseHead(f, sub->offset, p, size, count, reuse))
+        return BD_FAIL_READ;
+
+    if  (!p)
+        p = bdReuseText(reuse);
+
+    uint32_t    pos = reuse.pos;
+
+    // a large section that is all in memory is scanned in parts
+    if  (reuse.end == size)
+        pos = bdScanNames(p, size, pos, reuse.tail < size ? reuse.tail : size, count, f->nameOffsets);
+
+    while (f->nameOffsets.size() < count && pos < size)
+    {
+        if  (pos >= reuse.tail && bdReuseTail(f, count, reuse, pos))
+            continue;
+
+        // the length byte and the byte after the name
+        if  (reuse.end < size && pos + 0x101 > reuse.end)
+        {
+            if  (!bdReuseRest(f, size, pos, reuse))
+                return BD_FAIL_READ;
+
+            p = bdReuseText(reuse);
+        }
+
+        uint32_t    next = pos + 1 + p[pos];
+
+        if  (next >= size || p[next] != 0)
+        {
+            const void  * zero = memchr(p + pos + 1, 0, reuse.end - pos - 1);
+
+            if  (!zero && reuse.end < size)
+            {
+                if  (!bdReuseRest(f, size, pos, reuse))
+                    return BD_FAIL_READ;
+
+                p = bdReuseText(reuse);
+                continue;
+            }
+
+            if  (!zero)
+                break;
+
+            next = (uint32_t)(static_cast<const unsigned char *>(zero) - p);
+        }
+
+        f->nameOffsets.push_back(pos);
+        pos = next + 1;
+    }
+
+    f->namesOffset = sub->offset;
+    f->namesSize   = sub->size;
+    f->namesReused = reuse.reused;
+    f->nameCount   = (uint32_t)f->nameOffsets.size();
+    f->nameIndex   = f->nameOffsets.data();
+
+    // a mapped file has all names in memory already
+    if  (cacheNames && !f->image)
+    {
+        f->nameCache.swap(names);
+        f->nameText = f->nameCache.data();
+    }
+
+    return BD_FAIL_NONE;
+}
+
+
+/*
+    Build one index.  If that fails, the index is left empty.
+*/
+
+static unsigned int bdBuildTypes(BdFile * f)
+{
+    unsigned int    result;
+
+    try
+    {
+        result = bdLoadTypes(f);
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        f->typeOffsets.clear();
+        f->typeCount = 0;
+    }
+
+    return result;
+}
+
+
+static unsigned int bdBuildNames(BdFile * f)
+{
+    unsigned int    result;
+
+    if  (f->options & BORDEBUG_REGISTER_SKIPNAMES)
+        return BD_FAIL_NONE;
+
+    try
+    {
+        result = bdLoadNames(f, f->options & BORDEBUG_REGISTER_CACHENAMES);
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    // the full offsets are only kept next to a copy of the text, and
+    // for the index cache.  CACHENAMES alone doesn't mean there is a
+    // copy: a memory budget or a mapped file leaves it out.
+    if  (result == BD_FAIL_NONE && !f->nameText &&
+         !(f->options & (BORDEBUG_REGISTER_INDEXCACHE | BORDEBUG_REGISTER_SHAREDINDEX)))
+    {
+        bdCompactNames(f);
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        f->nameOffsets.clear();
+        f->nameCache.clear();
+        f->nameText  = 0;
+        f->nameCount = 0;
+    }
+
+    return result;
+}
+
+
+unsigned int    bdBuildIndexes(BdFile * f)
+{
+    // The type and name indexes don't share anything, build them
+    // side by side.
+    unsigned int    results[2] = { BD_FAIL_NONE, BD_FAIL_NONE };
+
+    bdParallelFor(2, [f, &results](size_t i)
+    {
+        results[i] = i == 0 ? bdBuildTypes(f) : bdBuildNames(f);
+    });
+
+    return results[0] != BD_FAIL_NONE ? results[0] : results[1];
+}
+
+
+/*
+    Build an index for all registrations of the file, or use the one
+    another registration built, see bdshare.cpp.
+*/
+
+static unsigned int bdSharedTypes(BdFile * f)
+{
+    BdShared  * s = f->shared.get();
+
+    std::call_once(s->typesOnce, [f]
+    {
+        unsigned int    result;
+
+        if  (!bdUseIndexCache(f, &result))
+            result = bdBuildTypes(f);
+
+        bdPublishTypes(f, result);
+    });
+
+    bdAdoptTypes(f);
+    return s->typesResult;
+}
+
+
+static unsigned int bdSharedNames(BdFile * f)
+{
+    BdShared  * s = f->shared.get();
+
+    std::call_once(s->namesOnce, [f]
+    {
+        unsigned int    result;
+
+        if  (!bdUseIndexCache(f, &result))
+            result = bdBuildNames(f);
+
+        bdPublishNames(f, result);
+    });
+
+    bdAdoptNames(f);
+    return s->namesResult;
+}
+
+
+static unsigned int bdSharedIndexes(BdFile * f)
+{
+    unsigned int    results[2] = { BD_FAIL_NONE, BD_FAIL_NONE };
+
+    bdParallelFor(2, [f, &results](size_t i)
+    {
+        results[i] = i == 0 ? bdSharedTypes(f) : bdSharedNames(f);
+    });
+
+    return results[0] != BD_FAIL_NONE ? results[0] : results[1];
+}
+
+
+void    bdLoadTypesOnce(BdFile * f)
+{
+    std::call_once(f->typesOnce, [f]
+    {
+        unsigned int    result;
+
+        if  (f->shared)
+            bdSharedTypes(f);
+        else if (!bdUseIndexCache(f, &result))
+            bdBuildTypes(f);
+
+        f->typesLoaded = true;
+    });
+}
+
+
+void    bdLoadNamesOnce(BdFile * f)
+{
+    std::call_once(f->namesOnce, [f]
+    {
+        unsigned int    result;
+
+        if  (f->shared)
+            bdSharedNames(f);
+        else if (!bdUseIndexCache(f, &result))
+            bdBuildNames(f);
+
+        f->namesLoaded = true;
+    });
+}
+
+
+/*
+    Map the whole file.  When that fails, the file is read as usual.
+*/
+
+static void bdMapFile(BdFile * f)
+{
+    if  (f->fileSize == 0 || f->fileSize > SIZE_MAX)
+        return;
+
+    void    * p = mmap(0, (size_t)f->fileSize, PROT_READ, MAP_PRIVATE, f->fd, 0);
+
+    if  (p == MAP_FAILED)
+        return;
+
+    f->image   = static_cast<const unsigned char *>(p);
+    f->mapSize = (size_t)f->fileSize;
+
+    close(f->fd);
+    f->fd = -1;
+}
+
+
+/*
+    Tell the kernel how the subsections of a mapped file are read.
+    Symbols and line numbers are walked from start to end, types and
+    names are looked up by index.
+*/
+
+static void bdAdvise(BdFile * f)
+{
+    uintptr_t   pageMask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+
+    for (size_t i = 0; i < f->subSections.size(); i++)
+    {
+        const BdSubSection  & sub = f->subSections[i];
+        int                   advice;
+
+        switch (sub.type)
+        {
+            case BORDEBUG_SSTALIGNSYM:
+            case BORDEBUG_SSTSRCMODULE:
+            case BORDEBUG_SSTGLOBALSYM:
+            case BORDEBUG_SSTGLOBALPUB:
+                advice = MADV_SEQUENTIAL;
+                break;
+
+            case BORDEBUG_SSTGLOBALTYPES:
+            case BORDEBUG_SSTNAMES:
+                advice = MADV_RANDOM;
+                break;
+
+            default:
+                continue;
+        }
+
+        if  (sub.size == 0 || sub.offset >= f->fileSize)
+            continue;
+
+        uint64_t    end   = sub.offset + sub.size < f->fileSize ? sub.offset + sub.size : f->fileSize;
+        uintptr_t   first = (uintptr_t)(f->image + sub.offset) & ~pageMask;
+        uintptr_t   last  = (uintptr_t)(f->image + end);
+
+        madvise(reinterpret_cast<void *>(first), last - first, advice);
+    }
+}
+
+
+BdFile *    bdNewFile()
+{
+    BdArena * arena = bdArenaCreate();
+    BdFile  * f;
+
+    try
+    {
+        f = new (bdArenaAlloc(arena, sizeof(BdFile))) BdFile();
+    }
+    catch (const std::bad_alloc &)
+    {
+        bdArenaRelease(arena);
+        throw;
+    }
+
+    f->arena           = arena;
+    f->indexArena      = arena;
+    f->subSections     = BdVector<BdSubSection>(arena);
+    f->typeOffsets     = BdVector<uint32_t>(arena);
+    f->nameOffsets     = BdVector<uint32_t>(arena);
+    f->nameCompactData = BdVector<uint32_t>(arena);
+    f->nameCache       = BdVector<char>(arena);
+    f->window          = BdVector<unsigned char>(arena);
+    f->pageText        = BdVector<char>(arena);
+    f->pageSlots       = BdVector<BdNameSlot>(arena);
+    f->pageMap         = BdVector<int32_t>(arena);
+    f->umNames         = BdVector<const char *>(arena);
+    f->umBlocks        = BdVector<BdUmBlock>(arena);
+
+    return f;
+}
+
+
+void    bdFreeFile(BdFile * f)
+{
+    if  (f->cacheMapSize)
+        munmap(f->cacheMap, f->cacheMapSize);
+
+    if  (f->mapSize)
+        munmap(const_cast<unsigned char *>(f->image), f->mapSize);
+
+    if  (f->fd >= 0)
+        close(f->fd);
+
+    if  (f->io.close)
+        f->io.close(f->ioContext);
+
+    BdArena * arena = f->arena;
+
+    f->~BdFile();
+    bdArenaRelease(arena);
+}
+
+
+/*
+    Build the indexes in the background, see BORDEBUG_REGISTER_ASYNC.
+    Types first, since they are needed for nearly everything.  An
+    index that an API asked for in the meantime is already there.
+*/
+
+static void bdStartAsync(BdFile * f)
+{
+    std::shared_ptr<BdAsync>    async = std::make_shared<BdAsync>();
+
+    async->f = f;
+
+    bool    started = bdRunAsync([async]
+    {
+        std::lock_guard<std::mutex> hold(async->lock);
+
+        if  (async->f)
+        {
+            bdLoadTypesOnce(async->f);
+            bdLoadNamesOnce(async->f);
+        }
+    });
+
+    if  (started)
+        f->async = async;
+}
+
+
+static void bdStopAsync(BdFile * f)
+{
+    if  (!f->async)
+        return;
+
+    std::lock_guard<std::mutex> hold(f->async->lock);
+
+    f->async->f = 0;
+}
+
+
+unsigned int    bdReadHeaders(BdFile * f, bool isTds)
+{
+    unsigned int    result;
+
+    f->subSections.clear();
+
+    result = bdFindDebugInfo(f, isTds);
+
+    if  (result == BD_FAIL_NONE)
+        result = bdReadDirectory(f);
+
+    return result;
+}
+
+
+unsigned int    bdRegisterIndexes(BdFile * f, const std::string & identity)
+{
+    unsigned int    result = BD_FAIL_NONE;
+
+    if  (!identity.empty())
+        bdShareIndexes(f, identity);
+
+    if  (!(f->options & BORDEBUG_REGISTER_EAGER))
+    {
+        if  (f->options & BORDEBUG_REGISTER_ASYNC)
+            bdStartAsync(f);
+
+        return result;
+    }
+
+    if  (f->shared)
+        result = bdSharedIndexes(f);
+    else if (!bdUseIndexCache(f, &result))
+        result = bdBuildIndexes(f);
+
+    f->typesLoaded = true;
+    f->namesLoaded = true;
+
+    return result;
+}
+
+
+/*
+    Everything after the file is opened or the image is known.  Only
+    the subsection directory is read, unless BORDEBUG_REGISTER_EAGER
+    asks for the type and name indexes to be built right away.  The
+    indexes are shared with other registrations of the same
+    "identity", unless it is empty.
+*/
+
+static unsigned int bdRegister(BdFile              * f,
+                               bool                  isTds,
+                               unsigned int          options,
+                               const std::string   & identity)
+{
+    unsigned int    result;
+
+    f->options = options;
+    result     = bdReadHeaders(f, isTds);
+
+    if  (result == BD_FAIL_NONE && f->mapSize)
+        bdAdvise(f);
+
+    if  (result != BD_FAIL_NONE)
+        return result;
+
+    return bdRegisterIndexes(f, identity);
+}
+
+
+// What makes two registrations the same file
+static std::string  bdFileIdentity(const struct stat & st)
+{
+    char    identity[96];
+
+    snprintf(identity, sizeof(identity), "file:%llx:%llx:%llx:%lld.%09ld",
+             (unsigned long long)st.st_dev, (unsigned long long)st.st_ino,
+             (unsigned long long)st.st_size, (long long)st.st_mtim.tv_sec,
+             (long)st.st_mtim.tv_nsec);
+
+    return identity;
+}
+
+
+unsigned int    bdOpenFile(const char    * fileName,
+                           BdFile       ** file,
+                           bool          * isTds,
+                           std::string   * identity)
+{
+    if  (!fileName || !bdKnownExtension(fileName, isTds))
+        return BD_FAIL_EXTENSION;
+
+    int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+
+    if  (fd < 0)
+        return BD_FAIL_OPEN;
+
+    BdFile        * f      = 0;
+    unsigned int    result = BD_FAIL_NONE;
+
+    try
+    {
+        struct stat st;
+
+        f = bdNewFile();
+        f->fd   = fd;
+        f->path = fileName;
+
+        if  (fstat(fd, &st) != 0)
+            result = BD_FAIL_READ;
+        else
+        {
+            f->fileSize = (uint64_t)st.st_size;
+            *identity   = bdFileIdentity(st);
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        if  (f)
+            bdFreeFile(f);
+        else
+            close(fd);
+
+        return result;
+    }
+
+    *file = f;
+    return BD_FAIL_NONE;
+}
+
+
+/*
+    Register a file by name.  "previous" is the previous build of the
+    file, see BorDebugReregisterFile, or NULL.
+*/
+
+static BdFile * bdRegisterPath(const char   * fileName,
+                               unsigned int   options,
+                               BdFile       * previous,
+                               unsigned int * failure)
+{
+    BdFile        * f;
+    bool            isTds;
+    std::string     identity;
+    unsigned int    result = bdOpenFile(fileName, &f, &isTds, &identity);
+
+    if  (result != BD_FAIL_NONE)
+    {
+        bdPut(failure, result);
+        return 0;
+    }
+
+    try
+    {
+        f->previous = previous;
+
+        if  (options & BORDEBUG_REGISTER_MAP)
+            bdMapFile(f);
+
+        result = bdRegister(f, isTds, options, identity);
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        bdFreeFile(f);
+        bdPut(failure, result);
+        return 0;
+    }
+
+    f->previous = 0;
+
+    bdPut(failure, BD_FAIL_NONE);
+    return f;
+}
+
+
+BorDebugCookie  BorDebugRegisterFileEx(const char   * fileName,
+                                       unsigned int   options,
+                                       unsigned int * failure)
+{
+    return bdRegisterPath(fileName, options, 0, failure);
+}
+
+
+BorDebugCookie  BorDebugReregisterFile(BorDebugCookie        previousCookie,
+                                       const char          * fileName,
+                                       unsigned int          options,
+                                       BorDebugReindexInfo * info,
+                                       unsigned int        * failure)
+{
+    BdFile  * previous = bdFile(previousCookie);
+
+    // only an index that is there can be taken from
+    if  (previous && !previous->namesLoaded)
+        previous = 0;
+
+    options |= BORDEBUG_REGISTER_EAGER;
+    options &= ~(unsigned int)BORDEBUG_REGISTER_ASYNC;
+
+    BdFile  * f = bdRegisterPath(fileName, options, previous, failure);
+
+    if  (!f || !info)
+        return f;
+
+    std::vector<uint32_t>   stamps;
+    std::vector<uint32_t>   oldStamps;
+
+    try
+    {
+        bdModuleTimeStamps(f, stamps);
+
+        if  (previousCookie)
+            bdModuleTimeStamps(bdFile(previousCookie), oldStamps);
+    }
+    catch (const std::bad_alloc &)
+    {
+        stamps.clear();
+    }
+
+    info->modules        = (unsigned int)stamps.size();
+    info->changedModules = 0;
+    info->names          = f->nameCount;
+    info->namesReused    = f->namesReused;
+
+    for (size_t i = 0; i < stamps.size(); i++)
+    {
+        if  (i >= oldStamps.size() || stamps[i] != oldStamps[i])
+            info->changedModules++;
+    }
+
+    return f;
+}
+
+
+BorDebugCookie  BorDebugRegisterFile(const char   * fileName,
+                                     unsigned int   skipNames,
+                                     unsigned int   cacheNames,
+                                     unsigned int * failure)
+{
+    unsigned int    options = 0;
+
+    if  (skipNames)
+        options |= BORDEBUG_REGISTER_SKIPNAMES;
+
+    if  (cacheNames)
+        options |= BORDEBUG_REGISTER_CACHENAMES;
+
+    return BorDebugRegisterFileEx(fileName, options, failure);
+}
+
+
+BorDebugCookie  BorDebugRegisterMemory(const void   * image,
+                                       size_t         size,
+                                       unsigned int   options,
+                                       unsigned int * failure)
+{
+    BdFile        * f      = 0;
+    unsigned int    result = BD_FAIL_NONE;
+
+    if  (!image)
+    {
+        bdPut(failure, BD_FAIL_NODEBUG);
+        return 0;
+    }
+
+    try
+    {
+        f = bdNewFile();
+        f->fd       = -1;
+        f->image    = static_cast<const unsigned char *>(image);
+        f->fileSize = size;
+
+        char    identity[48];
+
+        snprintf(identity, sizeof(identity), "image:%p:%zx", image, size);
+
+        // the image can hold a .tds as well as an .exe or .dll
+        result = bdRegister(f, true, options, identity);
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        if  (f)
+            bdFreeFile(f);
+
+        bdPut(failure, result);
+        return 0;
+    }
+
+    bdPut(failure, BD_FAIL_NONE);
+    return f;
+}
+
+
+BorDebugCookie  BorDebugRegisterIO(const BorDebugIO * io,
+                                   void             * context,
+                                   unsigned int       options,
+                                   unsigned int     * failure)
+{
+    BdFile        * f      = 0;
+    unsigned int    result = BD_FAIL_NONE;
+
+    if  (!io || !io->read || !io->size)
+    {
+        // close is still the last call for this context
+        if  (io && io->close)
+            io->close(context);
+
+        bdPut(failure, BD_FAIL_OPEN);
+        return 0;
+    }
+
+    try
+    {
+        f = bdNewFile();
+        f->fd        = -1;
+        f->io        = *io;
+        f->ioContext = context;
+        f->fileSize  = io->size(context);
+
+        if  (io->map)
+            f->image = static_cast<const unsigned char *>(io->map(context));
+
+        // nothing tells two of these apart, so they share nothing
+        result = bdRegister(f, true, options, std::string());
+    }
+    catch (const std::bad_alloc &)
+    {
+        result = BD_FAIL_MEMORY;
+    }
+
+    if  (result != BD_FAIL_NONE)
+    {
+        if  (f)
+            bdFreeFile(f);
+        else if (io->close)
+            io->close(context);
+
+        bdPut(failure, result);
+        return 0;
+    }
+
+    bdPut(failure, BD_FAIL_NONE);
+    return f;
+}
+
+
+void    BorDebugRegisterFiles(const char * const  * fileNames,
+                              unsigned int          count,
+                              unsigned int          options,
+                              BorDebugCookie      * cookies,
+                              unsigned int        * failures)
+{
+    bdParallelFor(count, [=](size_t i)
+    {
+        unsigned int    failure;
+
+        cookies[i] = BorDebugRegisterFileEx(fileNames[i], options, &failure);
+
+        if  (failures)
+            failures[i] = failure;
+    });
+}
+
+
+void    BorDebugUnregisterFile(BorDebugCookie registerCookie)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (f)
+    {
+        bdStopAsync(f);
+        bdFreeFile(f);
+    }
+}
+
+
+int     BorDebugIndexReady(BorDebugCookie registerCookie, unsigned int indexes)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  ((indexes & BORDEBUG_INDEX_TYPES) && !f->typesLoaded)
+        return 0;
+
+    if  ((indexes & BORDEBUG_INDEX_NAMES) && !f->namesLoaded)
+        return 0;
+
+    return 1;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Probing
+*/
+
+/*
+    Time stamps of the modules, in directory order
+*/
+
+void    bdModuleTimeStamps(BdFile * f, std::vector<uint32_t> & stamps)
+{
+    for (size_t i = 0; i < f->subSections.size(); i++)
+    {
+        const BdSubSection  & sub = f->subSections[i];
+        unsigned char         buf[4];
+
+        if  (sub.type != BORDEBUG_SSTMODULE)
+            continue;
+
+        stamps.push_back(bdReadAt(f, sub.offset + 12, buf, 4) ? bdGet32(buf) : 0);
+    }
+}
+
+
+static unsigned int bdProbe(BdFile             * f,
+                            bool                 isTds,
+                            BorDebugProbeInfo  * info,
+                            unsigned int       * timeStamps,
+                            unsigned int         maxTimeStamps)
+{
+    unsigned int    result = bdRegister(f, isTds, 0, std::string());
+
+    if  (result != BD_FAIL_NONE)
+        return result;
+
+    info->signature       = f->signature;
+    info->dirOffset       = f->dirOffset;
+    info->subSectionCount = (unsigned int)f->subSections.size();
+
+    for (size_t i = 0; i < f->subSections.size(); i++)
+    {
+        switch (f->subSections[i].type)
+        {
+            case BORDEBUG_SSTMODULE:        info->moduleCount++;        break;
+            case BORDEBUG_SSTALIGNSYM:      info->alignSymCount++;      break;
+            case BORDEBUG_SSTSRCMODULE:     info->srcModuleCount++;     break;
+            case BORDEBUG_SSTGLOBALSYM:
+            case BORDEBUG_SSTGLOBALPUB:     info->globalSymCount++;     break;
+            case BORDEBUG_SSTGLOBALTYPES:   info->globalTypesCount++;   break;
+            case BORDEBUG_SSTNAMES:         info->namesCount++;         break;
+        }
+    }
+
+    std::vector<uint32_t>   stamps;
+
+    bdModuleTimeStamps(f, stamps);
+
+    for (size_t i = 0; i < stamps.size(); i++)
+    {
+        if  (stamps[i] > info->newestTimeStamp)
+            info->newestTimeStamp = stamps[i];
+
+        if  (timeStamps && i < maxTimeStamps)
+            timeStamps[i] = stamps[i];
+    }
+
+    return BD_FAIL_NONE;
+}
+
+
+unsigned int    BorDebugProbeFile(const char         * fileName,
+                                  BorDebugProbeInfo  * info,
+                                  unsigned int       * timeStamps,
+                                  unsigned int         maxTimeStamps)
+{
+    BorDebugProbeInfo   ignored;
+    bool                isTds;
+
+    if  (!info)
+        info = &ignored;
+
+    memset(info, 0, sizeof(*info));
+
+    if  (!fileName || !bdKnownExtension(fileName, &isTds))
+        return info->failure = BD_FAIL_EXTENSION;
+
+    int fd = open(fileName, O_RDONLY | O_CLOEXEC);
+
+    if  (fd < 0)
+        return info->failure = BD_FAIL_OPEN;
+
+    BdFile      * f = 0;
+    struct stat   st;
+
+    try
+    {
+        f = bdNewFile();
+        f->fd = fd;
+
+        if  (fstat(fd, &st) != 0)
+            info->failure = BD_FAIL_READ;
+        else
+        {
+            f->fileSize   = (uint64_t)st.st_size;
+            info->failure = bdProbe(f, isTds, info, timeStamps, maxTimeStamps);
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        info->failure = BD_FAIL_MEMORY;
+    }
+
+    if  (f)
+        bdFreeFile(f);
+    else
+        close(fd);
+
+    return info->failure;
+}
+
+
+void    BorDebugProbeFiles(const char * const  * fileNames,
+                           unsigned int          count,
+                           BorDebugProbeInfo   * infos)
+{
+    bdParallelFor(count, [=](size_t i)
+    {
+        BorDebugProbeFile(fileNames[i], &infos[i], 0, 0);
+    });
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    General subsection API's
+*/
+
+unsigned long long      BorDebugSubSectionDirOffset_64(BorDebugCookie registerCookie)
+{
+    return bdFile(registerCookie)->dirOffset;
+}
+
+
+unsigned int    BorDebugSubSectionCount(BorDebugCookie registerCookie)
+{
+    return (unsigned int)bdFile(registerCookie)->subSections.size();
+}
+
+
+void    BorDebugSubSection_64(BorDebugCookie       registerCookie,
+                              unsigned int         subSectionNo,
+                              unsigned int       * subSectionType,
+                              unsigned int       * module,
+                              unsigned long long * offset,
+                              unsigned int       * size)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (subSectionNo >= f->subSections.size())
+    {
+        bdPut(subSectionType, BORDEBUG_SSTINVALID);
+        bdPut(module, 0);
+        bdPut(offset, 0);
+        bdPut(size, 0);
+        return;
+    }
+
+    const BdSubSection  & sub = f->subSections[subSectionNo];
+
+    bdPut(subSectionType, sub.type);
+    bdPut(module, sub.module);
+    bdPut(offset, sub.offset);
+    bdPut(size, sub.size);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    sstModule API's
+
+    sstModule:
+
+        WORD    overlay
+        WORD    libIndex
+        WORD    segmentCount
+        WORD    style
+        DWORD   name
+        DWORD   timeStamp
+        DWORD   reserved[3]
+        ...     segmentCount times:
+        WORD    segment
+        WORD    flags
+        DWORD   offset
+        DWORD   size
+*/
+
+enum
+{
+    BD_MODULE_HEADER    = 28,
+    BD_MODULE_SEGMENT   = 12,
+};
+
+
+void    BorDebugModule_64(BorDebugCookie       registerCookie,
+                          unsigned long long   offset,
+                          unsigned int       * overlay,
+                          unsigned int       * libIndex,
+                          unsigned int       * style,
+                          unsigned int       * name,
+                          unsigned int       * timeStamp,
+                          unsigned int       * segmentCount)
+{
+    const unsigned char * p = bdPeek(bdFile(registerCookie), offset, BD_MODULE_HEADER);
+
+    bdPut(overlay, bdGet16(p));
+    bdPut(libIndex, bdGet16(p + 2));
+    bdPut(segmentCount, bdGet16(p + 4));
+    bdPut(style, bdGet16(p + 6));
+    bdPut(name, bdGet32(p + 8));
+    bdPut(timeStamp, bdGet32(p + 12));
+}
+
+
+void    BorDebugModuleSegment_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   moduleOffset,
+                                 unsigned int         segmentNo,
+                                 unsigned int       * segment,
+                                 unsigned int       * offset,
+                                 unsigned int       * size,
+                                 unsigned int       * flags)
+{
+    uint64_t                pos = moduleOffset + BD_MODULE_HEADER +
+                                  (uint64_t)segmentNo * BD_MODULE_SEGMENT;
+    const unsigned char   * p   = bdPeek(bdFile(registerCookie), pos, BD_MODULE_SEGMENT);
+
+    bdPut(segment, bdGet16(p));
+    bdPut(flags, bdGet16(p + 2));
+    bdPut(offset, bdGet32(p + 4));
+    bdPut(size, bdGet32(p + 8));
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    sstGlobalSym and sstGlobalPub API's
+
+    Header of sstGlobalSym and sstGlobalPub, followed by the symbols:
+
+        DWORD   symHashFunction     name index
+        DWORD   addrHashFunction    name index
+        DWORD   cbSymbols
+        DWORD   cbSymHash
+        DWORD   cbAddrHash
+        DWORD   cUDTs
+        DWORD   cOthers
+        DWORD   cSymbols
+        DWORD   cNameSpaces
+*/
+
+void    BorDebugGlobalSym_64(BorDebugCookie       registerCookie,
+                             unsigned long long   offset,
+                             unsigned int       * symHashFunction,
+                             unsigned int       * addrHashFunction,
+                             unsigned int       * symTableBytes,
+                             unsigned int       * symHashTableBytes,
+                             unsigned int       * addrHashTableBytes,
+                             unsigned int       * totalUDTs,
+                             unsigned int       * totalOtherSyms,
+                             unsigned int       * totalSymbols,
+                             unsigned int       * totalNameSpaces)
+{
+    const unsigned char * p = bdPeek(bdFile(registerCookie), offset, 36);
+
+    bdPut(symHashFunction, bdGet32(p));
+    bdPut(addrHashFunction, bdGet32(p + 4));
+    bdPut(symTableBytes, bdGet32(p + 8));
+    bdPut(symHashTableBytes, bdGet32(p + 12));
+    bdPut(addrHashTableBytes, bdGet32(p + 16));
+    bdPut(totalUDTs, bdGet32(p + 20));
+    bdPut(totalOtherSyms, bdGet32(p + 24));
+    bdPut(totalSymbols, bdGet32(p + 28));
+    bdPut(totalNameSpaces, bdGet32(p + 32));
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    sstGlobalTypes API's
+*/
+
+void    BorDebugGlobalTypes(BorDebugCookie registerCookie,
+                            unsigned int * signature,
+                            unsigned int * totalTypes)
+{
+    BdFile  * f = bdTypesFile(registerCookie);
+
+    bdPut(signature, f->typesSignature);
+    bdPut(totalTypes, f->typeCount);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Browser API's
+*/
+
+void    BorDebugDumpBrowserInfo(BorDebugCookie registerCookie,
+                                unsigned int   browserOffset)
+{
+    // The browser info format is not defined yet, see bordebug.h
+    (void)registerCookie;
+    (void)browserOffset;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    32 bit offset versions of the API's above
+*/
+
+unsigned int    BorDebugSubSectionDirOffset(BorDebugCookie registerCookie)
+{
+    return (unsigned int)BorDebugSubSectionDirOffset_64(registerCookie);
+}
+
+
+void    BorDebugSubSection(BorDebugCookie registerCookie,
+                           unsigned int   subSectionNo,
+                           unsigned int * subSectionType,
+                           unsigned int * module,
+                           unsigned int * offset,
+                           unsigned int * size)
+{
+    unsigned long long  offset64 = 0;
+
+    BorDebugSubSection_64(registerCookie, subSectionNo, subSectionType, module,
+                          offset ? &offset64 : 0, size);
+    bdPut(offset, (unsigned int)offset64);
+}
+
+
+void    BorDebugModule(BorDebugCookie registerCookie,
+                       unsigned int   offset,
+                       unsigned int * overlay,
+                       unsigned int * libIndex,
+                       unsigned int * style,
+                       unsigned int * name,
+                       unsigned int * timeStamp,
+                       unsigned int * segmentCount)
+{
+    BorDebugModule_64(registerCookie, offset, overlay, libIndex, style, name,
+                      timeStamp, segmentCount);
+}
+
+
+void    BorDebugModuleSegment(BorDebugCookie registerCookie,
+                              unsigned int   moduleOffset,
+                              unsigned int   segmentNo,
+                              unsigned int * segment,
+                              unsigned int * offset,
+                              unsigned int * size,
+                              unsigned int * flags)
+{
+    BorDebugModuleSegment_64(registerCookie, moduleOffset, segmentNo, segment,
+                             offset, size, flags);
+}
+
+
+void    BorDebugGlobalSym(BorDebugCookie registerCookie,
+                          unsigned int   offset,
+                          unsigned int * symHashFunction,
+                          unsigned int * addrHashFunction,
+                          unsigned int * symTableBytes,
+                          unsigned int * symHashTableBytes,
+                          unsigned int * addrHashTableBytes,
+                          unsigned int * totalUDTs,
+                          unsigned int * totalOtherSyms,
+                          unsigned int * totalSymbols,
+                          unsigned int * totalNameSpaces)
+{
+    BorDebugGlobalSym_64(registerCookie, offset, symHashFunction,
+                         addrHashFunction, symTableBytes, symHashTableBytes,
+                         addrHashTableBytes, totalUDTs, totalOtherSyms,
+                         totalSymbols, totalNameSpaces);
+}
@@ -0,0 +1,498 @@
+//---------------------------------------------------------------------
+
+/*
+    Pool of registered files
+
+    Files registered through the pool stay registered after their
+    last user releases them, so the next request for the same file
+    and options costs a lookup instead of a registration.  Files no
+    one is using are unregistered, least recently used first, when
+    the pool holds more files or more bytes than its limits allow.
+    A file that is being registered has an entry marked "loading";
+    other requests for it wait for that registration instead of
+    starting their own.
+
+    A watched file (BORDEBUG_REGISTER_WATCH) that changed is
+    registered again on the watcher thread, while requests keep
+    getting the old cookie.  Then the entry gets the new cookie, and
+    the old one moves to an entry of its own, "retired", which is in
+    no list but byCookie and goes away with its last release.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_FILES_DEFAULT_MAX    = 64,
+};
+
+
+struct BdPoolEntry
+{
+    std::string                         key;
+    BorDebugCookie                      cookie;
+    unsigned int                        refs;
+    uint64_t                            bytes;
+    bool                                loading;
+    bool                                reloading;
+    bool                                retired;
+    std::list<BdPoolEntry *>::iterator  lru;
+
+    // BORDEBUG_REGISTER_WATCH: the watched path, empty when not
+    // watched, and what the file was when it was registered
+    unsigned int                        options;
+    std::string                         watchPath;
+    struct stat                         version;
+};
+
+
+struct BdFilePool
+{
+    std::mutex                                      lock;
+    std::condition_variable                         loaded;
+    std::unordered_map<std::string, BdPoolEntry *>  byKey;
+    std::unordered_map<void *, BdPoolEntry *>       byCookie;
+    std::list<BdPoolEntry *>                        lru;        // most recently used first
+    unsigned int                                    maxFiles;
+    uint64_t                                        maxBytes;
+    uint64_t                                        bytes;
+    uint64_t                                        hits;
+    uint64_t                                        misses;
+    uint64_t                                        evictions;
+    uint64_t                                        reloads;
+    unsigned int                                    retired;
+};
+
+
+// Never destroyed, like the worker pool: cookies may still be
+// handed back while the process exits.
+static BdFilePool & bdFilePool()
+{
+    static BdFilePool   * pool = 0;
+    static std::once_flag once;
+
+    std::call_once(once, []
+    {
+        pool = new BdFilePool();
+        pool->maxFiles = BD_FILES_DEFAULT_MAX;
+    });
+
+    return *pool;
+}
+
+
+static std::string  bdPoolKey(const char * fileName, unsigned int options)
+{
+    char    buf[16];
+
+    snprintf(buf, sizeof(buf), "%08x:", options);
+
+    return buf + std::string(fileName);
+}
+
+
+static uint64_t bdCookieBytes(BorDebugCookie cookie)
+{
+    return bdArenaSize(bdFile(cookie)->arena);
+}
+
+
+static void bdForget(BdFilePool & pool, BdPoolEntry * entry)
+{
+    pool.bytes -= entry->bytes;
+
+    if  (entry->retired)
+        pool.retired--;
+    else
+    {
+        pool.lru.erase(entry->lru);
+        pool.byKey.erase(entry->key);
+    }
+
+    if  (entry->cookie)
+        pool.byCookie.erase(entry->cookie);
+}
+
+
+static bool bdSameVersion(const struct stat & a, const struct stat & b)
+{
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size &&
+           a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+
+/*
+    Take unused files off the pool until it is within its limits.
+    The caller unregisters them after letting go of the lock.
+*/
+
+static void bdTrim(BdFilePool                  & pool,
+                   std::vector<BorDebugCookie>  & victims,
+                   std::vector<std::string>     & unwatch,
+                   bool                           all)
+{
+    auto    it = pool.lru.end();
+
+    while (it != pool.lru.begin())
+    {
+        bool    over = all ||
+                       (pool.maxFiles && pool.byKey.size() > pool.maxFiles) ||
+                       (pool.maxBytes && pool.bytes > pool.maxBytes);
+
+        if  (!over)
+            break;
+
+        BdPoolEntry * entry = *--it;
+
+        if  (entry->refs || entry->loading || entry->reloading)
+            continue;
+
+        it = std::next(it);
+
+        bdForget(pool, entry);
+        victims.push_back(entry->cookie);
+
+        if  (!entry->watchPath.empty())
+            unwatch.push_back(entry->watchPath);
+
+        pool.evictions++;
+        delete entry;
+    }
+}
+
+
+static void bdUnregisterAll(const std::vector<BorDebugCookie> & victims,
+                            const std::vector<std::string>    & unwatch)
+{
+    for (size_t i = 0; i < unwatch.size(); i++)
+        bdWatchRemove(unwatch[i]);
+
+    for (size_t i = 0; i < victims.size(); i++)
+        BorDebugUnregisterFile(victims[i]);
+}
+
+
+//---------------------------------------------------------------------
+
+BorDebugCookie  BorDebugPoolAcquire(const char   * fileName,
+                                    unsigned int   options,
+                                    unsigned int * failure)
+{
+    if  (!fileName)
+    {
+        bdPut(failure, BD_FAIL_EXTENSION);
+        return 0;
+    }
+
+    BdFilePool                    & pool = bdFilePool();
+    std::string                     key  = bdPoolKey(fileName, options);
+    std::unique_lock<std::mutex>    hold(pool.lock);
+    BdPoolEntry                   * entry;
+
+    while (true)
+    {
+        auto    found = pool.byKey.find(key);
+
+        if  (found == pool.byKey.end())
+            break;
+
+        entry = found->second;
+
+        if  (entry->loading)
+        {
+            pool.loaded.wait(hold);
+            continue;
+        }
+
+        entry->refs++;
+        pool.lru.splice(pool.lru.begin(), pool.lru, entry->lru);
+        pool.hits++;
+
+        bdPut(failure, BD_FAIL_NONE);
+        return entry->cookie;
+    }
+
+    entry = new BdPoolEntry();
+    entry->key     = key;
+    entry->loading = true;
+    entry->options = options & ~(unsigned int)BORDEBUG_REGISTER_WATCH;
+    entry->lru     = pool.lru.insert(pool.lru.begin(), entry);
+
+    pool.byKey[key] = entry;
+    pool.misses++;
+
+    hold.unlock();
+
+    // what the file is before registering it, so a change while it is
+    // registered is a new version
+    std::string     watchPath;
+
+    if  (options & BORDEBUG_REGISTER_WATCH)
+    {
+        watchPath = bdWatchPath(fileName);
+
+        if  (stat(fileName, &entry->version) != 0)
+            watchPath.clear();
+    }
+
+    unsigned int                    result;
+    BorDebugCookie                  cookie = BorDebugRegisterFileEx(fileName, entry->options, &result);
+    std::vector<BorDebugCookie>     victims;
+    std::vector<std::string>        unwatch;
+
+    if  (cookie && !watchPath.empty() && !bdWatchAdd(watchPath))
+        watchPath.clear();
+
+    hold.lock();
+
+    if  (!cookie)
+    {
+        bdForget(pool, entry);
+        delete entry;
+    }
+    else
+    {
+        entry->cookie    = cookie;
+        entry->loading   = false;
+        entry->refs      = 1;
+        entry->bytes     = bdCookieBytes(cookie);
+        entry->watchPath = watchPath;
+
+        pool.byCookie[cookie] = entry;
+        pool.bytes += entry->bytes;
+
+        bdTrim(pool, victims, unwatch, false);
+    }
+
+    hold.unlock();
+    pool.loaded.notify_all();
+
+    bdUnregisterAll(victims, unwatch);
+
+    bdPut(failure, result);
+    return cookie;
+}
+
+
+void    BorDebugPoolRelease(BorDebugCookie registerCookie)
+{
+    BdFilePool                    & pool = bdFilePool();
+    std::vector<BorDebugCookie>     victims;
+    std::vector<std::string>        unwatch;
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        auto    found = pool.byCookie.find(registerCookie);
+
+        if  (found == pool.byCookie.end())
+            return;
+
+        BdPoolEntry * entry = found->second;
+
+        if  (entry->refs)
+            entry->refs--;
+
+        if  (entry->retired)
+        {
+            // the last user of an old version
+            if  (entry->refs == 0)
+            {
+                bdForget(pool, entry);
+                victims.push_back(entry->cookie);
+                delete entry;
+            }
+        }
+        else
+        {
+            // indexes are built on first use, so the size grows after
+            // registration
+            pool.bytes   -= entry->bytes;
+            entry->bytes  = bdCookieBytes(registerCookie);
+            pool.bytes   += entry->bytes;
+
+            bdTrim(pool, victims, unwatch, false);
+        }
+    }
+
+    bdUnregisterAll(victims, unwatch);
+}
+
+
+/*
+    Register a new version of a watched file, and swap it in.  The
+    entry is marked "reloading", so it stays in the pool, and only
+    this thread changes its cookie, options and path.
+*/
+
+static void bdReload(BdFilePool & pool, BdPoolEntry * entry)
+{
+    struct stat                     version;
+    BorDebugCookie                  cookie  = 0;
+    BdPoolEntry                   * old     = 0;
+    std::vector<BorDebugCookie>     victims;
+    std::vector<std::string>        unwatch;
+
+    if  (stat(entry->watchPath.c_str(), &version) == 0 && !bdSameVersion(version, entry->version))
+    {
+        cookie = BorDebugReregisterFile(entry->cookie, entry->watchPath.c_str(), entry->options, 0, 0);
+        old    = cookie ? new (std::nothrow) BdPoolEntry() : 0;
+    }
+
+    std::unique_lock<std::mutex>    hold(pool.lock);
+
+    entry->reloading = false;
+
+    if  (cookie && old)
+    {
+        try
+        {
+            pool.byCookie[cookie] = entry;
+        }
+        catch (const std::bad_alloc &)
+        {
+            delete old;
+            old = 0;
+        }
+    }
+
+    if  (!old)
+    {
+        hold.unlock();
+
+        if  (cookie)
+            BorDebugUnregisterFile(cookie);
+
+        return;
+    }
+
+    // the old version stays with whoever has it
+    old->key     = entry->key;
+    old->cookie  = entry->cookie;
+    old->refs    = entry->refs;
+    old->bytes   = entry->bytes;
+    old->retired = true;
+
+    pool.byCookie[old->cookie] = old;
+    pool.retired++;
+
+    entry->cookie  = cookie;
+    entry->refs    = 0;
+    entry->bytes   = bdCookieBytes(cookie);
+    entry->version = version;
+
+    pool.bytes += entry->bytes;
+    pool.reloads++;
+
+    if  (old->refs == 0)
+    {
+        bdForget(pool, old);
+        victims.push_back(old->cookie);
+        delete old;
+    }
+
+    bdTrim(pool, victims, unwatch, false);
+
+    hold.unlock();
+
+    bdUnregisterAll(victims, unwatch);
+}
+
+
+void    bdPoolFileChanged(const std::string & path)
+{
+    BdFilePool                    & pool = bdFilePool();
+    std::vector<BdPoolEntry *>      changed;
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        for (auto it = pool.byKey.begin(); it != pool.byKey.end(); ++it)
+        {
+            BdPoolEntry * entry = it->second;
+
+            if  (entry->loading || entry->reloading || entry->watchPath != path)
+                continue;
+
+            entry->reloading = true;
+            changed.push_back(entry);
+        }
+    }
+
+    for (size_t i = 0; i < changed.size(); i++)
+        bdReload(pool, changed[i]);
+}
+
+
+void    BorDebugPoolSetLimits(unsigned int maxFiles, unsigned long long maxBytes)
+{
+    BdFilePool                    & pool = bdFilePool();
+    std::vector<BorDebugCookie>     victims;
+    std::vector<std::string>        unwatch;
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        pool.maxFiles = maxFiles;
+        pool.maxBytes = maxBytes;
+
+        bdTrim(pool, victims, unwatch, false);
+    }
+
+    bdUnregisterAll(victims, unwatch);
+}
+
+
+void    BorDebugPoolFlush(void)
+{
+    BdFilePool                    & pool = bdFilePool();
+    std::vector<BorDebugCookie>     victims;
+    std::vector<std::string>        unwatch;
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        bdTrim(pool, victims, unwatch, true);
+    }
+
+    bdUnregisterAll(victims, unwatch);
+}
+
+
+void    BorDebugPoolGetStats(BorDebugPoolStats * stats)
+{
+    BdFilePool                  & pool = bdFilePool();
+    std::lock_guard<std::mutex>   hold(pool.lock);
+
+    if  (!stats)
+        return;
+
+    stats->files     = (unsigned int)pool.byKey.size();
+    stats->inUse     = 0;
+    stats->bytes     = pool.bytes;
+    stats->hits      = pool.hits;
+    stats->misses    = pool.misses;
+    stats->evictions = pool.evictions;
+    stats->reloads   = pool.reloads;
+    stats->retired   = pool.retired;
+
+    for (auto it = pool.byKey.begin(); it != pool.byKey.end(); ++it)
+    {
+        if  (it->second->refs || it->second->loading)
+            stats->inUse++;
+    }
+}
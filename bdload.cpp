@@ -0,0 +1,844 @@
+//---------------------------------------------------------------------
+
+/*
+    BorDebugLoadFiles, registering many files with their reads queued
+    together
+
+    A file is registered in steps, and all files make a step in the
+    same round.  In a step the usual parsers run on what was read in
+    the rounds before; a read that isn't there fails and is noted
+    (see bdPrefetchRead), and the step runs again after the next
+    round.  The reads of all files in a round go to the kernel
+    together, through io_uring where there is one, so many reads are
+    in flight instead of one at a time.
+
+        header      the debug header and the subsection directory,
+                    read from the start and the end of the file
+        sections    sstNames and the sstGlobalTypes offset table
+        indexes     the indexes are built from what was read, as for
+                    BORDEBUG_REGISTER_EAGER, anything else is read
+                    right away
+
+    The sections of a file are kept until its indexes are built, so
+    only so many files are in their sections step at a time.  One
+    io_uring is set up for all rounds.
+*/
+
+//---------------------------------------------------------------------
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define BD_HAVE_IO_URING    1
+#endif
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_LOAD_FILES   = 256,              // files being registered at a time
+    BD_LOAD_DEPTH   = 128,              // reads in flight
+    BD_LOAD_CHUNK   = 0x100000,         // largest single read
+    BD_LOAD_EDGE    = 0x1000,           // read at each end, and at least
+};
+
+static const uint64_t   BD_LOAD_BYTES = 0x2000000;     // sections kept at a time
+
+
+enum BdLoadStep
+{
+    BD_STEP_HEADER,
+    BD_STEP_SECTIONS,
+    BD_STEP_INDEXES,
+    BD_STEP_DONE,
+};
+
+
+struct BdLoadFile
+{
+    BdFile        * f;
+    bool            isTds;
+    std::string     identity;
+    BdLoadStep      step;
+    uint64_t        sections;           // bytes of sections kept, 0 until admitted
+    unsigned int    result;
+    BdPrefetch      prefetch;
+};
+
+
+// One read of the kernel, part of a range
+struct BdLoadRead
+{
+    int                 fd;
+    uint64_t            offset;
+    unsigned char     * dest;
+    uint32_t            len;
+    bool                done;
+    bool                failed;
+    BdPrefetchRange   * range;
+};
+
+
+//---------------------------------------------------------------------
+
+/*
+    Plain reads, for what io_uring didn't read
+*/
+
+static void bdReadSync(BdLoadRead & r)
+{
+    while (r.len)
+    {
+        ssize_t got = pread(r.fd, r.dest, r.len, (off_t)r.offset);
+
+        if  (got < 0 && errno == EINTR)
+            continue;
+
+        if  (got <= 0)
+        {
+            r.failed = true;
+            break;
+        }
+
+        r.dest   += got;
+        r.offset += (uint64_t)got;
+        r.len    -= (uint32_t)got;
+    }
+
+    r.done = true;
+}
+
+
+#ifdef BD_HAVE_IO_URING
+
+/*
+    io_uring through the system calls, the rings are shared with the
+    kernel: the submission queue tail and the completion queue head
+    are ours, the others the kernel's.
+*/
+
+struct BdRing
+{
+    int                     fd;
+    unsigned int            entries;
+
+    unsigned int          * sqHead;
+    unsigned int          * sqTail;
+    unsigned int          * sqMask;
+    unsigned int          * sqArray;
+    struct io_uring_sqe   * sqes;
+
+    unsigned int          * cqHead;
+    unsigned int          * cqTail;
+    unsigned int          * cqMask;
+    struct io_uring_cqe   * cqes;
+
+    void                  * sqMap;
+    size_t                  sqMapSize;
+    void                  * cqMap;
+    size_t                  cqMapSize;
+    size_t                  sqesSize;
+};
+
+
+static void bdRingClose(BdRing & ring)
+{
+    if  (ring.sqes)
+        munmap(ring.sqes, ring.sqesSize);
+
+    if  (ring.cqMap && ring.cqMap != ring.sqMap)
+        munmap(ring.cqMap, ring.cqMapSize);
+
+    if  (ring.sqMap)
+        munmap(ring.sqMap, ring.sqMapSize);
+
+    close(ring.fd);
+}
+
+
+static void *   bdRingMap(int fd, size_t size, off_t what)
+{
+    void    * p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, what);
+
+    return p == MAP_FAILED ? 0 : p;
+}
+
+
+// False where io_uring isn't there or not allowed
+static bool bdRingOpen(BdRing & ring, unsigned int depth)
+{
+    struct io_uring_params  params;
+
+    memset(&ring, 0, sizeof(ring));
+    memset(&params, 0, sizeof(params));
+
+    ring.fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+
+    if  (ring.fd < 0)
+        return false;
+
+    ring.entries   = params.sq_entries;
+    ring.sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring.cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring.sqesSize  = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if  (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring.sqMapSize = std::max(ring.sqMapSize, ring.cqMapSize);
+        ring.sqMap     = bdRingMap(ring.fd, ring.sqMapSize, IORING_OFF_SQ_RING);
+        ring.cqMap     = ring.sqMap;
+    }
+    else
+    {
+        ring.sqMap = bdRingMap(ring.fd, ring.sqMapSize, IORING_OFF_SQ_RING);
+        ring.cqMap = bdRingMap(ring.fd, ring.cqMapSize, IORING_OFF_CQ_RING);
+    }
+
+    ring.sqes = static_cast<struct io_uring_sqe *>(bdRingMap(ring.fd, ring.sqesSize, IORING_OFF_SQES));
+
+    if  (!ring.sqMap || !ring.cqMap || !ring.sqes)
+    {
+        bdRingClose(ring);
+        return false;
+    }
+
+    char    * sq = static_cast<char *>(ring.sqMap);
+    char    * cq = static_cast<char *>(ring.cqMap);
+
+    ring.sqHead  = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+    ring.sqTail  = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+    ring.sqMask  = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+    ring.sqArray = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+    ring.cqHead  = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+    ring.cqTail  = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+    ring.cqMask  = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+    ring.cqes    = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+
+/*
+    Keep up to a ring full of reads in flight.  A short read goes back
+    in the queue for the rest.  A read the kernel refuses, like
+    IORING_OP_READ on a kernel that doesn't have it, is left for
+    bdReadSync.
+
+    The kernel writes to the buffers of the reads in flight, so they
+    are waited for whatever happens.  When io_uring_enter fails, the
+    reads it didn't take are taken back out of the ring, the rest is
+    waited for, and false is returned: the ring isn't used again.
+    Throws std::bad_alloc before anything is sent.
+*/
+
+static bool bdRingRead(BdRing & ring, std::vector<BdLoadRead> & reads)
+{
+    std::vector<size_t>     queue(reads.size());
+    size_t                  next     = 0;
+    unsigned int            unsent   = 0;       // in the ring, not taken by the kernel
+    unsigned int            inFlight = 0;
+    bool                    failed   = false;
+
+    for (size_t i = 0; i < reads.size(); i++)
+        queue[i] = i;
+
+    while ((!failed && next < queue.size()) || unsent || inFlight)
+    {
+        unsigned int    tail = *ring.sqTail;
+
+        while (!failed && next < queue.size() && unsent + inFlight < ring.entries)
+        {
+            BdLoadRead            & r     = reads[queue[next]];
+            unsigned int            index = tail & *ring.sqMask;
+            struct io_uring_sqe   * sqe   = &ring.sqes[index];
+
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode    = IORING_OP_READ;
+            sqe->fd        = r.fd;
+            sqe->off       = r.offset;
+            sqe->addr      = (uint64_t)(uintptr_t)r.dest;
+            sqe->len       = r.len;
+            sqe->user_data = queue[next];
+
+            ring.sqArray[index] = index;
+
+            tail++;
+            next++;
+            unsent++;
+        }
+
+        __atomic_store_n(ring.sqTail, tail, __ATOMIC_RELEASE);
+
+        int sent = (int)syscall(__NR_io_uring_enter, ring.fd, unsent, 1, IORING_ENTER_GETEVENTS, 0, 0);
+
+        // the reads the kernel didn't take go to bdReadSync, once
+        // the ones in flight are done
+        if  (sent < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY && !failed)
+        {
+            __atomic_store_n(ring.sqTail, tail - unsent, __ATOMIC_RELEASE);
+
+            unsent = 0;
+            failed = true;
+        }
+
+        if  (sent < 0)
+            sent = 0;
+
+        unsent   -= (unsigned int)sent;
+        inFlight += (unsigned int)sent;
+
+        unsigned int    head = *ring.cqHead;
+        unsigned int    end  = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+
+        for (; head != end; head++)
+        {
+            const struct io_uring_cqe   * cqe   = &ring.cqes[head & *ring.cqMask];
+            BdLoadRead                  & r     = reads[(size_t)cqe->user_data];
+            int                           got   = cqe->res;
+            bool                          again = false;
+
+            inFlight--;
+
+            if  (got == -EINTR || got == -EAGAIN)
+                again = true;
+            else if (got == 0)
+            {
+                r.failed = true;
+                r.done   = true;
+            }
+            else if (got > 0 && (uint32_t)got < r.len)
+            {
+                r.dest   += got;
+                r.offset += (uint64_t)got;
+                r.len    -= (uint32_t)got;
+
+                again = true;
+            }
+            else if (got > 0)
+                r.done = true;
+
+            // a read that can't be queued again is left for
+            // bdReadSync
+            if  (again && !failed)
+            {
+                try
+                {
+                    queue.push_back((size_t)cqe->user_data);
+                }
+                catch (const std::bad_alloc &)
+                {
+                }
+            }
+        }
+
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    return !failed;
+}
+
+#else
+
+struct BdRing
+{
+    int     fd;
+};
+
+
+static bool bdRingOpen(BdRing &, unsigned int)
+{
+    return false;
+}
+
+
+static void bdRingClose(BdRing &)
+{
+}
+
+#endif  // BD_HAVE_IO_URING
+
+
+// Do all reads, through "ring" while it works, and mark the ranges
+// they belong to; a ring that fails is closed and set to NULL
+static void bdDoReads(BdRing * & ring, std::vector<BdLoadRead> & reads)
+{
+#ifdef BD_HAVE_IO_URING
+    if  (ring && !reads.empty())
+    {
+        try
+        {
+            if  (!bdRingRead(*ring, reads))
+            {
+                bdRingClose(*ring);
+                ring = 0;
+            }
+        }
+        catch (const std::bad_alloc &)
+        {
+        }
+    }
+#else
+    (void)ring;
+#endif
+
+    bdParallelFor(reads.size(), [&reads](size_t i)
+    {
+        if  (!reads[i].done)
+            bdReadSync(reads[i]);
+    });
+
+    for (size_t i = 0; i < reads.size(); i++)
+    {
+        reads[i].range->done    = true;
+        reads[i].range->failed |= reads[i].failed;
+    }
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    The prefetched ranges of a file
+*/
+
+static BdPrefetchRange *    bdFindRange(BdPrefetch * p, uint64_t offset, uint64_t len)
+{
+    for (size_t i = 0; i < p->ranges.size(); i++)
+    {
+        BdPrefetchRange & r = p->ranges[i];
+
+        if  (offset >= r.offset && offset + len <= r.offset + r.len)
+            return &r;
+    }
+
+    return 0;
+}
+
+
+// Ask for "len" bytes at "offset" in the next round, throws
+// std::bad_alloc
+static void bdWant(BdFile * f, uint64_t offset, uint64_t len)
+{
+    BdPrefetchRange r;
+
+    r.offset = offset;
+    r.len    = std::min(len, f->fileSize - offset);
+    r.done   = false;
+    r.failed = false;
+
+    f->prefetch->ranges.push_back(std::move(r));
+}
+
+
+// Whether "len" bytes at "offset" were read, or failed to be; asks
+// for them if not
+static bool bdNeed(BdFile * f, uint64_t offset, uint64_t len)
+{
+    if  (offset > f->fileSize || len > f->fileSize - offset)
+        return true;
+
+    BdPrefetchRange * r = bdFindRange(f->prefetch, offset, len);
+
+    if  (r)
+        return r->done;
+
+    bdWant(f, offset, len);
+    return false;
+}
+
+
+bool    bdPrefetchRead(BdFile * f, uint64_t offset, void * buf, size_t len)
+{
+    BdPrefetch      * p = f->prefetch;
+    BdPrefetchRange * r = bdFindRange(p, offset, len);
+
+    if  (r && r->done && !r->failed)
+    {
+        memcpy(buf, &r->data[offset - r->offset], len);
+        return true;
+    }
+
+    if  (p->readThrough || (r && r->done))
+        return false;
+
+    // read a little more, the parsers read a header and then what
+    // follows it
+    if  (!r)
+        bdWant(f, offset, std::max(len, (size_t)BD_LOAD_EDGE));
+
+    p->missed = true;
+    return false;
+}
+
+
+const unsigned char *   bdPrefetchData(BdFile * f, uint64_t offset, size_t len)
+{
+    BdPrefetchRange * r = bdFindRange(f->prefetch, offset, len);
+
+    if  (!r || !r->done || r->failed)
+        return 0;
+
+    return &r->data[offset - r->offset];
+}
+
+
+// Buffers and reads for the ranges asked for since the last round,
+// returns the bytes
+static uint64_t bdAddReads(BdFile * f, std::vector<BdLoadRead> & reads)
+{
+    std::vector<BdPrefetchRange>  & ranges = f->prefetch->ranges;
+    uint64_t                        bytes  = 0;
+
+    for (size_t i = 0; i < ranges.size(); i++)
+    {
+        BdPrefetchRange & r = ranges[i];
+
+        if  (r.done || r.data)
+            continue;
+
+        r.data.reset(new unsigned char[r.len ? r.len : 1]);
+        bytes += r.len;
+
+        for (uint64_t pos = 0; pos < r.len; pos += BD_LOAD_CHUNK)
+        {
+            BdLoadRead  read;
+
+            read.fd     = f->fd;
+            read.offset = r.offset + pos;
+            read.dest   = &r.data[pos];
+            read.len    = (uint32_t)std::min(r.len - pos, (uint64_t)BD_LOAD_CHUNK);
+            read.done   = false;
+            read.failed = false;
+            read.range  = &r;
+
+            reads.push_back(read);
+        }
+
+        if  (r.len == 0)
+            r.done = true;
+    }
+
+    return bytes;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    The steps of a file
+*/
+
+static void bdLoadOpen(BdLoadFile & lf, const char * fileName, unsigned int options)
+{
+    lf.f        = 0;
+    lf.step     = BD_STEP_DONE;
+    lf.sections = 0;
+    lf.result   = bdOpenFile(fileName, &lf.f, &lf.isTds, &lf.identity);
+
+    if  (lf.result != BD_FAIL_NONE)
+        return;
+
+    lf.f->options  = options;
+    lf.f->prefetch = &lf.prefetch;
+    lf.step        = BD_STEP_HEADER;
+
+    lf.prefetch.missed      = false;
+    lf.prefetch.readThrough = false;
+
+    // a .tds starts with the header, and the directory and the
+    // trailer of an .exe are usually at the end
+    bdWant(lf.f, 0, BD_LOAD_EDGE);
+
+    if  (lf.f->fileSize > BD_LOAD_EDGE)
+        bdWant(lf.f, std::max(lf.f->fileSize - BD_LOAD_EDGE, (uint64_t)BD_LOAD_EDGE), BD_LOAD_EDGE);
+}
+
+
+static void bdLoadHeader(BdLoadFile & lf)
+{
+    lf.prefetch.missed = false;
+
+    unsigned int    result = bdReadHeaders(lf.f, lf.isTds);
+
+    if  (lf.prefetch.missed)
+        return;
+
+    if  (result != BD_FAIL_NONE)
+    {
+        lf.result = result;
+        lf.step   = BD_STEP_DONE;
+        return;
+    }
+
+    // the directory is read, nothing else is needed from there
+    lf.prefetch.ranges.clear();
+    lf.step = BD_STEP_SECTIONS;
+}
+
+
+// The bytes of the sections of a file
+static uint64_t bdSectionBytes(BdFile * f)
+{
+    const BdSubSection  * names = bdFindSubSection(f, BORDEBUG_SSTNAMES);
+    const BdSubSection  * types = bdFindSubSection(f, BORDEBUG_SSTGLOBALTYPES);
+    uint64_t              bytes = 1;
+
+    if  (names && !(f->options & BORDEBUG_REGISTER_SKIPNAMES))
+        bytes += names->size;
+
+    // the indexes are built with all of sstGlobalTypes read
+    if  (types)
+        bytes += types->size;
+
+    return bytes;
+}
+
+
+// Ask for the sections, until all of them are there
+static void bdLoadSections(BdLoadFile & lf)
+{
+    BdFile              * f     = lf.f;
+    const BdSubSection  * names = bdFindSubSection(f, BORDEBUG_SSTNAMES);
+    const BdSubSection  * types = bdFindSubSection(f, BORDEBUG_SSTGLOBALTYPES);
+    bool                  ready = true;
+
+    if  (names && names->size >= 4 && !(f->options & BORDEBUG_REGISTER_SKIPNAMES))
+        ready = bdNeed(f, names->offset, names->size);
+
+    // the offset table follows the header with its count, see
+    // bdLoadTypes; a small one comes with the header
+    if  (types && types->size >= 8 && bdNeed(f, types->offset, std::min(types->size, (uint32_t)BD_LOAD_EDGE)))
+    {
+        unsigned char   header[8];
+
+        if  (bdPrefetchRead(f, types->offset, header, sizeof(header)))
+        {
+            uint64_t    table = (uint64_t)bdGet32(header + 4) * 4;
+
+            if  (table <= types->size - 8 && !bdNeed(f, types->offset, 8 + table))
+                ready = false;
+        }
+    }
+    else if (types && types->size >= 8)
+        ready = false;
+
+    if  (ready)
+        lf.step = BD_STEP_INDEXES;
+}
+
+
+static void bdLoadIndexes(BdLoadFile & lf)
+{
+    lf.prefetch.readThrough = true;
+
+    try
+    {
+        lf.result = bdRegisterIndexes(lf.f, lf.identity);
+    }
+    catch (const std::bad_alloc &)
+    {
+        lf.result = BD_FAIL_MEMORY;
+    }
+
+    lf.step = BD_STEP_DONE;
+}
+
+
+// The file is registered, or failed
+static void bdLoadFinish(BdLoadFile & lf, BorDebugCookie * cookie, unsigned int * failure)
+{
+    if  (lf.f)
+    {
+        lf.f->prefetch = 0;
+
+        if  (lf.result != BD_FAIL_NONE)
+        {
+            bdFreeFile(lf.f);
+            lf.f = 0;
+        }
+    }
+
+    lf.prefetch.ranges.clear();
+    lf.prefetch.ranges.shrink_to_fit();
+
+    *cookie = lf.f;
+
+    if  (failure)
+        *failure = lf.result;
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugLoadFiles(const char * const  * fileNames,
+                          unsigned int          count,
+                          unsigned int          options,
+                          BorDebugCookie      * cookies,
+                          unsigned int        * failures)
+{
+    // a mapped file is read by the page cache anyway
+    if  (options & BORDEBUG_REGISTER_MAP)
+    {
+        BorDebugRegisterFiles(fileNames, count, options | BORDEBUG_REGISTER_EAGER, cookies, failures);
+        return;
+    }
+
+    options |= BORDEBUG_REGISTER_EAGER;
+    options &= ~(unsigned int)BORDEBUG_REGISTER_ASYNC;
+
+    std::vector<BdLoadFile>     files;
+    std::vector<size_t>         active;         // files not done, by index
+    std::vector<size_t>         indexes;
+    std::vector<BdLoadRead>     reads;
+    unsigned int                next     = 0;
+    uint64_t                    sections = 0;   // bytes kept, see BD_LOAD_BYTES
+    BdRing                      ringData;
+    BdRing                    * ring     = 0;   // for all rounds
+
+    try
+    {
+        files.resize(count);
+        active.reserve(BD_LOAD_FILES);
+    }
+    catch (const std::bad_alloc &)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            cookies[i] = 0;
+
+            if  (failures)
+                failures[i] = BD_FAIL_MEMORY;
+        }
+
+        return;
+    }
+
+    if  (bdRingOpen(ringData, BD_LOAD_DEPTH))
+        ring = &ringData;
+
+    while (next < count || !active.empty())
+    {
+        // files that start, up to BD_LOAD_FILES at a time
+        while (next < count && active.size() < BD_LOAD_FILES)
+        {
+            BdLoadFile  & lf = files[next];
+
+            try
+            {
+                bdLoadOpen(lf, fileNames[next], options);
+            }
+            catch (const std::bad_alloc &)
+            {
+                lf.result = BD_FAIL_MEMORY;
+                lf.step   = BD_STEP_DONE;
+            }
+
+            if  (lf.step == BD_STEP_DONE)
+                bdLoadFinish(lf, &cookies[next], failures ? &failures[next] : 0);
+            else
+                active.push_back(next);
+
+            next++;
+        }
+
+        // the steps that work on what was read, and what they ask for
+        indexes.clear();
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            BdLoadFile  & lf = files[active[i]];
+
+            try
+            {
+                if  (lf.step == BD_STEP_HEADER)
+                    bdLoadHeader(lf);
+
+                if  (lf.step == BD_STEP_SECTIONS && !lf.sections)
+                {
+                    uint64_t    bytes = bdSectionBytes(lf.f);
+
+                    // one file at least, however large it is
+                    if  (sections == 0 || sections + bytes <= BD_LOAD_BYTES)
+                    {
+                        lf.sections  = bytes;
+                        sections    += bytes;
+                    }
+                }
+
+                if  (lf.step == BD_STEP_SECTIONS && lf.sections)
+                    bdLoadSections(lf);
+
+                if  (lf.step == BD_STEP_INDEXES)
+                    indexes.push_back(active[i]);
+            }
+            catch (const std::bad_alloc &)
+            {
+                lf.result = BD_FAIL_MEMORY;
+                lf.step   = BD_STEP_DONE;
+            }
+        }
+
+        // the files that have all they need build their indexes side
+        // by side
+        bdParallelFor(indexes.size(), [&files, &indexes](size_t i)
+        {
+            bdLoadIndexes(files[indexes[i]]);
+        });
+
+        // the next round of reads
+        reads.clear();
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            BdLoadFile  & lf = files[active[i]];
+
+            if  (lf.step == BD_STEP_DONE)
+                continue;
+
+            try
+            {
+                bdAddReads(lf.f, reads);
+            }
+            catch (const std::bad_alloc &)
+            {
+                lf.result = BD_FAIL_MEMORY;
+                lf.step   = BD_STEP_DONE;
+            }
+        }
+
+        // a failed file may leave reads behind in its buffers, so
+        // they are done before anything is freed
+        bdDoReads(ring, reads);
+
+        size_t  kept = 0;
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            BdLoadFile  & lf = files[active[i]];
+
+            if  (lf.step != BD_STEP_DONE)
+            {
+                active[kept++] = active[i];
+                continue;
+            }
+
+            sections -= lf.sections;
+            bdLoadFinish(lf, &cookies[active[i]], failures ? &failures[active[i]] : 0);
+        }
+
+        active.resize(kept);
+    }
+
+    if  (ring)
+        bdRingClose(*ring);
+}
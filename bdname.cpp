@@ -0,0 +1,1291 @@
+//---------------------------------------------------------------------
+
+/*
+    sstNames and index API's
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+/*
+    sstNames page cache
+
+    Under a memory budget the sstNames text is cached in pages of
+    BD_NAME_PAGE bytes, the least recently used page is dropped first.
+    A slot holds its page and BD_NAME_TAIL bytes after it, so every
+    name that starts in a page can be read from its slot.  Longer
+    names go through the read window.  The slots are allocated once,
+    when the first name is read after the budget is set.
+*/
+
+enum
+{
+    BD_NAME_PAGE    = 0x4000,
+    BD_NAME_TAIL    = 0x400,
+    BD_NAME_SLOT    = BD_NAME_PAGE + BD_NAME_TAIL,
+};
+
+
+static void bdDropPages(BdFile * f)
+{
+    BdVector<char>(f->arena).swap(f->pageText);
+    BdVector<BdNameSlot>(f->arena).swap(f->pageSlots);
+    BdVector<int32_t>(f->arena).swap(f->pageMap);
+
+    f->pagesReady = false;
+}
+
+
+static void bdSetupPages(BdFile * f)
+{
+    uint64_t    slots = f->budget / BD_NAME_SLOT;
+    uint64_t    pages = f->namesSize / BD_NAME_PAGE + 1;
+
+    f->pagesReady = true;
+
+    // a file that is in memory, or a full copy, needs no pages
+    if  (f->image || f->nameText || slots == 0)
+        return;
+
+    if  (slots > pages)
+        slots = pages;
+
+    try
+    {
+        f->pageText.resize((size_t)slots * BD_NAME_SLOT);
+        f->pageSlots.resize((size_t)slots);
+        f->pageMap.assign((size_t)pages, -1);
+    }
+    catch (const std::bad_alloc &)
+    {
+        bdDropPages(f);
+        f->pagesReady = true;
+        return;
+    }
+
+    for (int32_t i = 0; i < (int32_t)slots; i++)
+    {
+        f->pageSlots[i].page = -1;
+        f->pageSlots[i].prev = i - 1;
+        f->pageSlots[i].next = i + 1 < (int32_t)slots ? i + 1 : -1;
+        f->pageSlots[i].len  = 0;
+    }
+
+    f->lruFirst = 0;
+    f->lruLast  = (int32_t)slots - 1;
+}
+
+
+static void bdTouchSlot(BdFile * f, int32_t slot)
+{
+    BdNameSlot  & s = f->pageSlots[slot];
+
+    if  (f->lruFirst == slot)
+        return;
+
+    // unlink, it is not the first so it has a prev
+    f->pageSlots[s.prev].next = s.next;
+
+    if  (s.next >= 0)
+        f->pageSlots[s.next].prev = s.prev;
+    else
+        f->lruLast = s.prev;
+
+    s.prev = -1;
+    s.next = f->lruFirst;
+
+    f->pageSlots[f->lruFirst].prev = slot;
+    f->lruFirst = slot;
+}
+
+
+// Text at "start" in sstNames, from the page cache when possible
+static const char * bdPagedText(BdFile * f, uint32_t start, uint32_t span)
+{
+    uint32_t    page   = start / BD_NAME_PAGE;
+    uint32_t    offset = start % BD_NAME_PAGE;
+    int32_t     slot   = f->pageMap[page];
+
+    if  (offset + span > BD_NAME_SLOT)
+        return reinterpret_cast<const char *>(bdPeek(f, f->namesOffset + start, span));
+
+    if  (slot >= 0)
+        f->pageHits++;
+    else
+    {
+        uint32_t    first = page * BD_NAME_PAGE;
+        uint32_t    len   = f->namesSize - first < BD_NAME_SLOT ? f->namesSize - first : (uint32_t)BD_NAME_SLOT;
+
+        slot = f->lruLast;
+        f->pageMisses++;
+
+        if  (f->pageSlots[slot].page >= 0)
+        {
+            f->pageMap[f->pageSlots[slot].page] = -1;
+            f->pageSlots[slot].page = -1;
+            f->pageEvictions++;
+        }
+
+        if  (!bdReadAt(f, f->namesOffset + first, &f->pageText[(size_t)slot * BD_NAME_SLOT], len))
+            return reinterpret_cast<const char *>(bdPeek(f, f->namesOffset + start, span));
+
+        f->pageSlots[slot].page = (int32_t)page;
+        f->pageSlots[slot].len  = len;
+        f->pageMap[page]        = slot;
+    }
+
+    bdTouchSlot(f, slot);
+
+    if  (offset + span > f->pageSlots[slot].len)
+        return reinterpret_cast<const char *>(bdPeek(f, f->namesOffset + start, span));
+
+    return &f->pageText[(size_t)slot * BD_NAME_SLOT + offset];
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Scanning sstNames
+
+    A name is a length byte, the text and a 0, and the length byte
+    has only the low 8 bits of the length.  A name ends at the byte
+    the length byte points at when that is a 0, otherwise at the
+    first 0 after it.  That reads 2 bytes of most names, so going
+    through a large section is bound by memory, not by the scan.
+
+    A large section is scanned in parts side by side instead.  Text
+    has no 0 bytes, so a part takes the byte after its first 0 as the
+    start of a name, which is right unless that 0 was a length byte.
+    Where a name starts depends only on where the one before does,
+    so once the names of a part meet a name found before it, they are
+    the same from there on.  The parts are joined in order at such a
+    name; the names before it are scanned again, one at a time.
+*/
+
+enum
+{
+    BD_SCAN_PART    = 0x400000,         // least bytes for each thread
+};
+
+
+// Where the name at "pos" ends, "size" if it doesn't
+static uint32_t bdNameEnd(const unsigned char * text, uint32_t pos, uint32_t size)
+{
+    uint32_t    next = pos + 1 + text[pos];
+
+    if  (next < size && text[next] == 0)
+        return next;
+
+    const void  * zero = memchr(text + pos + 1, 0, size - pos - 1);
+
+    return zero ? (uint32_t)(static_cast<const unsigned char *>(zero) - text) : size;
+}
+
+
+uint32_t    bdScanNames(const unsigned char * text,
+                        uint32_t              size,
+                        uint32_t              pos,
+                        uint32_t              stop,
+                        uint32_t              count,
+                        BdVector<uint32_t>  & offsets)
+{
+    size_t  parts = pos < stop ? (stop - pos) / BD_SCAN_PART : 0;
+
+    parts = std::min<size_t>(parts, bdThreadCount());
+
+    if  (parts < 2)
+        return pos;
+
+    std::vector<std::vector<uint32_t>>  found(parts);
+    std::vector<char>                   failed(parts, 0);
+    uint32_t                            step = (uint32_t)((stop - pos) / parts);
+
+    bdParallelFor(parts, [&](size_t k)
+    {
+        uint32_t    at = pos + step * (uint32_t)k;
+        uint32_t    to = k + 1 == parts ? stop : at + step;
+
+        if  (k)
+        {
+            const void  * zero = memchr(text + at, 0, size - at);
+
+            at = zero ? (uint32_t)(static_cast<const unsigned char *>(zero) - text) + 1 : size;
+        }
+
+        try
+        {
+            // about the share of the names the part has, when the
+            // count is right; a name takes 2 bytes at least
+            if  (at < to)
+                found[k].reserve(std::min<size_t>((size_t)count / parts + count / parts / 8, (to - at) / 2 + 1));
+
+            for (uint32_t last; at < to && (last = bdNameEnd(text, at, size)) < size; at = last + 1)
+                found[k].push_back(at);
+        }
+        catch (const std::bad_alloc &)
+        {
+            failed[k] = 1;
+        }
+    });
+
+    if  (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        throw std::bad_alloc();
+
+    for (size_t k = 0; k < parts && offsets.size() < count; k++)
+    {
+        const std::vector<uint32_t> & names = found[k];
+        size_t                        j     = std::lower_bound(names.begin(), names.end(), pos) - names.begin();
+
+        // catch up with the names of the part
+        while (j < names.size() && names[j] != pos && offsets.size() < count)
+        {
+            uint32_t    last = bdNameEnd(text, pos, size);
+
+            if  (last == size)
+                return pos;
+
+            offsets.push_back(pos);
+            pos = last + 1;
+
+            while (j < names.size() && names[j] < pos)
+                j++;
+        }
+
+        size_t  take = std::min<size_t>(names.size() - j, count - offsets.size());
+
+        if  (take == 0)
+            continue;
+
+        offsets.insert(offsets.end(), names.begin() + j, names.begin() + j + take);
+        pos = bdNameEnd(text, offsets.back(), size) + 1;
+    }
+
+    return pos;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Compact name index
+
+    Without a copy of the text, the name index is most of the memory
+    of a registration at 4 bytes a name.  But names follow one
+    another: the next name starts after the length byte, the name and
+    the terminator.  So the compact index has a byte for each name
+    with that distance less 2, which is the length of the name, and
+    offsets only for some of the names.  A name too long for the byte
+    gets 255, and its distance goes in a list of pairs at the end.
+
+        DWORD   blocks[cBlocks]             offset of every 64th name
+        WORD    groups[cBlocks][7]          of every 8th name in between,
+                                            from the one of the block
+        BYTE    steps[cNames]
+        DWORD   longSteps[cLong][2]         name, distance
+
+    An offset is the one of its group plus up to 7 steps, about 1.3
+    bytes a name.  A group that is too far from its block, which
+    only long names can do, has 0xFFFF, and then the steps from the
+    start of the block are added.  An index that would not be half
+    the size of the offsets is left as it is.
+*/
+
+enum
+{
+    BD_NAME_BLOCK   = 64,
+    BD_NAME_GROUP   = 8,
+    BD_NAME_GROUPS  = BD_NAME_BLOCK / BD_NAME_GROUP - 1,
+    BD_NAME_LONG    = 255,
+    BD_NAME_FAR     = 0xFFFF,
+};
+
+
+static uint32_t bdBlockCount(uint32_t count)
+{
+    return (count + BD_NAME_BLOCK - 1) / BD_NAME_BLOCK;
+}
+
+
+// Words of the parts before the steps, and of the steps
+static uint32_t bdGroupWords(uint32_t count)
+{
+    return bdBlockCount(count) + (bdBlockCount(count) * BD_NAME_GROUPS + 1) / 2;
+}
+
+
+static uint32_t bdStepWords(uint32_t count)
+{
+    return (count + 3) / 4;
+}
+
+
+static const uint16_t * bdGroups(const BdFile * f)
+{
+    return reinterpret_cast<const uint16_t *>(f->nameCompact + bdBlockCount(f->nameCount));
+}
+
+
+static const uint8_t *  bdSteps(const BdFile * f)
+{
+    return reinterpret_cast<const uint8_t *>(f->nameCompact + bdGroupWords(f->nameCount));
+}
+
+
+// Distance from name i to the next
+static uint32_t bdStep(const BdFile * f, const uint8_t * steps, uint32_t i)
+{
+    if  (steps[i] != BD_NAME_LONG)
+        return steps[i] + 2u;
+
+    const uint32_t  * pairs = f->nameCompact + bdGroupWords(f->nameCount) + bdStepWords(f->nameCount);
+    uint32_t          lo    = 0;
+    uint32_t          hi    = f->nameLongCount;
+
+    while (lo < hi)
+    {
+        uint32_t    mid = (lo + hi) / 2;
+
+        if  (pairs[mid * 2] < i)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return pairs[lo * 2 + 1];
+}
+
+
+void    bdCompactNames(BdFile * f)
+{
+    const uint32_t  * index = f->nameIndex;
+    uint32_t          count = f->nameCount;
+    uint32_t          longs = 0;
+
+    if  (count == 0 || index != f->nameOffsets.data())
+        return;
+
+    for (uint32_t i = 0; i + 1 < count; i++)
+    {
+        // the offsets go up by 2 at least, see bdLoadNames
+        if  (index[i + 1] < index[i] + 2)
+            return;
+
+        if  (index[i + 1] - index[i] - 2 >= BD_NAME_LONG)
+            longs++;
+    }
+
+    uint32_t            head  = bdGroupWords(count);
+    uint32_t            steps = bdStepWords(count);
+
+    // mostly long names save little and cost a search each
+    if  (((size_t)head + steps + (size_t)longs * 2) * 2 > count)
+        return;
+    BdVector<uint32_t>  data(f->indexArena);
+
+    try
+    {
+        data.assign((size_t)head + steps + (size_t)longs * 2, 0);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return;
+    }
+
+    uint16_t    * group = reinterpret_cast<uint16_t *>(&data[bdBlockCount(count)]);
+    uint8_t     * step  = reinterpret_cast<uint8_t *>(&data[head]);
+    uint32_t    * pairs = &data[head + steps];
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t    block = i / BD_NAME_BLOCK;
+        uint32_t    inner = i % BD_NAME_BLOCK;
+
+        if  (inner == 0)
+            data[block] = index[i];
+        else if (inner % BD_NAME_GROUP == 0)
+        {
+            uint32_t    distance = index[i] - data[block];
+
+            group[block * BD_NAME_GROUPS + inner / BD_NAME_GROUP - 1] =
+                (uint16_t)(distance < BD_NAME_FAR ? distance : (uint32_t)BD_NAME_FAR);
+        }
+
+        if  (i + 1 == count)
+            break;
+
+        uint32_t    distance = index[i + 1] - index[i];
+
+        if  (distance - 2 < BD_NAME_LONG)
+            step[i] = (uint8_t)(distance - 2);
+        else
+        {
+            step[i]  = BD_NAME_LONG;
+            *pairs++ = i;
+            *pairs++ = distance;
+        }
+    }
+
+    f->nameCompactData.swap(data);
+    f->nameCompact   = f->nameCompactData.data();
+    f->nameLongCount = longs;
+    f->nameIndex     = 0;
+
+    BdVector<uint32_t>(f->indexArena).swap(f->nameOffsets);
+}
+
+
+uint32_t    bdCompactOffset(const BdFile * f, uint32_t i)
+{
+    const uint8_t   * steps  = bdSteps(f);
+    uint32_t          block  = i / BD_NAME_BLOCK;
+    uint32_t          inner  = i % BD_NAME_BLOCK / BD_NAME_GROUP;
+    uint32_t          offset = f->nameCompact[block];
+    uint32_t          first  = block * BD_NAME_BLOCK;
+
+    if  (inner)
+    {
+        uint32_t    distance = bdGroups(f)[block * BD_NAME_GROUPS + inner - 1];
+
+        if  (distance != BD_NAME_FAR)
+        {
+            offset += distance;
+            first  += inner * BD_NAME_GROUP;
+        }
+    }
+
+    for (uint32_t j = first; j < i; j++)
+        offset += bdStep(f, steps, j);
+
+    return offset;
+}
+
+
+void    bdNameOffsets(const BdFile * f, uint32_t * offsets)
+{
+    if  (f->nameIndex)
+    {
+        memcpy(offsets, f->nameIndex, (size_t)f->nameCount * 4);
+        return;
+    }
+
+    const uint8_t   * steps = bdSteps(f);
+
+    for (uint32_t i = 0; i < f->nameCount; i++)
+    {
+        if  (i % BD_NAME_BLOCK == 0)
+            offsets[i] = f->nameCompact[i / BD_NAME_BLOCK];
+        else
+            offsets[i] = offsets[i - 1] + bdStep(f, steps, i - 1);
+    }
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Text and length of a 1-based name index.  The text is not zero
+    terminated, and is only valid until the next read from the file.
+    Returns false if there is no such name.  The length byte in front
+    of the name gives the length, unless the name is too long for it;
+    then the terminator is looked for.
+*/
+
+// Where the name is in sstNames, from the length byte up to the next
+// name
+static bool bdNameRange(const BdFile * f, unsigned int name, uint32_t * first, uint32_t * span)
+{
+    if  (name == 0 || name > f->nameCount)
+        return false;
+
+    uint32_t    start = bdNameOffset(f, name - 1);
+    uint32_t    end   = f->namesSize;
+
+    if  (name < f->nameCount && f->nameIndex)
+        end = f->nameIndex[name];
+    else if (name < f->nameCount)
+        end = start + bdStep(f, bdSteps(f), name - 1);
+
+    *first = start;
+    *span  = end - start;
+    return true;
+}
+
+
+// The name in the "span" bytes at p
+static void bdNameText(const char * p, uint32_t span, const char ** text, uint32_t * len)
+{
+    uint32_t    lenByte = (unsigned char)p[0];
+
+    *text = p + 1;
+    span--;
+
+    if  (lenByte < span && (*text)[lenByte] == 0)
+    {
+        *len = lenByte;
+        return;
+    }
+
+    const void  * zero = memchr(*text, 0, span);
+
+    *len = zero ? (uint32_t)(static_cast<const char *>(zero) - *text) : span;
+}
+
+
+static bool bdNameSpan(BdFile * f, unsigned int name, const char ** text, uint32_t * len)
+{
+    uint32_t        first;
+    uint32_t        span;
+    const char    * p;
+
+    if  (!bdNameRange(f, name, &first, &span))
+        return false;
+
+    if  (f->budget && !f->pagesReady)
+        bdSetupPages(f);
+
+    if  (f->nameText)
+        p = f->nameText + first;
+    else if (!f->pageSlots.empty())
+        p = bdPagedText(f, first, span);
+    else
+        p = reinterpret_cast<const char *>(bdPeek(f, f->namesOffset + first, span));
+
+    bdNameText(p, span, text, len);
+    return true;
+}
+
+
+/*
+    Names in bulk
+
+    Without the text in memory every name is a read of the file.  A
+    batch sorts the names by where they are in sstNames, and reads
+    the ones that are less than BD_BATCH_GAP apart together, up to
+    BD_BATCH_READ bytes at a time.  The names go to a buffer in the
+    order of the file first, then to the caller in the order asked.
+*/
+
+enum
+{
+    BD_BATCH_GAP    = 0x1000,
+    BD_BATCH_READ   = 0x100000,
+};
+
+
+struct BdBatchName
+{
+    uint32_t    first;                  // offset in sstNames
+    uint32_t    span;                   // up to the next name
+    uint32_t    slot;                   // in the caller's order
+};
+
+
+// Read the names of "want", sorted by offset, into "text", and set
+// the start and length of each in "starts" and "lens"
+static void bdReadNames(BdFile                          * f,
+                        const std::vector<BdBatchName>  & want,
+                        std::string                     & text,
+                        std::vector<uint32_t>           & starts,
+                        std::vector<uint32_t>           & lens)
+{
+    std::vector<char>   run;
+
+    for (size_t i = 0; i < want.size(); )
+    {
+        uint32_t    first = want[i].first;
+        uint32_t    end   = first + want[i].span;
+        size_t      last  = i + 1;
+
+        while (last < want.size() &&
+               want[last].first <= end + BD_BATCH_GAP &&
+               want[last].first + want[last].span - first <= BD_BATCH_READ)
+        {
+            if  (want[last].first + want[last].span > end)
+                end = want[last].first + want[last].span;
+
+            last++;
+        }
+
+        run.resize(end - first);
+
+        bool    read = bdReadAt(f, f->namesOffset + first, run.data(), run.size());
+
+        for (; i < last; i++)
+        {
+            const char    * name;
+            uint32_t        len;
+
+            // a failed read goes one name at a time, as without a batch
+            if  (read)
+                bdNameText(&run[want[i].first - first], want[i].span, &name, &len);
+            else
+            {
+                const char  * p = reinterpret_cast<const char *>(bdPeek(f, f->namesOffset + want[i].first, want[i].span));
+
+                bdNameText(p, want[i].span, &name, &len);
+            }
+
+            starts[want[i].slot] = (uint32_t)text.size();
+            lens[want[i].slot]   = len;
+            text.append(name, len);
+        }
+    }
+}
+
+
+static void bdCopyString(const char * text, uint32_t len, char * buf, unsigned int bufLen)
+{
+    if  (!buf || !bufLen)
+        return;
+
+    uint32_t    n = len < bufLen - 1 ? len : bufLen - 1;
+
+    memcpy(buf, text, n);
+    buf[n] = 0;
+}
+
+
+/*
+    Unmangled names
+
+    Unmangling is the slowest lookup there is, and the same names are
+    asked for over and over, so a name is unmangled once and kept.
+    The text goes into blocks of BD_UM_BLOCK bytes in the arena,
+    after its length, and umNames points at it.  Under a budget the
+    blocks and umNames get what the sstNames copy leaves; a name that
+    doesn't fit any more is unmangled on every call, into a string of
+    the caller.
+
+    The kept names are made with SHOW_TROUBLED_NAME as it was when
+    umNames was made.  It is looked at on every call, and a call made
+    with it the other way unmangles the name again rather than use
+    them.  umLock is held for all of the um members; a name is
+    unmangled without it.
+
+    BorDebugUnmangleNames does all names, BD_UM_BATCH at a time: it
+    reads their text with few reads, unmangles them in parts on the
+    worker pool, then keeps them in order.
+*/
+
+enum
+{
+    BD_UM_BLOCK     = 0x10000,
+    BD_UM_BATCH     = 0x10000,          // names read at a time
+    BD_UM_PART      = 0x400,            // names for a worker at a time
+};
+
+
+static uint64_t bdUnmangledSize(const BdFile * f)
+{
+    return f->umSize + f->umNames.capacity() * sizeof(const char *) +
+           f->umBlocks.capacity() * sizeof(BdUmBlock);
+}
+
+
+static void bdDropUnmangled(BdFile * f)
+{
+    for (size_t i = 0; i < f->umBlocks.size(); i++)
+        bdArenaFree(f->arena, f->umBlocks[i].text, f->umBlocks[i].size);
+
+    BdVector<const char *>(f->arena).swap(f->umNames);
+    BdVector<BdUmBlock>(f->arena).swap(f->umBlocks);
+
+    f->umUsed  = 0;
+    f->umSize  = 0;
+    f->umCount = 0;
+}
+
+
+// Room under the budget for "size" more bytes of unmangled names
+static bool bdUnmangledFit(const BdFile * f, uint64_t size)
+{
+    uint64_t    budget = f->budget;
+    uint64_t    text   = f->nameCache.capacity() + f->pageText.capacity();
+
+    return !budget || text + bdUnmangledSize(f) + size <= budget;
+}
+
+
+// Make umNames when it fits.  Returns whether there is one for
+// "showTroubled".  umLock is held.  Throws std::bad_alloc.
+static bool bdUnmangledTable(BdFile * f, int showTroubled)
+{
+    // the pages take their part of the budget first
+    if  (f->budget && !f->pagesReady)
+        bdSetupPages(f);
+
+    if  (f->umNames.empty() && f->nameCount &&
+         bdUnmangledFit(f, (uint64_t)f->nameCount * sizeof(const char *)))
+    {
+        f->umNames.assign(f->nameCount, 0);
+        f->umTroubled = showTroubled;
+    }
+
+    return !f->umNames.empty() && f->umTroubled == showTroubled;
+}
+
+
+// Keep the text of the 0-based name i.  Returns the kept text, or
+// NULL when it doesn't fit the budget.  umLock is held.  Throws
+// std::bad_alloc.
+static const char * bdKeepUnmangled(BdFile * f, uint32_t i, const char * text, uint32_t len)
+{
+    uint32_t    need = 4 + len + 1;
+
+    if  (f->umBlocks.empty() || f->umBlocks.back().size - f->umUsed < need)
+    {
+        BdUmBlock   block;
+
+        block.size = need > BD_UM_BLOCK ? need : (uint32_t)BD_UM_BLOCK;
+
+        if  (!bdUnmangledFit(f, block.size + sizeof(BdUmBlock)))
+            return 0;
+
+        f->umBlocks.reserve(f->umBlocks.size() + 1);
+
+        block.text = static_cast<char *>(bdArenaAlloc(f->arena, block.size));
+
+        f->umBlocks.push_back(block);
+        f->umUsed  = 0;
+        f->umSize += block.size;
+    }
+
+    char    * p = f->umBlocks.back().text + f->umUsed;
+
+    memcpy(p, &len, 4);
+    memcpy(p + 4, text, len);
+    p[4 + len] = 0;
+
+    f->umUsed    += need;
+    f->umNames[i] = p + 4;
+    f->umCount++;
+
+    return p + 4;
+}
+
+
+// Unmangle "len" bytes of a mangled name, the whole of it
+static void bdUnmangleText(const char * name, uint32_t len, int showTroubled, std::string & out)
+{
+    bdUnmangleString(std::string(name, len).c_str(), 1, showTroubled, out);
+}
+
+
+// The unmangled text of a 1-based name index, kept or in "scratch".
+// Returns false if there is no such name.  Throws std::bad_alloc.
+static bool bdUnmangledSpan(BdFile          * f,
+                            unsigned int      name,
+                            int               showTroubled,
+                            std::string     & scratch,
+                            const char     ** text,
+                            uint32_t        * len)
+{
+    if  (name == 0 || name > f->nameCount)
+        return false;
+
+    std::string     mangled;
+
+    {
+        std::lock_guard<std::mutex> hold(f->umLock);
+
+        if  (bdUnmangledTable(f, showTroubled) && f->umNames[name - 1])
+        {
+            *text = f->umNames[name - 1];
+            memcpy(len, *text - 4, 4);
+            return true;
+        }
+
+        // the read window and the pages the text may be in change
+        // with every read, so it is taken out under the lock
+        const char    * p;
+        uint32_t        n;
+
+        bdNameSpan(f, name, &p, &n);
+        mangled.assign(p, n);
+    }
+
+    bdUnmangleString(mangled.c_str(), 1, showTroubled, scratch);
+
+    *len  = (uint32_t)scratch.size();
+    *text = 0;
+
+    {
+        std::lock_guard<std::mutex> hold(f->umLock);
+
+        // another call may have kept it in the meantime
+        if  (bdUnmangledTable(f, showTroubled))
+        {
+            *text = f->umNames[name - 1];
+
+            if  (!*text)
+                *text = bdKeepUnmangled(f, name - 1, scratch.data(), *len);
+        }
+    }
+
+    if  (!*text)
+        *text = scratch.c_str();
+
+    return true;
+}
+
+
+// Unmangle the names of "todo", and keep the ones that weren't kept
+// in the meantime.  Returns false when the budget is used up, or the
+// kept names are for the other "showTroubled".  Throws
+// std::bad_alloc.
+static bool bdUnmangleBatch(BdFile * f, const std::vector<uint32_t> & todo, int showTroubled)
+{
+    std::vector<const char *>   names(todo.size());
+    std::vector<uint32_t>       lens(todo.size());
+    std::vector<uint32_t>       starts(todo.size());
+    std::string                 text;
+
+    // the mangled names, from memory or with few reads
+    if  (f->nameText || f->image)
+    {
+        for (size_t j = 0; j < todo.size(); j++)
+            bdNameSpan(f, todo[j] + 1, &names[j], &lens[j]);
+    }
+    else
+    {
+        std::vector<BdBatchName>    want(todo.size());
+
+        for (size_t j = 0; j < todo.size(); j++)
+        {
+            bdNameRange(f, todo[j] + 1, &want[j].first, &want[j].span);
+            want[j].slot = (uint32_t)j;
+        }
+
+        bdReadNames(f, want, text, starts, lens);
+
+        for (size_t j = 0; j < todo.size(); j++)
+            names[j] = text.data() + starts[j];
+    }
+
+    size_t                              parts = (todo.size() + BD_UM_PART - 1) / BD_UM_PART;
+    std::vector<std::string>            out(parts);
+    std::vector<std::vector<uint32_t>>  ends(parts);
+    std::vector<char>                   failed(parts, 0);
+
+    bdParallelFor(parts, [&](size_t k)
+    {
+        size_t  last = std::min<size_t>((k + 1) * BD_UM_PART, todo.size());
+
+        try
+        {
+            std::string     one;
+
+            for (size_t j = k * BD_UM_PART; j < last; j++)
+            {
+                bdUnmangleText(names[j], lens[j], showTroubled, one);
+                out[k] += one;
+                ends[k].push_back((uint32_t)out[k].size());
+            }
+        }
+        catch (const std::bad_alloc &)
+        {
+            failed[k] = 1;
+        }
+    });
+
+    if  (std::find(failed.begin(), failed.end(), 1) != failed.end())
+        throw std::bad_alloc();
+
+    std::lock_guard<std::mutex> hold(f->umLock);
+
+    if  (!bdUnmangledTable(f, showTroubled))
+        return false;
+
+    for (size_t k = 0; k < parts; k++)
+    {
+        uint32_t    start = 0;
+
+        for (size_t j = 0; j < ends[k].size(); j++)
+        {
+            uint32_t    i = todo[k * BD_UM_PART + j];
+
+            if  (!f->umNames[i] && !bdKeepUnmangled(f, i, out[k].data() + start, ends[k][j] - start))
+                return false;
+
+            start = ends[k][j];
+        }
+    }
+
+    return true;
+}
+
+
+//---------------------------------------------------------------------
+
+unsigned int    BorDebugNamesTotalNames(BorDebugCookie registerCookie)
+{
+    return bdNamesFile(registerCookie)->nameCount;
+}
+
+
+void    BorDebugNameIndexToUnmangledName(BorDebugCookie registerCookie,
+                                         unsigned int   name,
+                                         char         * buf,
+                                         unsigned int   bufLen)
+{
+    const char  * text;
+    uint32_t      len;
+    std::string   scratch;
+
+    if  (!buf || !bufLen)
+        return;
+
+    try
+    {
+        if  (!bdUnmangledSpan(bdNamesFile(registerCookie), name, getenv("SHOW_TROUBLED_NAME") != 0,
+                              scratch, &text, &len))
+        {
+            text = "";
+            len  = 0;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        text = "";
+        len  = 0;
+    }
+
+    bdCopyString(text, len, buf, bufLen);
+}
+
+
+unsigned int    BorDebugNameIndexToUnmangledNameView(BorDebugCookie    registerCookie,
+                                                     unsigned int      name,
+                                                     const char     ** text)
+{
+    // a name that isn't kept stays here until the next call of the
+    // thread
+    static thread_local std::string scratch;
+
+    const char  * found;
+    uint32_t      len;
+
+    try
+    {
+        if  (!bdUnmangledSpan(bdNamesFile(registerCookie), name, getenv("SHOW_TROUBLED_NAME") != 0,
+                              scratch, &found, &len))
+        {
+            found = "";
+            len   = 0;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        found = "";
+        len   = 0;
+    }
+
+    if  (text)
+        *text = found;
+
+    return len;
+}
+
+
+unsigned int    BorDebugUnmangleNames(BorDebugCookie registerCookie)
+{
+    BdFile    * f            = bdNamesFile(registerCookie);
+    int         showTroubled = getenv("SHOW_TROUBLED_NAME") != 0;
+
+    try
+    {
+        std::vector<uint32_t>   todo;
+
+        for (uint32_t first = 0; first < f->nameCount; first += BD_UM_BATCH)
+        {
+            uint32_t    last = f->nameCount - first < (uint32_t)BD_UM_BATCH ? f->nameCount : first + BD_UM_BATCH;
+
+            todo.clear();
+
+            {
+                std::lock_guard<std::mutex> hold(f->umLock);
+
+                if  (!bdUnmangledTable(f, showTroubled))
+                    break;
+
+                for (uint32_t i = first; i < last; i++)
+                {
+                    if  (!f->umNames[i])
+                        todo.push_back(i);
+                }
+            }
+
+            if  (!todo.empty() && !bdUnmangleBatch(f, todo, showTroubled))
+                break;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+    }
+
+    std::lock_guard<std::mutex> hold(f->umLock);
+
+    return f->umCount;
+}
+
+
+void    BorDebugNameIndexToName(BorDebugCookie registerCookie,
+                                unsigned int   name,
+                                char         * buf,
+                                unsigned int   bufLen)
+{
+    const char  * text;
+    uint32_t      len;
+
+    if  (!bdNameSpan(bdNamesFile(registerCookie), name, &text, &len))
+        bdCopyString("", 0, buf, bufLen);
+    else
+        bdCopyString(text, len, buf, bufLen);
+}
+
+
+unsigned int    BorDebugNameIndexToNameView(BorDebugCookie    registerCookie,
+                                            unsigned int      name,
+                                            const char     ** text)
+{
+    const char  * found;
+    uint32_t      len;
+
+    if  (!bdNameSpan(bdNamesFile(registerCookie), name, &found, &len))
+    {
+        found = "";
+        len   = 0;
+    }
+
+    if  (text)
+        *text = found;
+
+    return len;
+}
+
+
+unsigned int    BorDebugNameIndexesToNames(BorDebugCookie         registerCookie,
+                                           const unsigned int   * names,
+                                           unsigned int           count,
+                                           char                 * buf,
+                                           unsigned int           bufLen,
+                                           unsigned int         * starts)
+{
+    BdFile            * f    = bdNamesFile(registerCookie);
+    unsigned int        done = 0;
+    unsigned int        used = 0;
+
+    if  (!names || !buf || !starts)
+        return 0;
+
+    // with the text in memory there is nothing to read
+    if  (f->nameText || f->image)
+    {
+        for (; done < count; done++)
+        {
+            const char  * text = "";
+            uint32_t      len  = 0;
+
+            bdNameSpan(f, names[done], &text, &len);
+
+            if  (len >= bufLen - used)
+                break;
+
+            memcpy(buf + used, text, len);
+            buf[used + len] = 0;
+            starts[done]    = used;
+            used           += len + 1;
+        }
+
+        return done;
+    }
+
+    try
+    {
+        std::vector<BdBatchName>    want;
+        std::vector<uint32_t>       offsets;
+        std::vector<uint32_t>       lens;
+        std::string                 text;
+        uint64_t                    room = 0;
+        unsigned int                take = 0;
+
+        // only the names that can fit are read: with its zero, a name
+        // takes no more than its span less the length byte, and one
+        // that doesn't exist takes 1; the first one over is taken too,
+        // as its span may be more than it needs
+        for (; take < count && room < bufLen; take++)
+        {
+            BdBatchName     n;
+
+            if  (bdNameRange(f, names[take], &n.first, &n.span))
+            {
+                n.slot = take;
+                want.push_back(n);
+                room += n.span > 1 ? n.span - 1 : 1;
+            }
+            else
+                room += 1;
+        }
+
+        offsets.resize(take, 0);
+        lens.resize(take, 0);
+
+        std::sort(want.begin(), want.end(), [](const BdBatchName & a, const BdBatchName & b)
+        {
+            return a.first < b.first;
+        });
+
+        bdReadNames(f, want, text, offsets, lens);
+
+        for (; done < take; done++)
+        {
+            uint32_t    len = lens[done];
+
+            if  (len >= bufLen - used)
+                break;
+
+            memcpy(buf + used, text.data() + offsets[done], len);
+            buf[used + len] = 0;
+            starts[done]    = used;
+            used           += len + 1;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        return 0;
+    }
+
+    return done;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Memory budget and usage
+*/
+
+void    BorDebugSetMemoryBudget(BorDebugCookie registerCookie, unsigned long long bytes)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    f->budget = bytes;
+    bdDropPages(f);
+
+    // a shared copy stays for the other registrations
+    if  (bytes && f->nameText && f->namesSize > bytes)
+    {
+        f->nameText = 0;
+        BdVector<char>(f->indexArena).swap(f->nameCache);
+
+        // the full offsets only paid off next to the copy, see
+        // bdBuildNames; a shared index stays as the others use it
+        if  (!(f->options & (BORDEBUG_REGISTER_INDEXCACHE | BORDEBUG_REGISTER_SHAREDINDEX)))
+            bdCompactNames(f);
+    }
+
+    // the unmangled names go first, then the copy of sstNames
+    std::lock_guard<std::mutex> hold(f->umLock);
+
+    if  (!bdUnmangledFit(f, 0))
+        bdDropUnmangled(f);
+}
+
+
+void    BorDebugGetMemoryUsage(BorDebugCookie registerCookie, BorDebugMemoryUsage * usage)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (!usage)
+        return;
+
+    usage->budget            = f->budget;
+    usage->arena             = bdArenaSize(f->arena);
+    usage->directory         = f->subSections.capacity() * sizeof(BdSubSection);
+    usage->typeIndex         = f->typeOffsets.capacity() * sizeof(uint32_t);
+    usage->nameIndex         = (f->nameOffsets.capacity() + f->nameCompactData.capacity()) * sizeof(uint32_t);
+    usage->indexCache        = f->cacheMapSize;
+    usage->readWindow        = f->window.capacity();
+    usage->nameText          = f->nameCache.capacity() + f->pageText.capacity() +
+                               f->pageSlots.capacity() * sizeof(BdNameSlot) +
+                               f->pageMap.capacity() * sizeof(int32_t);
+    usage->nameTextHits      = f->pageHits;
+    usage->nameTextMisses    = f->pageMisses;
+    usage->nameTextEvictions = f->pageEvictions;
+    usage->shared            = bdSharedSize(f);
+
+    std::lock_guard<std::mutex> hold(f->umLock);
+
+    usage->unmangled         = bdUnmangledSize(f);
+    usage->unmangledNames    = f->umCount;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Register indices as used by the 32 bit Intel code generators
+*/
+
+static const char * bdRegisterName(unsigned int reg)
+{
+    static const char * const regs[] =
+    {
+        "",                                                     //   0
+        "AL", "CL", "DL", "BL", "AH", "CH", "DH", "BH",         //   1
+        "AX", "CX", "DX", "BX", "SP", "BP", "SI", "DI",         //   9
+        "EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI", //  17
+        "ES", "CS", "SS", "DS", "FS", "GS",                     //  25
+        "IP", "FLAGS", "EIP", "EFLAGS",                         //  31
+    };
+
+    static const char * const fpu[] =
+    {
+        "ST(0)", "ST(1)", "ST(2)", "ST(3)",                     // 128
+        "ST(4)", "ST(5)", "ST(6)", "ST(7)",
+        "CTRL", "STAT", "TAG", "FPIP", "FPCS", "FPDO", "FPDS",  // 136
+        "ISEM", "FPEIP", "FPEDO",                               // 143
+    };
+
+    static const char * const control[] =
+    {
+        "CR0", "CR1", "CR2", "CR3",                             //  80
+        "", "", "", "", "", "",
+        "DR0", "DR1", "DR2", "DR3", "DR4", "DR5", "DR6", "DR7", //  90
+    };
+
+    if  (reg < sizeof(regs) / sizeof(regs[0]))
+        return regs[reg];
+
+    if  (reg >= 80 && reg - 80 < sizeof(control) / sizeof(control[0]))
+        return control[reg - 80];
+
+    if  (reg >= 128 && reg - 128 < sizeof(fpu) / sizeof(fpu[0]))
+        return fpu[reg - 128];
+
+    return "";
+}
+
+
+void    BorDebugRegIndexToName(BorDebugCookie registerCookie,
+                               unsigned int   reg,
+                               char         * buf,
+                               unsigned int   bufLen)
+{
+    const char  * name = bdRegisterName(reg);
+
+    (void)registerCookie;
+    bdCopyString(name, (uint32_t)strlen(name), buf, bufLen);
+}
@@ -0,0 +1,243 @@
+//---------------------------------------------------------------------
+
+/*
+    Worker pool for the parallel parts of the library
+
+    The workers are started the first time there is parallel work,
+    and are never stopped, except by BorDebugSetThreadCount.  A thread
+    waiting in bdParallelFor works on its own loop too, so nested
+    parallel loops always make progress.
+
+    Each worker belongs to a generation of the pool.
+    BorDebugSetThreadCount starts a new generation, and the workers
+    of older generations finish the queued jobs and leave.  Work that
+    comes in meanwhile starts workers of the new generation, so a
+    resize never leaves the pool without workers.
+*/
+
+//---------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+namespace
+{
+
+
+struct BdPool
+{
+    std::mutex                          lock;
+    std::condition_variable             wake;
+    std::deque<std::function<void()>>   jobs;
+    std::vector<std::thread>            workers;
+    unsigned int                        threads;    // 0: one per CPU
+    unsigned int                        generation;
+};
+
+
+/*
+    The pool is never destroyed: worker threads may still be waiting
+    in it when the process exits.
+*/
+
+BdPool &    bdPool()
+{
+    static BdPool   * pool = new BdPool();
+
+    return *pool;
+}
+
+
+unsigned int    bdWantedThreads(const BdPool & pool)
+{
+    unsigned int    threads = pool.threads;
+
+    if  (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    return threads ? threads : 1;
+}
+
+
+void    bdWorker(BdPool * pool, unsigned int generation)
+{
+    std::unique_lock<std::mutex>    hold(pool->lock);
+
+    while (true)
+    {
+        pool->wake.wait(hold, [pool, generation]
+        {
+            return pool->generation != generation || !pool->jobs.empty();
+        });
+
+        if  (pool->jobs.empty())
+            return;
+
+        std::function<void()>   job = std::move(pool->jobs.front());
+
+        pool->jobs.pop_front();
+        hold.unlock();
+        job();
+        hold.lock();
+    }
+}
+
+
+/*
+    Start workers up to the wanted count, less the calling thread.
+    If a thread can't be started, run with the ones there are.
+*/
+
+void    bdStartWorkers(BdPool & pool)
+{
+    size_t  wanted = bdWantedThreads(pool) - 1;
+
+    try
+    {
+        while (pool.workers.size() < wanted)
+            pool.workers.emplace_back(bdWorker, &pool, pool.generation);
+    }
+    catch (const std::system_error &)
+    {
+    }
+}
+
+
+struct BdBatch
+{
+    std::atomic<size_t>         next;
+    size_t                      done;
+    std::mutex                  lock;
+    std::condition_variable     finished;
+};
+
+
+}   // namespace
+
+
+//---------------------------------------------------------------------
+
+unsigned int    bdThreadCount()
+{
+    BdPool                      & pool = bdPool();
+    std::lock_guard<std::mutex>   hold(pool.lock);
+
+    return bdWantedThreads(pool);
+}
+
+
+void    bdParallelFor(size_t count, const std::function<void(size_t)> & fn)
+{
+    BdPool  & pool    = bdPool();
+    size_t    helpers = 0;
+
+    if  (count > 1)
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        bdStartWorkers(pool);
+        helpers = pool.workers.size() < count - 1 ? pool.workers.size() : count - 1;
+    }
+
+    if  (helpers == 0)
+    {
+        for (size_t i = 0; i < count; i++)
+            fn(i);
+
+        return;
+    }
+
+    std::shared_ptr<BdBatch>    batch = std::make_shared<BdBatch>();
+
+    batch->next = 0;
+    batch->done = 0;
+
+    // A helper that starts after all items are taken never touches
+    // fn, which may be gone by then.
+    std::function<void()>   run = [batch, &fn, count]
+    {
+        size_t  i;
+
+        while ((i = batch->next++) < count)
+        {
+            fn(i);
+
+            std::lock_guard<std::mutex> hold(batch->lock);
+
+            if  (++batch->done == count)
+                batch->finished.notify_all();
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        for (size_t i = 0; i < helpers; i++)
+            pool.jobs.push_back(run);
+    }
+
+    pool.wake.notify_all();
+    run();
+
+    std::unique_lock<std::mutex>    hold(batch->lock);
+
+    batch->finished.wait(hold, [&batch, count] { return batch->done == count; });
+}
+
+
+bool    bdRunAsync(const std::function<void()> & job)
+{
+    BdPool  & pool = bdPool();
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        bdStartWorkers(pool);
+
+        if  (pool.workers.empty())
+            return false;
+
+        pool.jobs.push_back(job);
+    }
+
+    pool.wake.notify_one();
+    return true;
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugSetThreadCount(unsigned int threads)
+{
+    BdPool                      & pool = bdPool();
+    std::vector<std::thread>      old;
+
+    {
+        std::lock_guard<std::mutex> hold(pool.lock);
+
+        pool.generation++;
+        pool.threads = threads;
+        old.swap(pool.workers);
+    }
+
+    pool.wake.notify_all();
+
+    for (size_t i = 0; i < old.size(); i++)
+        old[i].join();
+}
+
+
+unsigned int    BorDebugThreadCount(void)
+{
+    return bdThreadCount();
+}
@@ -0,0 +1,750 @@
+#ifndef BDPRIV_H
+#define BDPRIV_H
+
+//---------------------------------------------------------------------
+
+/*
+    Private declarations shared by the native implementation of the
+    bordebug.h API's.  Nothing in here is part of the public API.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// the library is built with -fvisibility=hidden; only the API's
+// declared in bordebug.h are exported
+#pragma GCC visibility push(default)
+#include "bordebug.h"
+#pragma GCC visibility pop
+
+
+//---------------------------------------------------------------------
+
+/*
+
+    Layout of the debug info as read by this implementation
+
+    All values are little endian.  "lfaBase" is the file offset of
+    the debug signature: 0 for a .tds file, and for an .exe or .dll
+    the trailer at the end of the file holds the distance from the
+    end of the file back to lfaBase.
+
+    Debug header at lfaBase, and trailer at end of .exe / .dll:
+
+        DWORD   signature       'FB09', 'FB0A'
+        DWORD   lfoDir          header: offset of the directory
+                                trailer: distance back to lfaBase
+
+    Subsection directory header at lfaBase + lfoDir:
+
+        WORD    cbDirHeader     size of this header
+        WORD    cbDirEntry      size of each entry
+        DWORD   cDir            number of entries
+        DWORD   lfoNextDir      offset of the next directory, or 0
+        DWORD   flags
+
+    Subsection directory entry:
+
+        WORD    subsection      BORDEBUG_SSTXXXX
+        WORD    iMod            module index
+        DWORD   lfo             offset from lfaBase
+        DWORD   cb              size in bytes
+
+    Symbol records in sstAlignSym (after a DWORD signature) and
+    in sstGlobalSym / sstGlobalPub (after the header described at
+    BorDebugGlobalSym):
+
+        WORD    reclen          length of the record, excluding reclen
+        WORD    rectyp          BORDEBUG_S_XXXX
+        ...                     data, see bdsym.cpp
+
+    sstGlobalTypes:
+
+        DWORD   signature
+        DWORD   cTypes
+        DWORD   offType[cTypes] offset of each type from the end
+                                of the offType table
+        ...     type records:
+        WORD    len             length of the record, excluding len
+        WORD    leaf            BORDEBUG_LF_XXXX
+        ...                     data, see bdtype.cpp
+
+    sstNames:
+
+        DWORD   cNames
+        ...     cNames times: BYTE len, len chars, BYTE 0
+
+*/
+
+//---------------------------------------------------------------------
+
+
+enum
+{
+    BD_SIGNATURE_FB09   = 0x39304246,
+    BD_SIGNATURE_FB0A   = 0x41304246,
+
+    BD_FAIL_NONE        = 0,
+    BD_FAIL_EXTENSION   = 1,
+    BD_FAIL_OPEN        = 2,
+    BD_FAIL_NODEBUG     = 3,
+    BD_FAIL_READ        = 4,
+    BD_FAIL_MEMORY      = 5,
+};
+
+
+//---------------------------------------------------------------------
+
+/*
+    Per cookie arena, bdarena.cpp
+*/
+
+struct BdArena;
+
+// A new arena, throws std::bad_alloc
+BdArena *   bdArenaCreate();
+
+// Allocate and free in an arena, or on the heap when arena is NULL.
+// bdArenaAlloc throws std::bad_alloc.
+void *  bdArenaAlloc(BdArena * arena, size_t size);
+void    bdArenaFree(BdArena * arena, void * block, size_t size);
+
+// Give back all memory of the arena at once
+void    bdArenaRelease(BdArena * arena);
+
+// Bytes the arena has taken from the allocator
+uint64_t    bdArenaSize(BdArena * arena);
+
+
+template <typename T>
+struct BdAlloc
+{
+    typedef T               value_type;
+    typedef std::true_type  propagate_on_container_copy_assignment;
+    typedef std::true_type  propagate_on_container_move_assignment;
+    typedef std::true_type  propagate_on_container_swap;
+
+    BdArena *   arena;
+
+    BdAlloc(BdArena * a = 0) : arena(a) {}
+
+    template <typename U>
+    BdAlloc(const BdAlloc<U> & other) : arena(other.arena) {}
+
+    T *     allocate(size_t n)
+    {
+        if  (n > SIZE_MAX / sizeof(T))
+            throw std::bad_alloc();
+
+        return static_cast<T *>(bdArenaAlloc(arena, n * sizeof(T)));
+    }
+
+    void    deallocate(T * p, size_t n)
+    {
+        bdArenaFree(arena, p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const BdAlloc<T> & a, const BdAlloc<U> & b)
+{
+    return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const BdAlloc<T> & a, const BdAlloc<U> & b)
+{
+    return a.arena != b.arena;
+}
+
+
+// A vector in an arena
+template <typename T>
+using BdVector = std::vector<T, BdAlloc<T>>;
+
+
+//---------------------------------------------------------------------
+
+/*
+    One entry of the subsection directory, with the offset already
+    converted to a file offset.
+*/
+
+struct BdSubSection
+{
+    uint32_t    type;
+    uint32_t    module;
+    uint64_t    offset;
+    uint32_t    size;
+};
+
+
+struct BdFile;
+struct BdShared;
+
+
+/*
+    A background build of the indexes, see BORDEBUG_REGISTER_ASYNC.
+    The job holds lock while it works, and does nothing once the
+    file is unregistered and f is cleared.
+*/
+
+struct BdAsync
+{
+    std::mutex  lock;
+    BdFile *    f;
+};
+
+
+/*
+    Reads done ahead of the parsers, see bdload.cpp.  A range with
+    "done" set holds "len" bytes of the file at "offset", unless the
+    read failed.
+*/
+
+struct BdPrefetchRange
+{
+    uint64_t                            offset;
+    uint64_t                            len;
+    std::unique_ptr<unsigned char[]>    data;
+    bool                                done;
+    bool                                failed;
+};
+
+
+struct BdPrefetch
+{
+    std::vector<BdPrefetchRange>    ranges;
+    bool                            missed;         // a read wasn't there yet
+    bool                            readThrough;    // read it right away instead
+};
+
+
+// A slot of the sstNames page cache, see bdname.cpp
+struct BdNameSlot
+{
+    int32_t     page;                   // -1 when empty
+    int32_t     prev;                   // LRU list, -1 at the ends
+    int32_t     next;
+    uint32_t    len;
+};
+
+
+// A block of unmangled names, see bdname.cpp
+struct BdUmBlock
+{
+    char *      text;
+    uint32_t    size;
+};
+
+
+/*
+    The registered file, the BorDebugCookie points to one of these.
+*/
+
+struct BdFile
+{
+    BdArena *                   arena;              // all of the memory below
+    BdArena *                   indexArena;         // arena, or the one of shared
+
+    // indexes shared with other registrations of the file, see
+    // bdshare.cpp; before the members in its arena, so it goes
+    // after them
+    std::shared_ptr<BdShared>   shared;
+
+    int                         fd;
+    uint64_t                    fileSize;
+    uint64_t                    base;
+    uint32_t                    signature;
+    unsigned int                options;            // BORDEBUG_REGISTER_XXXX
+    std::string                 path;               // empty for an image
+
+    // the whole file when it is in memory, mapSize is non-zero
+    // when image is our own mapping
+    const unsigned char *       image;
+    size_t                      mapSize;
+
+    // BorDebugRegisterIO, read through io when io.read is set
+    BorDebugIO                  io;
+    void *                      ioContext;
+
+    // BorDebugLoadFiles, only while it registers the file
+    BdPrefetch *                prefetch;
+
+    uint64_t                    dirOffset;
+    BdVector<BdSubSection>      subSections;
+
+    // sstGlobalTypes, built on first use, see bdTypesFile
+    std::atomic<bool>           typesLoaded;
+    std::once_flag              typesOnce;
+    uint64_t                    typesOffset;
+    uint64_t                    typesData;
+    uint32_t                    typesSize;
+    uint32_t                    typesSignature;
+    uint32_t                    typeCount;
+    const uint32_t *            typeIndex;          // typeOffsets, or the index cache
+    BdVector<uint32_t>          typeOffsets;
+
+    // sstNames, built on first use, see bdNamesFile
+    std::atomic<bool>           namesLoaded;
+    std::once_flag              namesOnce;
+    uint64_t                    namesOffset;
+    uint32_t                    namesSize;
+    uint32_t                    nameCount;
+    const uint32_t *            nameIndex;          // nameOffsets, or the index cache, or NULL
+    BdVector<uint32_t>          nameOffsets;
+    const uint32_t *            nameCompact;        // instead of nameIndex, see bdname.cpp
+    uint32_t                    nameLongCount;
+    BdVector<uint32_t>          nameCompactData;
+    BdVector<char>              nameCache;
+    const char *                nameText;           // nameCache, or shared, or NULL
+
+    // BorDebugReregisterFile: the previous build, only while the
+    // indexes are built during registration, see bdreindex.cpp
+    BdFile *                    previous;
+    uint32_t                    namesReused;
+
+    // ceiling for the derived caches, 0 for none, see
+    // BorDebugSetMemoryBudget
+    std::atomic<uint64_t>       budget;
+
+    // sstNames text in pages under a budget, see bdname.cpp
+    bool                        pagesReady;
+    BdVector<char>              pageText;
+    BdVector<BdNameSlot>        pageSlots;
+    BdVector<int32_t>           pageMap;            // page -> slot, or -1
+    int32_t                     lruFirst;           // most recently used
+    int32_t                     lruLast;            // least recently used
+    uint64_t                    pageHits;
+    uint64_t                    pageMisses;
+    uint64_t                    pageEvictions;
+
+    // unmangled names, each made once, under umLock, see bdname.cpp
+    std::mutex                  umLock;
+    BdVector<const char *>      umNames;            // name -> text, or NULL
+    BdVector<BdUmBlock>         umBlocks;
+    uint32_t                    umUsed;             // of the last block
+    uint64_t                    umSize;             // of all blocks
+    uint32_t                    umCount;            // names kept
+    int                         umTroubled;         // SHOW_TROUBLED_NAME they were made with
+
+    // the mapped index cache, see bdcache.cpp
+    std::once_flag              cacheOnce;
+    bool                        cacheUsed;
+    void *                      cacheMap;
+    size_t                      cacheMapSize;
+
+    std::shared_ptr<BdAsync>    async;
+
+    // read window for small reads
+    BdVector<unsigned char>     window;
+    uint64_t                    windowStart;
+    uint32_t                    windowLen;
+
+    // BorDebugStartSymbols / BorDebugNextSymbol
+    uint64_t                    symPos;
+    uint64_t                    symEnd;
+
+    // BorDebugTypeStartFIELDLIST / BorDebugTypeNextFIELDLIST
+    uint64_t                    fieldPos;
+    uint64_t                    fieldEnd;
+};
+
+
+// A new BdFile in its own arena, throws std::bad_alloc.
+BdFile *    bdNewFile();
+void        bdFreeFile(BdFile * f);
+
+
+inline BdFile * bdFile(BorDebugCookie registerCookie)
+{
+    return static_cast<BdFile *>(registerCookie);
+}
+
+
+// Build the sstGlobalTypes or sstNames index when it is first
+// needed.  If that fails the index stays empty.  When another thread
+// is building the index, wait for it.
+void    bdLoadTypesOnce(BdFile * f);
+void    bdLoadNamesOnce(BdFile * f);
+
+
+// bdFile, for the API's that need the type index
+inline BdFile * bdTypesFile(BorDebugCookie registerCookie)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (!f->typesLoaded)
+        bdLoadTypesOnce(f);
+
+    return f;
+}
+
+
+// bdFile, for the API's that need the name index
+inline BdFile * bdNamesFile(BorDebugCookie registerCookie)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (!f->namesLoaded)
+        bdLoadNamesOnce(f);
+
+    return f;
+}
+
+
+// Append the offsets of the names that start in [pos, stop) of the
+// "size" bytes of sstNames at "text", up to "count" in all, and
+// return where the next name starts.  Does nothing, and returns
+// pos, unless the names are many enough to scan in parts on the
+// worker pool, see bdname.cpp.  Throws std::bad_alloc.
+uint32_t    bdScanNames(const unsigned char * text,
+                        uint32_t              size,
+                        uint32_t              pos,
+                        uint32_t              stop,
+                        uint32_t              count,
+                        BdVector<uint32_t>  & offsets);
+
+
+// The name index takes 4 bytes a name, unless it is made compact,
+// see bdname.cpp.  bdCompactNames replaces nameOffsets by the
+// compact index, or leaves it when short of memory.  bdNameOffsets
+// writes out all nameCount offsets.
+void        bdCompactNames(BdFile * f);
+uint32_t    bdCompactOffset(const BdFile * f, uint32_t i);
+void        bdNameOffsets(const BdFile * f, uint32_t * offsets);
+
+
+// Offset of the 0-based name i in sstNames
+inline uint32_t bdNameOffset(const BdFile * f, uint32_t i)
+{
+    return f->nameIndex ? f->nameIndex[i] : bdCompactOffset(f, i);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    File access, bdfile.cpp
+*/
+
+// Read exactly "len" bytes at "offset", returns false on a short read
+bool    bdReadAt(BdFile * f, uint64_t offset, void * buf, size_t len);
+
+// Pointer to "len" bytes at "offset", valid until the next call.
+// Never fails: data that can't be read comes back as zeros.
+const unsigned char *   bdPeek(BdFile * f, uint64_t offset, uint32_t len);
+
+// The first subsection of a type, NULL if there is none
+const BdSubSection *    bdFindSubSection(BdFile * f, uint32_t type);
+
+// Time stamp of each sstModule, in directory order
+void    bdModuleTimeStamps(BdFile * f, std::vector<uint32_t> & stamps);
+
+// Build the type and name indexes from the file, returns BD_FAIL_XXXX.
+// An index that fails is left empty.
+unsigned int    bdBuildIndexes(BdFile * f);
+
+// The steps of a registration by name, returning BD_FAIL_XXXX.
+// bdOpenFile sets "file" to a new BdFile with the file open, only
+// when it succeeds.  bdReadHeaders reads the debug header and the
+// subsection directory, bdRegisterIndexes does the rest for
+// f->options, see bdRegister.
+unsigned int    bdOpenFile(const char    * fileName,
+                           BdFile       ** file,
+                           bool          * isTds,
+                           std::string   * identity);
+unsigned int    bdReadHeaders(BdFile * f, bool isTds);
+unsigned int    bdRegisterIndexes(BdFile * f, const std::string & identity);
+
+
+inline unsigned int bdGet16(const unsigned char * p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+inline unsigned int bdGet32(const unsigned char * p)
+{
+    return (unsigned int)p[0]         | ((unsigned int)p[1] << 8) |
+           ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+inline uint64_t bdGet64(const unsigned char * p)
+{
+    return (uint64_t)bdGet32(p) | ((uint64_t)bdGet32(p + 4) << 32);
+}
+
+inline void bdPut(unsigned int * p, unsigned int value)
+{
+    if  (p)
+        *p = value;
+}
+
+inline void bdPut(unsigned long long * p, uint64_t value)
+{
+    if  (p)
+        *p = value;
+}
+
+
+/*
+    Sequential reader over a record in the file.  Reads past "end"
+    return zeros, so malformed records never read outside of the
+    record they belong to.
+*/
+
+struct BdCursor
+{
+    BdFile *    f;
+    uint64_t    pos;
+    uint64_t    end;
+
+    bool            has(uint32_t n) const   { return pos + n <= end; }
+    void            skip(uint32_t n)        { pos += n; }
+
+    unsigned int    u8();
+    unsigned int    u16();
+    unsigned int    u32();
+    uint64_t        u64();
+    uint64_t        numeric();
+    void            skipNumeric();
+    unsigned int    bytes(void * dest, uint32_t n);
+};
+
+
+//---------------------------------------------------------------------
+
+/*
+    Index cache, bdcache.cpp
+*/
+
+// With BORDEBUG_REGISTER_INDEXCACHE, load both indexes from the index
+// cache, or build both and write the cache.  Only the first call does
+// the work, and sets result to BD_FAIL_XXXX.  Returns false when the
+// cache isn't used for this file, each index is then built by itself.
+bool    bdUseIndexCache(BdFile * f, unsigned int * result);
+
+
+//---------------------------------------------------------------------
+
+/*
+    Indexes shared between registrations of one file, bdshare.cpp
+
+    The fields are copies of the BdFile fields of the same name, as
+    built by the first registration that needed the index.  Each is
+    written once, under typesOnce or namesOnce, and only read after.
+*/
+
+struct BdMapping
+{
+    void *                      map;
+    size_t                      size;
+};
+
+
+struct BdShared
+{
+    BdArena *                   arena;              // all of the memory below
+    std::string                 key;
+    bool                        listed;             // in the list of shared files
+    std::mutex                  lock;               // maps
+    BdVector<BdMapping>         maps;               // index caches of the builders
+
+    std::once_flag              typesOnce;
+    unsigned int                typesResult;        // BD_FAIL_XXXX
+    uint64_t                    typesOffset;
+    uint64_t                    typesData;
+    uint32_t                    typesSize;
+    uint32_t                    typesSignature;
+    uint32_t                    typeCount;
+    const uint32_t *            typeIndex;
+    BdVector<uint32_t>          typeOffsets;
+
+    std::once_flag              namesOnce;
+    unsigned int                namesResult;
+    uint64_t                    namesOffset;
+    uint32_t                    namesSize;
+    uint32_t                    nameCount;
+    const uint32_t *            nameIndex;
+    BdVector<uint32_t>          nameOffsets;
+    const uint32_t *            nameCompact;
+    uint32_t                    nameLongCount;
+    BdVector<uint32_t>          nameCompactData;
+    BdVector<char>              nameCache;
+    const char *                nameText;
+};
+
+
+// Share the indexes of f with other registrations of the same
+// "identity" and options.  Throws std::bad_alloc.
+void    bdShareIndexes(BdFile * f, const std::string & identity);
+
+// Hand the type or name index f has just built over to f->shared
+void    bdPublishTypes(BdFile * f, unsigned int result);
+void    bdPublishNames(BdFile * f, unsigned int result);
+
+// Use the type or name index of f->shared
+void    bdAdoptTypes(BdFile * f);
+void    bdAdoptNames(BdFile * f);
+
+// Bytes taken by the shared indexes of f, 0 when there are none
+uint64_t    bdSharedSize(BdFile * f);
+
+
+//---------------------------------------------------------------------
+
+/*
+    Name index entries taken from the previous build, bdreindex.cpp
+
+    bdLoadNames calls bdReuseHead before it scans sstNames, and goes
+    on from pos.  Once it gets to tail, it calls bdReuseTail for each
+    name until that returns true.  Without a copy of the text, only
+    the part that changed is read, into text, from base up to end;
+    bdReuseText gives it at the section offsets the scan uses.
+*/
+
+struct BdReuse
+{
+    uint32_t                            pos;        // where to go on scanning
+    uint32_t                            tail;       // start of the same end part
+    int64_t                             delta;      // size of the new minus the old
+    uint32_t                            reused;     // entries taken
+    uint64_t                            offset;     // of the new sstNames in the file
+    uint32_t                            base;       // text read from here
+    uint32_t                            end;        // text read up to here
+    std::unique_ptr<unsigned char[]>    text;       // when none was passed in
+    const uint32_t *                    oldIndex;   // name offsets of f->previous
+    std::vector<uint32_t>               oldOffsets; // when it has a compact index
+};
+
+
+// Take the entries of the part that starts the same as in
+// f->previous.  "text" is all of the new sstNames at "offset", or
+// NULL to read what is needed.  "count" is the number of names it
+// declares.  Returns false when the file can't be read.  Throws
+// std::bad_alloc.
+bool    bdReuseHead(BdFile              * f,
+                    uint64_t              offset,
+                    const unsigned char * text,
+                    uint32_t              size,
+                    uint32_t              count,
+                    BdReuse             & r);
+
+// At "pos" in the end part: when that is where a previous name
+// started, take the entries from there on but the last, set pos to
+// the last one and return true.
+bool    bdReuseTail(BdFile * f, uint32_t count, BdReuse & r, uint32_t & pos);
+
+// Read the rest of the text, from "pos" or where it was read up to,
+// and drop what is before pos.  Returns false when the file can't be
+// read.  Throws std::bad_alloc.
+bool    bdReuseRest(BdFile * f, uint32_t size, uint32_t pos, BdReuse & r);
+
+// The text that was read, indexed by offsets in sstNames; only
+// [base, end) may be looked at
+inline const unsigned char * bdReuseText(const BdReuse & r)
+{
+    return r.text.get() - r.base;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Reading many files at once, bdload.cpp
+*/
+
+// bdReadAt from f->prefetch.  Returns false when it isn't there; a
+// read that wasn't asked for yet is then added, unless readThrough
+// is set.
+bool    bdPrefetchRead(BdFile * f, uint64_t offset, void * buf, size_t len);
+
+// Pointer to "len" bytes at "offset" in f->prefetch, or NULL
+const unsigned char *   bdPrefetchData(BdFile * f, uint64_t offset, size_t len);
+
+
+//---------------------------------------------------------------------
+
+/*
+    File watcher, bdwatch.cpp
+*/
+
+// "fileName" with its directory made absolute and canonical, the way
+// the watcher reports it, or empty if the directory doesn't exist
+std::string bdWatchPath(const char * fileName);
+
+// Watch a path from bdWatchPath for being rewritten or replaced.
+// Returns false when it can't be watched.  Each bdWatchAdd that
+// succeeded needs a bdWatchRemove.
+bool    bdWatchAdd(const std::string & path);
+void    bdWatchRemove(const std::string & path);
+
+// Called on the watcher thread for a watched path that changed,
+// bdfiles.cpp
+void    bdPoolFileChanged(const std::string & path);
+
+
+//---------------------------------------------------------------------
+
+/*
+    Numeric leaves, bdtype.cpp
+*/
+
+// Size in bytes of the value following a numeric leaf, 0 if unknown
+uint32_t    bdNumericSize(unsigned int leaf);
+
+
+//---------------------------------------------------------------------
+
+/*
+    Worker pool, bdpool.cpp
+*/
+
+// Number of threads that work on one parallel loop, at least 1
+unsigned int    bdThreadCount();
+
+// Call fn(0) ... fn(count - 1), spread over the worker pool and the
+// calling thread, and wait for all of them.  fn must not throw.
+void    bdParallelFor(size_t count, const std::function<void(size_t)> & fn);
+
+// Run job on a worker thread and return at once.  Returns false,
+// without running job, when there are no worker threads.
+bool    bdRunAsync(const std::function<void()> & job);
+
+
+//---------------------------------------------------------------------
+
+/*
+    Unmangler, bdum.cpp
+*/
+
+BorDebugUmKind  bdUnmangle(const char * src,
+                           char       * dest,
+                           unsigned     maxlen,
+                           char       * qualP,
+                           char       * baseP,
+                           int          doArgs,
+                           int          showTroubled);
+
+// The whole unmangled name in "out", or src itself when it isn't
+// mangled.  Returns the kind, as bdUnmangle.  Throws std::bad_alloc.
+unsigned int    bdUnmangleString(const char   * src,
+                                 int            doArgs,
+                                 int            showTroubled,
+                                 std::string  & out);
+
+
+//---------------------------------------------------------------------
+
+#endif  // BDPRIV_H
@@ -0,0 +1,278 @@
+//---------------------------------------------------------------------
+
+/*
+    Name index of a rebuilt file, see BorDebugReregisterFile
+
+    When one module of a program changes and the program is linked
+    again, most of sstNames stays as it was: the names in front of
+    the first change are where they were, the names after the last
+    change are where they were, moved by the change in size.  The
+    index entries of both parts are taken from the previous build,
+    and only the names in between are scanned.  What is the same is
+    found by comparing the text, not taken from the time stamps.
+
+    The scan decides where a name ends by looking at the byte after
+    its length byte, up to 256 bytes on, and before that at nothing
+    outside the name.  So an entry of the first part is only taken
+    when those bytes are in the part that is the same, and for the
+    end part the bytes from the name to the end of the section are.
+*/
+
+//---------------------------------------------------------------------
+
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_REUSE_CHUNK  = 0x10000,
+    BD_REUSE_REACH  = 0x100,            // bytes the scan looks ahead
+};
+
+
+// "len" bytes of the previous sstNames at "offset", NULL if they
+// can't be read
+static const unsigned char *    bdOldText(BdFile                       * old,
+                                          uint32_t                       offset,
+                                          uint32_t                       len,
+                                          std::vector<unsigned char>   & buf)
+{
+    if  (old->nameText)
+        return reinterpret_cast<const unsigned char *>(old->nameText) + offset;
+
+    if  (old->image)
+        return old->image + old->namesOffset + offset;
+
+    buf.resize(len);
+
+    if  (!bdReadAt(old, old->namesOffset + offset, &buf[0], len))
+        return 0;
+
+    return &buf[0];
+}
+
+
+// The same for the new sstNames, "text" when there is one
+static const unsigned char *    bdNewText(BdFile                       * f,
+                                          const BdReuse                & r,
+                                          const unsigned char          * text,
+                                          uint32_t                       offset,
+                                          uint32_t                       len,
+                                          std::vector<unsigned char>   & buf)
+{
+    if  (text)
+        return text + offset;
+
+    buf.resize(len);
+
+    if  (!bdReadAt(f, r.offset + offset, &buf[0], len))
+        return 0;
+
+    return &buf[0];
+}
+
+
+// Length of the same part at the start, after the count of names
+static uint32_t bdSameHead(BdFile * f, const BdReuse & r, const unsigned char * text, uint32_t size)
+{
+    BdFile                    * old   = f->previous;
+    uint32_t                    limit = std::min(size, old->namesSize);
+    uint32_t                    pos   = 4;
+    std::vector<unsigned char>  oldBuf;
+    std::vector<unsigned char>  newBuf;
+
+    while (pos < limit)
+    {
+        uint32_t                len = std::min(limit - pos, (uint32_t)BD_REUSE_CHUNK);
+        const unsigned char   * o   = bdOldText(old, pos, len, oldBuf);
+        const unsigned char   * n   = bdNewText(f, r, text, pos, len, newBuf);
+
+        if  (!o || !n)
+            break;
+
+        if  (memcmp(o, n, len) != 0)
+        {
+            while (*o++ == *n++)
+                pos++;
+
+            break;
+        }
+
+        pos += len;
+    }
+
+    return pos;
+}
+
+
+// Length of the same part at the end
+static uint32_t bdSameTail(BdFile * f, const BdReuse & r, const unsigned char * text, uint32_t size)
+{
+    BdFile                    * old   = f->previous;
+    uint32_t                    limit = std::min(size, old->namesSize) - 4;
+    uint32_t                    same  = 0;
+    std::vector<unsigned char>  oldBuf;
+    std::vector<unsigned char>  newBuf;
+
+    while (same < limit)
+    {
+        uint32_t                len = std::min(limit - same, (uint32_t)BD_REUSE_CHUNK);
+        const unsigned char   * o   = bdOldText(old, old->namesSize - same - len, len, oldBuf);
+        const unsigned char   * n   = bdNewText(f, r, text, size - same - len, len, newBuf);
+
+        if  (!o || !n)
+            break;
+
+        if  (memcmp(o, n, len) != 0)
+        {
+            while (o[len - 1] == n[len - 1])
+            {
+                len--;
+                same++;
+            }
+
+            break;
+        }
+
+        same += len;
+    }
+
+    return same;
+}
+
+
+//---------------------------------------------------------------------
+
+bool    bdReuseHead(BdFile              * f,
+                    uint64_t              offset,
+                    const unsigned char * text,
+                    uint32_t              size,
+                    uint32_t              count,
+                    BdReuse             & r)
+{
+    BdFile  * old = f->previous;
+
+    r.pos      = 4;
+    r.tail     = UINT32_MAX;
+    r.delta    = 0;
+    r.reused   = 0;
+    r.offset   = offset;
+    r.base     = 0;
+    r.end      = size;
+    r.oldIndex = 0;
+
+    if  (old && old->nameCount >= 2 && old->namesSize >= 4)
+    {
+        // a compact index is written out for the searches below
+        if  (!old->nameIndex)
+        {
+            r.oldOffsets.resize(old->nameCount);
+            bdNameOffsets(old, r.oldOffsets.data());
+        }
+
+        r.oldIndex = old->nameIndex ? old->nameIndex : r.oldOffsets.data();
+
+        const uint32_t  * first = r.oldIndex;
+        const uint32_t  * last  = r.oldIndex + old->nameCount;
+        uint32_t          head  = bdSameHead(f, r, text, size);
+
+        // entry k can be taken when the next one, where scanning goes
+        // on, and all the bytes the scan looks at for entry k are the
+        // same
+        if  (head >= 4 + BD_REUSE_REACH)
+        {
+            uint32_t    next = (uint32_t)(std::upper_bound(first, last, head - BD_REUSE_REACH) - first);
+
+            if  (next > 0)
+            {
+                next--;
+
+                uint32_t    take = std::min(next, count);
+
+                f->nameOffsets.insert(f->nameOffsets.end(), first, first + take);
+
+                r.pos    = first[next];
+                r.reused = take;
+            }
+        }
+
+        uint32_t    tail = bdSameTail(f, r, text, size);
+
+        if  (tail)
+        {
+            r.tail  = size - tail;
+            r.delta = (int64_t)size - old->namesSize;
+        }
+    }
+
+    if  (text)
+        return true;
+
+    // the names up to the end part, and some of it to find a name
+    // that starts where one did before
+    if  (r.tail != UINT32_MAX)
+        r.end = (uint32_t)std::min((uint64_t)size, (uint64_t)std::max(r.pos, r.tail) + BD_REUSE_CHUNK);
+
+    // scanning only goes on from pos, so nothing before it is needed
+    r.base = std::min(r.pos, r.end);
+    r.text.reset(new unsigned char[r.end - r.base]);
+
+    return r.pos >= r.end || bdReadAt(f, offset + r.pos, r.text.get(), r.end - r.pos);
+}
+
+
+bool    bdReuseTail(BdFile * f, uint32_t count, BdReuse & r, uint32_t & pos)
+{
+    BdFile    * old    = f->previous;
+    int64_t     oldPos = (int64_t)pos - r.delta;
+
+    if  (oldPos < 4 || oldPos >= old->namesSize)
+        return false;
+
+    const uint32_t  * first = r.oldIndex;
+    const uint32_t  * last  = r.oldIndex + old->nameCount;
+    const uint32_t  * found = std::lower_bound(first, last, (uint32_t)oldPos);
+
+    // the last name is scanned again, to find out where it ends
+    if  (found == last || *found != (uint32_t)oldPos || found + 1 == last)
+        return false;
+
+    uint32_t    have = (uint32_t)f->nameOffsets.size();
+    uint32_t    take = std::min((uint32_t)(last - 1 - found), count - have);
+
+    f->nameOffsets.resize(have + take);
+
+    for (uint32_t i = 0; i < take; i++)
+        f->nameOffsets[have + i] = (uint32_t)(found[i] + r.delta);
+
+    pos       = (uint32_t)(found[take] + r.delta);
+    r.tail    = UINT32_MAX;
+    r.reused += take;
+
+    return true;
+}
+
+
+bool    bdReuseRest(BdFile * f, uint32_t size, uint32_t pos, BdReuse & r)
+{
+    // the text before pos isn't looked at again
+    uint32_t                            base = std::max(r.base, pos);
+    uint32_t                            from = std::max(base, r.end);
+    std::unique_ptr<unsigned char[]>    text(new unsigned char[size - base]);
+
+    if  (base < r.end)
+        memcpy(text.get(), r.text.get() + (base - r.base), r.end - base);
+
+    if  (from < size && !bdReadAt(f, r.offset + from, text.get() + (from - base), size - from))
+        return false;
+
+    r.text.swap(text);
+    r.base = base;
+    r.end  = size;
+    return true;
+}
@@ -0,0 +1,251 @@
+//---------------------------------------------------------------------
+
+/*
+    Indexes shared between registrations of the same file
+
+    Every registration gets a cookie of its own, with its own read
+    window and iterators, but the type index, the name index and the
+    copy of sstNames only depend on the file and the options.  All
+    registrations of a file with the same options share a BdShared in
+    an arena of its own: the first one that needs an index builds it
+    in that arena and hands it over, the others copy the pointers.
+    The BdShared goes away with the last registration that uses it.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <sys/mman.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "bdpriv.h"
+
+
+struct BdSharedFiles
+{
+    std::mutex                                                  lock;
+    std::unordered_map<std::string, std::weak_ptr<BdShared>>    files;
+};
+
+
+// Never destroyed, like the file pool: the watcher thread may still
+// register and unregister files while the process exits.
+static BdSharedFiles &  bdSharedFiles()
+{
+    static BdSharedFiles    * shared = new BdSharedFiles();
+
+    return *shared;
+}
+
+
+static void bdFreeShared(BdShared * s)
+{
+    if  (s->listed)
+    {
+        BdSharedFiles             & list = bdSharedFiles();
+        std::lock_guard<std::mutex> hold(list.lock);
+
+        // a new registration may have taken the key in the meantime
+        auto    found = list.files.find(s->key);
+
+        if  (found != list.files.end() && found->second.expired())
+            list.files.erase(found);
+    }
+
+    for (size_t i = 0; i < s->maps.size(); i++)
+        munmap(s->maps[i].map, s->maps[i].size);
+
+    BdArena * arena = s->arena;
+
+    s->~BdShared();
+    bdArenaRelease(arena);
+}
+
+
+static std::shared_ptr<BdShared>    bdNewShared(const std::string & key)
+{
+    BdArena   * arena = bdArenaCreate();
+    BdShared  * s;
+
+    try
+    {
+        s = new (bdArenaAlloc(arena, sizeof(BdShared))) BdShared();
+    }
+    catch (const std::bad_alloc &)
+    {
+        bdArenaRelease(arena);
+        throw;
+    }
+
+    s->arena       = arena;
+    s->maps        = BdVector<BdMapping>(arena);
+    s->typeOffsets = BdVector<uint32_t>(arena);
+    s->nameOffsets     = BdVector<uint32_t>(arena);
+    s->nameCompactData = BdVector<uint32_t>(arena);
+    s->nameCache       = BdVector<char>(arena);
+
+    // one index cache per index at most, so publishing never allocates
+    try
+    {
+        s->key = key;
+        s->maps.reserve(2);
+    }
+    catch (const std::bad_alloc &)
+    {
+        bdFreeShared(s);
+        throw;
+    }
+
+    // frees s when it throws
+    return std::shared_ptr<BdShared>(s, bdFreeShared);
+}
+
+
+// The index cache f mapped now belongs to s, the index f built may
+// point into it.  The caller holds s->lock.
+static void bdTakeMap(BdShared * s, BdFile * f)
+{
+    if  (!f->cacheMapSize)
+        return;
+
+    BdMapping   mapping = { f->cacheMap, f->cacheMapSize };
+
+    s->maps.push_back(mapping);
+
+    f->cacheMap     = 0;
+    f->cacheMapSize = 0;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Options that don't change what ends up in the indexes don't stop
+    registrations from sharing them.
+*/
+
+void    bdShareIndexes(BdFile * f, const std::string & identity)
+{
+    char    options[16];
+
+    snprintf(options, sizeof(options), "%08x:",
+             f->options & ~(unsigned int)(BORDEBUG_REGISTER_EAGER | BORDEBUG_REGISTER_ASYNC));
+
+    std::string                 key = options + identity;
+    std::shared_ptr<BdShared>   s;
+
+    {
+        BdSharedFiles             & list = bdSharedFiles();
+        std::lock_guard<std::mutex> hold(list.lock);
+
+        std::weak_ptr<BdShared>   & slot = list.files[key];
+
+        s = slot.lock();
+
+        if  (!s)
+        {
+            s         = bdNewShared(key);
+            slot      = s;
+            s->listed = true;
+        }
+    }
+
+    f->shared      = s;
+    f->indexArena  = s->arena;
+    f->typeOffsets = BdVector<uint32_t>(s->arena);
+    f->nameOffsets     = BdVector<uint32_t>(s->arena);
+    f->nameCompactData = BdVector<uint32_t>(s->arena);
+    f->nameCache       = BdVector<char>(s->arena);
+}
+
+
+void    bdPublishTypes(BdFile * f, unsigned int result)
+{
+    BdShared                  * s = f->shared.get();
+    std::lock_guard<std::mutex> hold(s->lock);
+
+    bdTakeMap(s, f);
+
+    s->typesResult    = result;
+    s->typesOffset    = f->typesOffset;
+    s->typesData      = f->typesData;
+    s->typesSize      = f->typesSize;
+    s->typesSignature = f->typesSignature;
+    s->typeCount      = f->typeCount;
+    s->typeIndex      = f->typeIndex;
+
+    s->typeOffsets.swap(f->typeOffsets);
+}
+
+
+void    bdPublishNames(BdFile * f, unsigned int result)
+{
+    BdShared                  * s = f->shared.get();
+    std::lock_guard<std::mutex> hold(s->lock);
+
+    bdTakeMap(s, f);
+
+    s->namesResult   = result;
+    s->namesOffset   = f->namesOffset;
+    s->namesSize     = f->namesSize;
+    s->nameCount     = f->nameCount;
+    s->nameIndex     = f->nameIndex;
+    s->nameCompact   = f->nameCompact;
+    s->nameLongCount = f->nameLongCount;
+    s->nameText      = f->nameText;
+
+    s->nameOffsets.swap(f->nameOffsets);
+    s->nameCompactData.swap(f->nameCompactData);
+    s->nameCache.swap(f->nameCache);
+}
+
+
+void    bdAdoptTypes(BdFile * f)
+{
+    const BdShared  * s = f->shared.get();
+
+    f->typesOffset    = s->typesOffset;
+    f->typesData      = s->typesData;
+    f->typesSize      = s->typesSize;
+    f->typesSignature = s->typesSignature;
+    f->typeCount      = s->typeCount;
+    f->typeIndex      = s->typeIndex;
+}
+
+
+void    bdAdoptNames(BdFile * f)
+{
+    const BdShared  * s = f->shared.get();
+
+    f->namesOffset   = s->namesOffset;
+    f->namesSize     = s->namesSize;
+    f->nameCount     = s->nameCount;
+    f->nameIndex     = s->nameIndex;
+    f->nameCompact   = s->nameCompact;
+    f->nameLongCount = s->nameLongCount;
+
+    // this registration's budget may be smaller than the builder's
+    if  (!f->budget || s->namesSize <= f->budget)
+        f->nameText = s->nameText;
+    else
+        f->nameText = 0;
+}
+
+
+uint64_t    bdSharedSize(BdFile * f)
+{
+    if  (!f->shared)
+        return 0;
+
+    BdShared                  * s = f->shared.get();
+    std::lock_guard<std::mutex> hold(s->lock);
+    uint64_t                    size = bdArenaSize(s->arena);
+
+    for (size_t i = 0; i < s->maps.size(); i++)
+        size += s->maps[i].size;
+
+    return size;
+}
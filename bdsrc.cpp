@@ -0,0 +1,295 @@
+//---------------------------------------------------------------------
+
+/*
+    sstSrcModule API's
+
+    All offsets inside the subsection are relative to the start of
+    the subsection.
+
+    Module header:
+
+        WORD    cFile
+        WORD    cSeg
+        DWORD   baseSrcFile[cFile]      offsets of the source file entries
+        DWORD   start[cSeg], end[cSeg]  pairs, code ranges
+        WORD    seg[cSeg]               segments of the code ranges
+
+    Source file entry:
+
+        WORD    cSeg
+        DWORD   name                    name index of the source file
+        DWORD   baseSrcLn[cSeg]         offsets of the line number tables
+        DWORD   start[cSeg], end[cSeg]  pairs, code ranges
+
+    Line number table:
+
+        WORD    seg
+        WORD    cPair
+        DWORD   offset[cPair]
+        WORD    line[cPair]
+*/
+
+//---------------------------------------------------------------------
+
+#include <vector>
+
+#include "bdpriv.h"
+
+
+static BdCursor bdSrcCursor(BorDebugCookie registerCookie, uint64_t offset)
+{
+    BdFile    * f = bdFile(registerCookie);
+    BdCursor    c = { f, offset, f->fileSize };
+
+    return c;
+}
+
+
+/*
+    File offset of the source file entry "source"
+*/
+
+static uint64_t bdSrcFile(BorDebugCookie registerCookie,
+                          uint64_t       offset,
+                          unsigned int   source)
+{
+    BdCursor    c = bdSrcCursor(registerCookie, offset + 4 + (uint64_t)source * 4);
+
+    return offset + c.u32();
+}
+
+
+/*
+    File offset of the line number table for "range" of "source"
+*/
+
+static uint64_t bdSrcLines(BorDebugCookie registerCookie,
+                           uint64_t       offset,
+                           unsigned int   source,
+                           unsigned int   range)
+{
+    BdCursor    c = bdSrcCursor(registerCookie, bdSrcFile(registerCookie, offset, source));
+
+    c.skip(6 + range * 4);
+    return offset + c.u32();
+}
+
+
+void    BorDebugSrcModule_64(BorDebugCookie       registerCookie,
+                             unsigned long long   offset,
+                             unsigned int       * rangeCount,
+                             unsigned int       * sourceCount)
+{
+    BdCursor    c = bdSrcCursor(registerCookie, offset);
+
+    bdPut(sourceCount, c.u16());
+    bdPut(rangeCount, c.u16());
+}
+
+
+void    BorDebugSrcModuleRanges_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   offset,
+                                   unsigned int       * segments,
+                                   unsigned int       * segmentStarts,
+                                   unsigned int       * segmentEnds)
+{
+    BdCursor        c     = bdSrcCursor(registerCookie, offset);
+    unsigned int    files = c.u16();
+    unsigned int    segs  = c.u16();
+
+    c.skip(files * 4);
+
+    for (unsigned int i = 0; i < segs; i++)
+    {
+        unsigned int    start = c.u32();
+        unsigned int    end   = c.u32();
+
+        if  (segmentStarts)
+            segmentStarts[i] = start;
+
+        if  (segmentEnds)
+            segmentEnds[i] = end;
+    }
+
+    for (unsigned int i = 0; i < segs; i++)
+    {
+        unsigned int    seg = c.u16();
+
+        if  (segments)
+            segments[i] = seg;
+    }
+}
+
+
+void    BorDebugSrcModuleSources_64(BorDebugCookie       registerCookie,
+                                    unsigned long long   offset,
+                                    unsigned long long * sourceOffsets,
+                                    unsigned int       * names,
+                                    unsigned int       * rangeCounts)
+{
+    BdCursor        c     = bdSrcCursor(registerCookie, offset);
+    unsigned int    files = c.u16();
+
+    c.skip(2);
+
+    for (unsigned int i = 0; i < files; i++)
+    {
+        uint64_t        entry = offset + c.u32();
+        BdCursor        e     = bdSrcCursor(registerCookie, entry);
+        unsigned int    segs  = e.u16();
+
+        if  (sourceOffsets)
+            sourceOffsets[i] = entry;
+
+        if  (rangeCounts)
+            rangeCounts[i] = segs;
+
+        if  (names)
+            names[i] = e.u32();
+    }
+}
+
+
+void    BorDebugSrcModuleSourceRanges_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   offset,
+                                         unsigned int         source,
+                                         unsigned int       * segments,
+                                         unsigned int       * segmentStarts,
+                                         unsigned int       * segmentEnds,
+                                         unsigned int       * lineNumberCounts)
+{
+    BdCursor        c    = bdSrcCursor(registerCookie, bdSrcFile(registerCookie, offset, source));
+    unsigned int    segs = c.u16();
+
+    c.skip(4);
+
+    for (unsigned int i = 0; i < segs; i++)
+    {
+        BdCursor        lines = bdSrcCursor(registerCookie, offset + c.u32());
+        unsigned int    seg   = lines.u16();
+        unsigned int    pairs = lines.u16();
+
+        if  (segments)
+            segments[i] = seg;
+
+        if  (lineNumberCounts)
+            lineNumberCounts[i] = pairs;
+    }
+
+    for (unsigned int i = 0; i < segs; i++)
+    {
+        unsigned int    start = c.u32();
+        unsigned int    end   = c.u32();
+
+        if  (segmentStarts)
+            segmentStarts[i] = start;
+
+        if  (segmentEnds)
+            segmentEnds[i] = end;
+    }
+}
+
+
+void    BorDebugSrcModuleLineNumbers_64(BorDebugCookie       registerCookie,
+                                        unsigned long long   offset,
+                                        unsigned int         source,
+                                        unsigned int         range,
+                                        unsigned int       * lineNumber,
+                                        unsigned int       * lineOffset)
+{
+    uint64_t        table = bdSrcLines(registerCookie, offset, source, range);
+    BdCursor        c     = bdSrcCursor(registerCookie, table);
+
+    c.skip(2);
+
+    unsigned int    pairs = c.u16();
+
+    for (unsigned int i = 0; i < pairs; i++)
+    {
+        unsigned int    value = c.u32();
+
+        if  (lineOffset)
+            lineOffset[i] = value;
+    }
+
+    for (unsigned int i = 0; i < pairs; i++)
+    {
+        unsigned int    value = c.u16();
+
+        if  (lineNumber)
+            lineNumber[i] = value;
+    }
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    32 bit offset versions of the API's above
+*/
+
+void    BorDebugSrcModule(BorDebugCookie registerCookie,
+                          unsigned int   offset,
+                          unsigned int * rangeCount,
+                          unsigned int * sourceCount)
+{
+    BorDebugSrcModule_64(registerCookie, offset, rangeCount, sourceCount);
+}
+
+
+void    BorDebugSrcModuleRanges(BorDebugCookie registerCookie,
+                                unsigned int   offset,
+                                unsigned int * segments,
+                                unsigned int * segmentStarts,
+                                unsigned int * segmentEnds)
+{
+    BorDebugSrcModuleRanges_64(registerCookie, offset, segments, segmentStarts,
+                               segmentEnds);
+}
+
+
+void    BorDebugSrcModuleSources(BorDebugCookie registerCookie,
+                                 unsigned int   offset,
+                                 unsigned int * sourceOffsets,
+                                 unsigned int * names,
+                                 unsigned int * rangeCounts)
+{
+    unsigned int    sources = 0;
+
+    BorDebugSrcModule_64(registerCookie, offset, 0, &sources);
+
+    std::vector<unsigned long long> offsets(sources + 1);
+
+    BorDebugSrcModuleSources_64(registerCookie, offset,
+                                sourceOffsets ? &offsets[0] : 0, names,
+                                rangeCounts);
+
+    for (unsigned int i = 0; i < sources && sourceOffsets; i++)
+        sourceOffsets[i] = (unsigned int)offsets[i];
+}
+
+
+void    BorDebugSrcModuleSourceRanges(BorDebugCookie registerCookie,
+                                      unsigned int   offset,
+                                      unsigned int   source,
+                                      unsigned int * segments,
+                                      unsigned int * segmentStarts,
+                                      unsigned int * segmentEnds,
+                                      unsigned int * lineNumberCounts)
+{
+    BorDebugSrcModuleSourceRanges_64(registerCookie, offset, source, segments,
+                                     segmentStarts, segmentEnds,
+                                     lineNumberCounts);
+}
+
+
+void    BorDebugSrcModuleLineNumbers(BorDebugCookie registerCookie,
+                                     unsigned int   offset,
+                                     unsigned int   source,
+                                     unsigned int   range,
+                                     unsigned int * lineNumber,
+                                     unsigned int * lineOffset)
+{
+    BorDebugSrcModuleLineNumbers_64(registerCookie, offset, source, range,
+                                    lineNumber, lineOffset);
+}
@@ -0,0 +1,1258 @@
+//---------------------------------------------------------------------
+
+/*
+    Symbol API's for sstAlignSym, sstGlobalSym, and sstGlobalPub
+
+    Each symbol starts with WORD reclen and WORD rectyp, and symOffset
+    always points at reclen.  The layout of the data following the
+    rectyp is listed with each API below.  "name" fields are name
+    indices, "type" fields are type indices.
+*/
+
+//---------------------------------------------------------------------
+
+#include <string.h>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_ALIGNSYM_HEADER  = 4,
+    BD_GLOBALSYM_HEADER = 36,
+};
+
+
+/*
+    Cursor over the data of the symbol at symOffset
+*/
+
+static BdCursor bdSymbol(BorDebugCookie registerCookie, uint64_t symOffset)
+{
+    BdFile    * f = bdFile(registerCookie);
+    BdCursor    c = { f, symOffset, symOffset + 2 };
+
+    c.end += c.u16();
+    c.skip(2);
+    return c;
+}
+
+
+/*
+    Copy a length prefixed string into a zero terminated buffer,
+    returns the full length of the string.
+*/
+
+static unsigned int bdLengthString(BdCursor & c, char * dest, unsigned int maxCount)
+{
+    unsigned int    len = c.u8();
+    char            text[256];
+    unsigned int    got = c.bytes(text, len);
+
+    if  (dest && maxCount)
+    {
+        unsigned int    n = got < maxCount - 1 ? got : maxCount - 1;
+
+        memcpy(dest, text, n);
+        dest[n] = 0;
+    }
+
+    return len;
+}
+
+
+/*
+    Fill in an array of DWORD name indices preceded by a WORD count,
+    returns the count.
+*/
+
+static unsigned int bdNameList(BdCursor & c, unsigned int maxCount, unsigned int * indices)
+{
+    unsigned int    count = c.u16();
+
+    for (unsigned int i = 0; i < count && i < maxCount && indices; i++)
+        indices[i] = c.u32();
+
+    return count;
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugStartSymbols_64(BorDebugCookie       registerCookie,
+                                unsigned int         subSectionType,
+                                unsigned long long   offset,
+                                unsigned int         size)
+{
+    BdFile    * f   = bdFile(registerCookie);
+    uint64_t    end = offset + size;
+
+    switch (subSectionType)
+    {
+        case BORDEBUG_SSTALIGNSYM:
+            f->symPos = offset + BD_ALIGNSYM_HEADER;
+            f->symEnd = end;
+            break;
+
+        case BORDEBUG_SSTGLOBALSYM:
+        case BORDEBUG_SSTGLOBALPUB:
+        {
+            uint64_t    symbols = bdGet32(bdPeek(f, offset + 8, 4));
+
+            f->symPos = offset + BD_GLOBALSYM_HEADER;
+            f->symEnd = f->symPos + symbols < end ? f->symPos + symbols : end;
+            break;
+        }
+
+        default:
+            f->symPos = 0;
+            f->symEnd = 0;
+            break;
+    }
+}
+
+
+void    BorDebugNextSymbol_64(BorDebugCookie       registerCookie,
+                              unsigned int       * kind,
+                              unsigned long long * symOffset,
+                              unsigned int       * symLen)
+{
+    BdFile  * f = bdFile(registerCookie);
+
+    if  (f->symPos + 4 <= f->symEnd)
+    {
+        const unsigned char * p      = bdPeek(f, f->symPos, 4);
+        unsigned int          reclen = bdGet16(p);
+
+        if  (reclen >= 2 && f->symPos + 2 + reclen <= f->symEnd)
+        {
+            bdPut(kind, bdGet16(p + 2));
+            bdPut(symOffset, f->symPos);
+            bdPut(symLen, reclen + 2);
+
+            f->symPos += 2 + reclen;
+            return;
+        }
+    }
+
+    f->symPos = f->symEnd;
+
+    bdPut(kind, 0);
+    bdPut(symOffset, 0);
+    bdPut(symLen, 0);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    BYTE machine, BYTE language, WORD flags, BYTE flags (bits 16-23),
+    length prefixed compiler name
+*/
+
+void    BorDebugSymbolCOMPILE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * machine,
+                                 unsigned int       * language,
+                                 unsigned int       * flags,
+                                 char               * compilerName,
+                                 unsigned int         maxNameCount)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(machine, c.u8());
+    bdPut(language, c.u8());
+
+    unsigned int    low = c.u16();
+
+    bdPut(flags, low | (c.u8() << 16));
+    bdLengthString(c, compilerName, maxNameCount);
+}
+
+
+/*
+    DWORD type, WORD reg, DWORD name, DWORD browser
+*/
+
+void    BorDebugSymbolREGISTER_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * reg,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(reg, c.u16());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+/*
+    DWORD type, DWORD name, DWORD browser, numeric leaf value
+*/
+
+void    BorDebugSymbolCONST_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * browserOffset,
+                               unsigned int       * value)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+    bdPut(value, (unsigned int)c.numeric());
+}
+
+
+/*
+    DWORD type, WORD properties, DWORD name, DWORD browser
+*/
+
+void    BorDebugSymbolUDT_64(BorDebugCookie       registerCookie,
+                             unsigned long long   symOffset,
+                             unsigned int       * typeIndex,
+                             unsigned int       * properties,
+                             unsigned int       * name,
+                             unsigned int       * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(properties, c.u16());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+/*
+    DWORD firstProcOffset, WORD firstProcSegment, WORD codeSymCount,
+    WORD dataSymCount, DWORD firstData
+*/
+
+void    BorDebugSymbolSSEARCH_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * firstProcSegment,
+                                 unsigned int       * firstProcOffset,
+                                 unsigned int       * codeSymCount,
+                                 unsigned int       * dataSymCount,
+                                 unsigned int       * firstData)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(firstProcOffset, c.u32());
+    bdPut(firstProcSegment, c.u16());
+    bdPut(codeSymCount, c.u16());
+    bdPut(dataSymCount, c.u16());
+    bdPut(firstData, c.u32());
+}
+
+
+/*
+    DWORD signature, DWORD name
+*/
+
+void    BorDebugSymbolOBJNAME_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * signature,
+                                 unsigned int       * name)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(signature, c.u32());
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD refSym (offset from lfaBase), DWORD type, DWORD name,
+    DWORD browser, DWORD offset, WORD segment
+*/
+
+static void bdSymbolREF(BorDebugCookie       registerCookie,
+                        uint64_t             symOffset,
+                        unsigned long long * refSymOffset,
+                        unsigned int       * typeIndex,
+                        unsigned int       * name,
+                        unsigned int       * browserOffset,
+                        unsigned int       * segment,
+                        unsigned int       * offset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(refSymOffset, bdFile(registerCookie)->base + c.u32());
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+}
+
+
+void    BorDebugSymbolGPROCREF_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned long long * refSymOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset,
+                                  unsigned int       * codeSegment,
+                                  unsigned int       * codeOffset)
+{
+    bdSymbolREF(registerCookie, symOffset, refSymOffset, typeIndex, name,
+                browserOffset, codeSegment, codeOffset);
+}
+
+
+void    BorDebugSymbolGDATAREF_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned long long * refSymOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset,
+                                  unsigned int       * dataSegment,
+                                  unsigned int       * dataOffset)
+{
+    bdSymbolREF(registerCookie, symOffset, refSymOffset, typeIndex, name,
+                browserOffset, dataSegment, dataOffset);
+}
+
+
+/*
+    DWORD type, DWORD name, DWORD externIndex, WORD flags, DWORD browser
+*/
+
+static void bdSymbolEXTERN(BorDebugCookie registerCookie,
+                           uint64_t       symOffset,
+                           unsigned int * typeIndex,
+                           unsigned int * name,
+                           unsigned int * externIndex,
+                           unsigned int * flags,
+                           unsigned int * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(externIndex, c.u32());
+    bdPut(flags, c.u16());
+    bdPut(browserOffset, c.u32());
+}
+
+
+void    BorDebugSymbolEDATA_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * externIndex,
+                               unsigned int       * flags,
+                               unsigned int       * browserOffset)
+{
+    bdSymbolEXTERN(registerCookie, symOffset, typeIndex, name,
+                   externIndex, flags, browserOffset);
+}
+
+
+void    BorDebugSymbolEPROC_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * externIndex,
+                               unsigned int       * flags,
+                               unsigned int       * browserOffset)
+{
+    bdSymbolEXTERN(registerCookie, symOffset, typeIndex, name,
+                   externIndex, flags, browserOffset);
+}
+
+
+/*
+    WORD count, DWORD name[count]
+*/
+
+unsigned int    BorDebugSymbolUSES_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   symOffset,
+                                      unsigned int         nameCount,
+                                      unsigned int       * nameIndices)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    return bdNameList(c, nameCount, nameIndices);
+}
+
+
+/*
+    DWORD name, DWORD browser, WORD count, DWORD using[count]
+*/
+
+unsigned int    BorDebugSymbolNAMESPACE_64(BorDebugCookie       registerCookie,
+                                           unsigned long long   symOffset,
+                                           unsigned int         usingCount,
+                                           unsigned int       * name,
+                                           unsigned int       * browserOffset,
+                                           unsigned int       * usingIndices)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+
+    return bdNameList(c, usingCount, usingIndices);
+}
+
+
+/*
+    WORD count, DWORD name[count]
+*/
+
+unsigned int    BorDebugSymbolUSING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   symOffset,
+                                       unsigned int         nameCount,
+                                       unsigned int       * nameIndices)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    return bdNameList(c, nameCount, nameIndices);
+}
+
+
+/*
+    DWORD type, DWORD name, WORD properties, DWORD browser,
+    WORD valueLen, BYTE value[valueLen]
+*/
+
+unsigned int    BorDebugSymbolPCONSTANT_64(BorDebugCookie       registerCookie,
+                                           unsigned long long   symOffset,
+                                           unsigned int       * typeIndex,
+                                           unsigned int       * name,
+                                           unsigned int       * properties,
+                                           unsigned int       * browserOffset,
+                                           unsigned int         valueMaxLen,
+                                           unsigned char      * value)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(properties, c.u16());
+    bdPut(browserOffset, c.u32());
+
+    unsigned int    len = c.u16();
+
+    if  (value && valueMaxLen)
+    {
+        unsigned int    got = c.bytes(value, len < valueMaxLen ? len : valueMaxLen);
+
+        if  (got < valueMaxLen)
+            value[got] = 0;
+    }
+
+    return len;
+}
+
+
+/*
+    DWORD offset, DWORD type, DWORD name, DWORD browser
+*/
+
+void    BorDebugSymbolBPREL32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(offset, c.u32());
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+/*
+    DWORD offset, WORD segment, WORD flags, DWORD type, DWORD name,
+    DWORD browser
+*/
+
+static void bdSymbolDATA(BorDebugCookie registerCookie,
+                         uint64_t       symOffset,
+                         unsigned int * offset,
+                         unsigned int * segment,
+                         unsigned int * flags,
+                         unsigned int * typeIndex,
+                         unsigned int * name,
+                         unsigned int * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    bdPut(flags, c.u16());
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+void    BorDebugSymbolLDATA32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset)
+{
+    bdSymbolDATA(registerCookie, symOffset, offset, segment, flags,
+                 typeIndex, name, browserOffset);
+}
+
+
+void    BorDebugSymbolGDATA32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset)
+{
+    bdSymbolDATA(registerCookie, symOffset, offset, segment, flags,
+                 typeIndex, name, browserOffset);
+}
+
+
+void    BorDebugSymbolPUB32_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * offset,
+                               unsigned int       * segment,
+                               unsigned int       * flags,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * browserOffset)
+{
+    bdSymbolDATA(registerCookie, symOffset, offset, segment, flags,
+                 typeIndex, name, browserOffset);
+}
+
+
+/*
+    DWORD parent, DWORD end, DWORD next, DWORD codeLength,
+    DWORD debugStart, DWORD debugEnd, DWORD offset, WORD segment,
+    WORD flags, DWORD type, DWORD name, DWORD browser
+
+    S_GPROC32 optionally follows this with a length prefixed link name.
+*/
+
+static BdCursor bdSymbolPROC(BorDebugCookie registerCookie,
+                             uint64_t       symOffset,
+                             unsigned int * parent,
+                             unsigned int * end,
+                             unsigned int * next,
+                             unsigned int * codeLength,
+                             unsigned int * debugStart,
+                             unsigned int * debugEnd,
+                             unsigned int * offset,
+                             unsigned int * segment,
+                             unsigned int * flags,
+                             unsigned int * typeIndex,
+                             unsigned int * name,
+                             unsigned int * browserOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(parent, c.u32());
+    bdPut(end, c.u32());
+    bdPut(next, c.u32());
+    bdPut(codeLength, c.u32());
+    bdPut(debugStart, c.u32());
+    bdPut(debugEnd, c.u32());
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    bdPut(flags, c.u16());
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+
+    return c;
+}
+
+
+void    BorDebugSymbolLPROC32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * next,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * debugStart,
+                                 unsigned int       * debugEnd,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset)
+{
+    bdSymbolPROC(registerCookie, symOffset, parent, end, next, codeLength,
+                 debugStart, debugEnd, offset, segment, flags, typeIndex,
+                 name, browserOffset);
+}
+
+
+/*
+    Returns the full length of the link name, 0 if there is none
+*/
+
+unsigned int    BorDebugSymbolGPROC32_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   symOffset,
+                                         unsigned int       * parent,
+                                         unsigned int       * end,
+                                         unsigned int       * next,
+                                         unsigned int       * codeLength,
+                                         unsigned int       * debugStart,
+                                         unsigned int       * debugEnd,
+                                         unsigned int       * offset,
+                                         unsigned int       * segment,
+                                         unsigned int       * flags,
+                                         unsigned int       * typeIndex,
+                                         unsigned int       * name,
+                                         unsigned int       * browserOffset,
+                                         char               * linkName,
+                                         unsigned int         maxLinkName)
+{
+    BdCursor    c = bdSymbolPROC(registerCookie, symOffset, parent, end, next,
+                                 codeLength, debugStart, debugEnd, offset,
+                                 segment, flags, typeIndex, name, browserOffset);
+
+    if  (!c.has(1))
+    {
+        if  (linkName && maxLinkName)
+            linkName[0] = 0;
+
+        return 0;
+    }
+
+    return bdLengthString(c, linkName, maxLinkName);
+}
+
+
+/*
+    DWORD parent, DWORD end, DWORD next, DWORD offset, WORD segment,
+    WORD codeLength, BYTE ordinal, BYTE pad, DWORD name, DWORD delta
+*/
+
+void    BorDebugSymbolTHUNK32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * next,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * ordinal,
+                                 unsigned int       * name,
+                                 unsigned int       * delta)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(parent, c.u32());
+    bdPut(end, c.u32());
+    bdPut(next, c.u32());
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    bdPut(codeLength, c.u16());
+    bdPut(ordinal, c.u8());
+    c.skip(1);
+    bdPut(name, c.u32());
+    bdPut(delta, c.u32());
+}
+
+
+/*
+    DWORD parent, DWORD end, DWORD codeLength, DWORD offset,
+    WORD segment, WORD pad, DWORD name
+*/
+
+void    BorDebugSymbolBLOCK32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * name)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(parent, c.u32());
+    bdPut(end, c.u32());
+    bdPut(codeLength, c.u32());
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    c.skip(2);
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD parent, DWORD end, DWORD codeLength, DWORD offset,
+    WORD segment, WORD flags, DWORD type, DWORD name, DWORD varOffset
+*/
+
+void    BorDebugSymbolWITH32_64(BorDebugCookie       registerCookie,
+                                unsigned long long   symOffset,
+                                unsigned int       * parent,
+                                unsigned int       * codeLength,
+                                unsigned int       * offset,
+                                unsigned int       * segment,
+                                unsigned int       * flags,
+                                unsigned int       * typeIndex,
+                                unsigned int       * name,
+                                unsigned int       * varOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(parent, c.u32());
+    c.skip(4);
+    bdPut(codeLength, c.u32());
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    bdPut(flags, c.u16());
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(varOffset, c.u32());
+}
+
+
+/*
+    DWORD offset, WORD segment, BYTE nearFar, BYTE pad, DWORD name
+*/
+
+void    BorDebugSymbolLABEL32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * nearFar,
+                                 unsigned int       * name)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+    bdPut(nearFar, c.u8());
+    c.skip(1);
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD offset, WORD segment
+*/
+
+void    BorDebugSymbolENTRY32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(offset, c.u32());
+    bdPut(segment, c.u16());
+}
+
+
+/*
+    WORD count, count times: DWORD start, WORD length, WORD reg
+*/
+
+unsigned int    BorDebugSymbolOPTVAR32_64(BorDebugCookie       registerCookie,
+                                          unsigned long long   symOffset,
+                                          unsigned int         maxEntries,
+                                          unsigned int       * startEntries,
+                                          unsigned int       * lengthEntries,
+                                          unsigned int       * regNameEntries)
+{
+    BdCursor        c     = bdSymbol(registerCookie, symOffset);
+    unsigned int    count = c.u16();
+
+    for (unsigned int i = 0; i < count && i < maxEntries; i++)
+    {
+        unsigned int    start  = c.u32();
+        unsigned int    length = c.u16();
+        unsigned int    reg    = c.u16();
+
+        if  (startEntries)
+            startEntries[i] = start;
+
+        if  (lengthEntries)
+            lengthEntries[i] = length;
+
+        if  (regNameEntries)
+            regNameEntries[i] = reg;
+    }
+
+    return count;
+}
+
+
+/*
+    DWORD offset, WORD length
+*/
+
+void    BorDebugSymbolPROCRET32_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   symOffset,
+                                   unsigned int       * offset,
+                                   unsigned int       * length)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(offset, c.u32());
+    bdPut(length, c.u16());
+}
+
+
+/*
+    WORD mask, DWORD offset
+*/
+
+void    BorDebugSymbolSAVREGS32_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   symOffset,
+                                   unsigned int       * mask,
+                                   unsigned int       * offset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    bdPut(mask, c.u16());
+    bdPut(offset, c.u32());
+}
+
+
+/*
+    DWORD offset
+*/
+
+unsigned int    BorDebugSymbolSLINK32_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   symOffset)
+{
+    BdCursor    c = bdSymbol(registerCookie, symOffset);
+
+    return c.u32();
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    32 bit offset versions of the API's above
+*/
+
+void    BorDebugStartSymbols(BorDebugCookie registerCookie,
+                             unsigned int   subSectionType,
+                             unsigned int   offset,
+                             unsigned int   size)
+{
+    BorDebugStartSymbols_64(registerCookie, subSectionType, offset, size);
+}
+
+
+void    BorDebugNextSymbol(BorDebugCookie registerCookie,
+                           unsigned int * kind,
+                           unsigned int * symOffset,
+                           unsigned int * symLen)
+{
+    unsigned long long  symOffset64 = 0;
+
+    BorDebugNextSymbol_64(registerCookie, kind, symOffset ? &symOffset64 : 0,
+                          symLen);
+    bdPut(symOffset, (unsigned int)symOffset64);
+}
+
+
+void    BorDebugSymbolCOMPILE(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * machine,
+                              unsigned int * language,
+                              unsigned int * flags,
+                              char         * compilerName,
+                              unsigned int   maxNameCount)
+{
+    BorDebugSymbolCOMPILE_64(registerCookie, symOffset, machine, language, flags,
+                             compilerName, maxNameCount);
+}
+
+
+void    BorDebugSymbolREGISTER(BorDebugCookie registerCookie,
+                               unsigned int   symOffset,
+                               unsigned int * typeIndex,
+                               unsigned int * reg,
+                               unsigned int * name,
+                               unsigned int * browserOffset)
+{
+    BorDebugSymbolREGISTER_64(registerCookie, symOffset, typeIndex, reg, name,
+                              browserOffset);
+}
+
+
+void    BorDebugSymbolCONST(BorDebugCookie registerCookie,
+                            unsigned int   symOffset,
+                            unsigned int * typeIndex,
+                            unsigned int * name,
+                            unsigned int * browserOffset,
+                            unsigned int * value)
+{
+    BorDebugSymbolCONST_64(registerCookie, symOffset, typeIndex, name,
+                           browserOffset, value);
+}
+
+
+void    BorDebugSymbolUDT(BorDebugCookie registerCookie,
+                          unsigned int   symOffset,
+                          unsigned int * typeIndex,
+                          unsigned int * properties,
+                          unsigned int * name,
+                          unsigned int * browserOffset)
+{
+    BorDebugSymbolUDT_64(registerCookie, symOffset, typeIndex, properties, name,
+                         browserOffset);
+}
+
+
+void    BorDebugSymbolSSEARCH(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * firstProcSegment,
+                              unsigned int * firstProcOffset,
+                              unsigned int * codeSymCount,
+                              unsigned int * dataSymCount,
+                              unsigned int * firstData)
+{
+    BorDebugSymbolSSEARCH_64(registerCookie, symOffset, firstProcSegment,
+                             firstProcOffset, codeSymCount, dataSymCount,
+                             firstData);
+}
+
+
+void    BorDebugSymbolOBJNAME(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * signature,
+                              unsigned int * name)
+{
+    BorDebugSymbolOBJNAME_64(registerCookie, symOffset, signature, name);
+}
+
+
+void    BorDebugSymbolGPROCREF(BorDebugCookie registerCookie,
+                               unsigned int   symOffset,
+                               unsigned int * refSymOffset,
+                               unsigned int * typeIndex,
+                               unsigned int * name,
+                               unsigned int * browserOffset,
+                               unsigned int * codeSegment,
+                               unsigned int * codeOffset)
+{
+    unsigned long long  refSymOffset64 = 0;
+
+    BorDebugSymbolGPROCREF_64(registerCookie, symOffset,
+                              refSymOffset ? &refSymOffset64 : 0, typeIndex, name,
+                              browserOffset, codeSegment, codeOffset);
+    bdPut(refSymOffset, (unsigned int)refSymOffset64);
+}
+
+
+void    BorDebugSymbolGDATAREF(BorDebugCookie registerCookie,
+                               unsigned int   symOffset,
+                               unsigned int * refSymOffset,
+                               unsigned int * typeIndex,
+                               unsigned int * name,
+                               unsigned int * browserOffset,
+                               unsigned int * dataSegment,
+                               unsigned int * dataOffset)
+{
+    unsigned long long  refSymOffset64 = 0;
+
+    BorDebugSymbolGDATAREF_64(registerCookie, symOffset,
+                              refSymOffset ? &refSymOffset64 : 0, typeIndex, name,
+                              browserOffset, dataSegment, dataOffset);
+    bdPut(refSymOffset, (unsigned int)refSymOffset64);
+}
+
+
+void    BorDebugSymbolEDATA(BorDebugCookie registerCookie,
+                            unsigned int   symOffset,
+                            unsigned int * typeIndex,
+                            unsigned int * name,
+                            unsigned int * externIndex,
+                            unsigned int * flags,
+                            unsigned int * browserOffset)
+{
+    BorDebugSymbolEDATA_64(registerCookie, symOffset, typeIndex, name,
+                           externIndex, flags, browserOffset);
+}
+
+
+void    BorDebugSymbolEPROC(BorDebugCookie registerCookie,
+                            unsigned int   symOffset,
+                            unsigned int * typeIndex,
+                            unsigned int * name,
+                            unsigned int * externIndex,
+                            unsigned int * flags,
+                            unsigned int * browserOffset)
+{
+    BorDebugSymbolEPROC_64(registerCookie, symOffset, typeIndex, name,
+                           externIndex, flags, browserOffset);
+}
+
+
+unsigned int    BorDebugSymbolUSES(BorDebugCookie registerCookie,
+                                   unsigned int   symOffset,
+                                   unsigned int   nameCount,
+                                   unsigned int * nameIndices)
+{
+    return BorDebugSymbolUSES_64(registerCookie, symOffset, nameCount, nameIndices);
+}
+
+
+unsigned int    BorDebugSymbolNAMESPACE(BorDebugCookie registerCookie,
+                                        unsigned int   symOffset,
+                                        unsigned int   usingCount,
+                                        unsigned int * name,
+                                        unsigned int * browserOffset,
+                                        unsigned int * usingIndices)
+{
+    return BorDebugSymbolNAMESPACE_64(registerCookie, symOffset, usingCount, name,
+                                      browserOffset, usingIndices);
+}
+
+
+unsigned int    BorDebugSymbolUSING(BorDebugCookie registerCookie,
+                                    unsigned int   symOffset,
+                                    unsigned int   nameCount,
+                                    unsigned int * nameIndices)
+{
+    return BorDebugSymbolUSING_64(registerCookie, symOffset, nameCount, nameIndices);
+}
+
+
+unsigned int    BorDebugSymbolPCONSTANT(BorDebugCookie  registerCookie,
+                                        unsigned int    symOffset,
+                                        unsigned int  * typeIndex,
+                                        unsigned int  * name,
+                                        unsigned int  * properties,
+                                        unsigned int  * browserOffset,
+                                        unsigned int    valueMaxLen,
+                                        unsigned char * value)
+{
+    return BorDebugSymbolPCONSTANT_64(registerCookie, symOffset, typeIndex, name,
+                                      properties, browserOffset, valueMaxLen,
+                                      value);
+}
+
+
+void    BorDebugSymbolBPREL32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * offset,
+                              unsigned int * typeIndex,
+                              unsigned int * name,
+                              unsigned int * browserOffset)
+{
+    BorDebugSymbolBPREL32_64(registerCookie, symOffset, offset, typeIndex, name,
+                             browserOffset);
+}
+
+
+void    BorDebugSymbolLDATA32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * flags,
+                              unsigned int * typeIndex,
+                              unsigned int * name,
+                              unsigned int * browserOffset)
+{
+    BorDebugSymbolLDATA32_64(registerCookie, symOffset, offset, segment, flags,
+                             typeIndex, name, browserOffset);
+}
+
+
+void    BorDebugSymbolGDATA32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * flags,
+                              unsigned int * typeIndex,
+                              unsigned int * name,
+                              unsigned int * browserOffset)
+{
+    BorDebugSymbolGDATA32_64(registerCookie, symOffset, offset, segment, flags,
+                             typeIndex, name, browserOffset);
+}
+
+
+void    BorDebugSymbolPUB32(BorDebugCookie registerCookie,
+                            unsigned int   symOffset,
+                            unsigned int * offset,
+                            unsigned int * segment,
+                            unsigned int * flags,
+                            unsigned int * typeIndex,
+                            unsigned int * name,
+                            unsigned int * browserOffset)
+{
+    BorDebugSymbolPUB32_64(registerCookie, symOffset, offset, segment, flags,
+                           typeIndex, name, browserOffset);
+}
+
+
+void    BorDebugSymbolLPROC32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * parent,
+                              unsigned int * end,
+                              unsigned int * next,
+                              unsigned int * codeLength,
+                              unsigned int * debugStart,
+                              unsigned int * debugEnd,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * flags,
+                              unsigned int * typeIndex,
+                              unsigned int * name,
+                              unsigned int * browserOffset)
+{
+    BorDebugSymbolLPROC32_64(registerCookie, symOffset, parent, end, next,
+                             codeLength, debugStart, debugEnd, offset, segment,
+                             flags, typeIndex, name, browserOffset);
+}
+
+
+unsigned int    BorDebugSymbolGPROC32(BorDebugCookie registerCookie,
+                                      unsigned int   symOffset,
+                                      unsigned int * parent,
+                                      unsigned int * end,
+                                      unsigned int * next,
+                                      unsigned int * codeLength,
+                                      unsigned int * debugStart,
+                                      unsigned int * debugEnd,
+                                      unsigned int * offset,
+                                      unsigned int * segment,
+                                      unsigned int * flags,
+                                      unsigned int * typeIndex,
+                                      unsigned int * name,
+                                      unsigned int * browserOffset,
+                                      char         * linkName,
+                                      unsigned int   maxLinkName)
+{
+    return BorDebugSymbolGPROC32_64(registerCookie, symOffset, parent, end, next,
+                                    codeLength, debugStart, debugEnd, offset,
+                                    segment, flags, typeIndex, name,
+                                    browserOffset, linkName, maxLinkName);
+}
+
+
+void    BorDebugSymbolTHUNK32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * parent,
+                              unsigned int * end,
+                              unsigned int * next,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * codeLength,
+                              unsigned int * ordinal,
+                              unsigned int * name,
+                              unsigned int * delta)
+{
+    BorDebugSymbolTHUNK32_64(registerCookie, symOffset, parent, end, next, offset,
+                             segment, codeLength, ordinal, name, delta);
+}
+
+
+void    BorDebugSymbolBLOCK32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * parent,
+                              unsigned int * end,
+                              unsigned int * codeLength,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * name)
+{
+    BorDebugSymbolBLOCK32_64(registerCookie, symOffset, parent, end, codeLength,
+                             offset, segment, name);
+}
+
+
+void    BorDebugSymbolWITH32(BorDebugCookie registerCookie,
+                             unsigned int   symOffset,
+                             unsigned int * parent,
+                             unsigned int * codeLength,
+                             unsigned int * offset,
+                             unsigned int * segment,
+                             unsigned int * flags,
+                             unsigned int * typeIndex,
+                             unsigned int * name,
+                             unsigned int * varOffset)
+{
+    BorDebugSymbolWITH32_64(registerCookie, symOffset, parent, codeLength, offset,
+                            segment, flags, typeIndex, name, varOffset);
+}
+
+
+void    BorDebugSymbolLABEL32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * offset,
+                              unsigned int * segment,
+                              unsigned int * nearFar,
+                              unsigned int * name)
+{
+    BorDebugSymbolLABEL32_64(registerCookie, symOffset, offset, segment, nearFar,
+                             name);
+}
+
+
+void    BorDebugSymbolENTRY32(BorDebugCookie registerCookie,
+                              unsigned int   symOffset,
+                              unsigned int * offset,
+                              unsigned int * segment)
+{
+    BorDebugSymbolENTRY32_64(registerCookie, symOffset, offset, segment);
+}
+
+
+unsigned int    BorDebugSymbolOPTVAR32(BorDebugCookie registerCookie,
+                                       unsigned int   symOffset,
+                                       unsigned int   maxEntries,
+                                       unsigned int * startEntries,
+                                       unsigned int * lengthEntries,
+                                       unsigned int * regNameEntries)
+{
+    return BorDebugSymbolOPTVAR32_64(registerCookie, symOffset, maxEntries,
+                                     startEntries, lengthEntries,
+                                     regNameEntries);
+}
+
+
+void    BorDebugSymbolPROCRET32(BorDebugCookie registerCookie,
+                                unsigned int   symOffset,
+                                unsigned int * offset,
+                                unsigned int * length)
+{
+    BorDebugSymbolPROCRET32_64(registerCookie, symOffset, offset, length);
+}
+
+
+void    BorDebugSymbolSAVREGS32(BorDebugCookie registerCookie,
+                                unsigned int   symOffset,
+                                unsigned int * mask,
+                                unsigned int * offset)
+{
+    BorDebugSymbolSAVREGS32_64(registerCookie, symOffset, mask, offset);
+}
+
+
+unsigned int    BorDebugSymbolSLINK32(BorDebugCookie registerCookie,
+                                      unsigned int   symOffset)
+{
+    return BorDebugSymbolSLINK32_64(registerCookie, symOffset);
+}
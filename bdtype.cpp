@@ -0,0 +1,1881 @@
+//---------------------------------------------------------------------
+
+/*
+    Type API's for sstGlobalTypes
+
+    Each type record starts with WORD len and WORD leaf, and typeOffset
+    always points at the leaf, so the same offsets work for the leaves
+    inside a field list, which have no length.  The layout of the data
+    following the leaf is listed with each API below.  "name" fields
+    are name indices, "type" fields are type indices, and "numeric"
+    fields are numeric leaves.
+*/
+
+//---------------------------------------------------------------------
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_TYPE_BASE        = 0x1000,
+    BD_TYPE_MAX_DEPTH   = 8,
+};
+
+
+/*
+    Cursor over the data of the leaf at typeOffset.  Leaves inside a
+    field list have no length, so this can only be bounded by the file.
+*/
+
+static BdCursor bdType(BorDebugCookie registerCookie, uint64_t typeOffset)
+{
+    BdFile    * f = bdFile(registerCookie);
+    BdCursor    c = { f, typeOffset + 2, f->fileSize };
+
+    return c;
+}
+
+
+/*
+    Cursor over the data of the type record at typeOffset, bounded
+    by the length of the record.
+*/
+
+static BdCursor bdTypeRecord(BorDebugCookie registerCookie, uint64_t typeOffset)
+{
+    BdFile    * f   = bdFile(registerCookie);
+    uint64_t    len = typeOffset >= 2 ? bdGet16(bdPeek(f, typeOffset - 2, 2)) : 0;
+    BdCursor    c   = { f, typeOffset + 2, typeOffset + len };
+
+    return c;
+}
+
+
+uint32_t    bdNumericSize(unsigned int leaf)
+{
+    switch (leaf)
+    {
+        case BORDEBUG_LF_CHAR:      return 1;
+        case BORDEBUG_LF_SHORT:     return 2;
+        case BORDEBUG_LF_USHORT:    return 2;
+        case BORDEBUG_LF_LONG:      return 4;
+        case BORDEBUG_LF_ULONG:     return 4;
+        case BORDEBUG_LF_REAL32:    return 4;
+        case BORDEBUG_LF_REAL64:    return 8;
+        case BORDEBUG_LF_REAL80:    return 10;
+        case BORDEBUG_LF_REAL128:   return 16;
+        case BORDEBUG_LF_QUADWORD:  return 8;
+        case BORDEBUG_LF_UQUADWORD: return 8;
+        case BORDEBUG_LF_REAL48:    return 6;
+    }
+
+    return 0;
+}
+
+
+//---------------------------------------------------------------------
+
+void    BorDebugTypeFromIndex_64(BorDebugCookie       registerCookie,
+                                 unsigned int         typeIndex,
+                                 unsigned long long * typeOffset,
+                                 unsigned int       * length,
+                                 unsigned int       * typeKind)
+{
+    BdFile  * f = bdTypesFile(registerCookie);
+
+    if  (typeIndex < BD_TYPE_BASE || typeIndex - BD_TYPE_BASE >= f->typeCount)
+    {
+        bdPut(typeOffset, 0);
+        bdPut(length, 0);
+        bdPut(typeKind, BORDEBUG_LF_INVALID_0);
+        return;
+    }
+
+    uint64_t                record = f->typesData + f->typeIndex[typeIndex - BD_TYPE_BASE];
+    const unsigned char   * p      = bdPeek(f, record, 4);
+
+    bdPut(typeOffset, record + 2);
+    bdPut(length, bdGet16(p));
+    bdPut(typeKind, bdGet16(p + 2));
+}
+
+
+void    BorDebugTypeFromOffset_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   typeOffset,
+                                  unsigned int       * length,
+                                  unsigned int       * typeKind)
+{
+    const unsigned char * p = bdPeek(bdFile(registerCookie), typeOffset - 2, 4);
+
+    bdPut(length, typeOffset >= 2 ? bdGet16(p) : 0);
+    bdPut(typeKind, typeOffset >= 2 ? bdGet16(p + 2) : BORDEBUG_LF_INVALID_0);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    WORD attributes, DWORD type
+*/
+
+void    BorDebugTypeMODIFIER_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * attributes,
+                                unsigned int       * typeIndex)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(attributes, c.u16());
+    bdPut(typeIndex, c.u32());
+}
+
+
+/*
+    WORD attributes, DWORD type, followed by:
+        mode 2 or 3:    DWORD class, WORD pmtype
+        based on seg:   WORD segment
+        based on type:  DWORD type, DWORD name
+*/
+
+void    BorDebugTypePOINTER_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * attributes,
+                               unsigned int       * typeIndex,
+                               unsigned int       * value1,
+                               unsigned int       * value2)
+{
+    BdCursor        c      = bdType(registerCookie, typeOffset);
+    unsigned int    attrib = c.u16();
+    unsigned int    mode   = (attrib >> 5) & 0x7;
+    unsigned int    kind   = attrib & 0x1F;
+    unsigned int    v1     = 0;
+    unsigned int    v2     = 0;
+
+    bdPut(attributes, attrib);
+    bdPut(typeIndex, c.u32());
+
+    if  (mode == 2 || mode == 3)
+    {
+        v1 = c.u32();
+        v2 = c.u16();
+    }
+    else if (kind == 3)
+        v1 = c.u16();
+    else if (kind == 8)
+    {
+        v1 = c.u32();
+        v2 = c.u32();
+    }
+
+    bdPut(value1, v1);
+    bdPut(value2, v2);
+}
+
+
+/*
+    DWORD elementType, DWORD indexType, DWORD name, numeric size,
+    numeric elements
+*/
+
+void    BorDebugTypeARRAY_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * elementType,
+                             unsigned int       * indexType,
+                             unsigned int       * name,
+                             unsigned int       * size,
+                             unsigned int       * elements)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(elementType, c.u32());
+    bdPut(indexType, c.u32());
+    bdPut(name, c.u32());
+    bdPut(size, (unsigned int)c.numeric());
+    bdPut(elements, (unsigned int)c.numeric());
+}
+
+
+/*
+    WORD count, DWORD fieldList, WORD property, DWORD containingClass,
+    DWORD derivationList, DWORD vtable, DWORD name, numeric size
+*/
+
+void    BorDebugTypeCLASS_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * fieldCount,
+                             unsigned int       * fieldList,
+                             unsigned int       * property,
+                             unsigned int       * containingClass,
+                             unsigned int       * derivationList,
+                             unsigned int       * vtable,
+                             unsigned int       * name,
+                             unsigned int       * classSize)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(fieldCount, c.u16());
+    bdPut(fieldList, c.u32());
+    bdPut(property, c.u16());
+    bdPut(containingClass, c.u32());
+    bdPut(derivationList, c.u32());
+    bdPut(vtable, c.u32());
+    bdPut(name, c.u32());
+    bdPut(classSize, (unsigned int)c.numeric());
+}
+
+
+/*
+    WORD count, DWORD fieldList, WORD property, DWORD containingClass,
+    DWORD name, numeric size
+*/
+
+void    BorDebugTypeUNION_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * fieldCount,
+                             unsigned int       * fieldList,
+                             unsigned int       * property,
+                             unsigned int       * containingClass,
+                             unsigned int       * name,
+                             unsigned int       * classSize)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(fieldCount, c.u16());
+    bdPut(fieldList, c.u32());
+    bdPut(property, c.u16());
+    bdPut(containingClass, c.u32());
+    bdPut(name, c.u32());
+    bdPut(classSize, (unsigned int)c.numeric());
+}
+
+
+/*
+    WORD count, DWORD underType, DWORD memberList, WORD property,
+    DWORD containingClass, DWORD name
+*/
+
+void    BorDebugTypeENUM_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset,
+                            unsigned int       * memberCount,
+                            unsigned int       * underType,
+                            unsigned int       * memberList,
+                            unsigned int       * containingClass,
+                            unsigned int       * name)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(memberCount, c.u16());
+    bdPut(underType, c.u32());
+    bdPut(memberList, c.u32());
+    c.skip(2);
+    bdPut(containingClass, c.u32());
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD returnType, BYTE callingConvention, BYTE reserved,
+    WORD argCount, DWORD argList
+*/
+
+void    BorDebugTypePROCEDURE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * returnType,
+                                 unsigned int       * callingConvention,
+                                 unsigned int       * argCount,
+                                 unsigned int       * argList)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(returnType, c.u32());
+    bdPut(callingConvention, c.u8());
+    c.skip(1);
+    bdPut(argCount, c.u16());
+    bdPut(argList, c.u32());
+}
+
+
+/*
+    DWORD returnType, DWORD classType, DWORD thisType,
+    BYTE callingConvention, BYTE reserved, WORD argCount,
+    DWORD argList, DWORD thisAdjust
+*/
+
+void    BorDebugTypeMFUNCTION_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * returnType,
+                                 unsigned int       * classType,
+                                 unsigned int       * thisType,
+                                 unsigned int       * callingConvention,
+                                 unsigned int       * argCount,
+                                 unsigned int       * argList,
+                                 unsigned int       * thisAdjust)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(returnType, c.u32());
+    bdPut(classType, c.u32());
+    bdPut(thisType, c.u32());
+    bdPut(callingConvention, c.u8());
+    c.skip(1);
+    bdPut(argCount, c.u16());
+    bdPut(argList, c.u32());
+    bdPut(thisAdjust, c.u32());
+}
+
+
+/*
+    WORD count, 4 bit descriptors packed two to a byte, low nibble first
+*/
+
+unsigned int    BorDebugTypeVTSHAPE_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxCount,
+                                       unsigned char      * descriptorArray)
+{
+    BdCursor        c     = bdType(registerCookie, typeOffset);
+    unsigned int    count = c.u16();
+    unsigned int    byte  = 0;
+
+    for (unsigned int i = 0; i < count && i < maxCount && descriptorArray; i++)
+    {
+        if  ((i & 1) == 0)
+            byte = c.u8();
+
+        descriptorArray[i] = (unsigned char)((i & 1) ? byte >> 4 : byte & 0xF);
+    }
+
+    return count;
+}
+
+
+/*
+    WORD mode
+*/
+
+unsigned int    BorDebugTypeLABEL_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u16();
+}
+
+
+/*
+    DWORD elemType, DWORD name, BYTE lowByte, BYTE length
+*/
+
+void    BorDebugTypeSET_64(BorDebugCookie       registerCookie,
+                           unsigned long long   typeOffset,
+                           unsigned int       * elemType,
+                           unsigned int       * name,
+                           unsigned int       * lowByte,
+                           unsigned int       * length)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(elemType, c.u32());
+    bdPut(name, c.u32());
+    bdPut(lowByte, c.u8());
+    bdPut(length, c.u8());
+}
+
+
+/*
+    DWORD baseType, DWORD name, numeric loBound, numeric hiBound,
+    numeric size
+*/
+
+void    BorDebugTypeSUBRANGE_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * baseType,
+                                unsigned int       * name,
+                                unsigned int       * loBound,
+                                unsigned int       * hiBound,
+                                unsigned int       * size)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(baseType, c.u32());
+    bdPut(name, c.u32());
+    bdPut(loBound, (unsigned int)c.numeric());
+    bdPut(hiBound, (unsigned int)c.numeric());
+    bdPut(size, (unsigned int)c.numeric());
+}
+
+
+/*
+    Same layout as BORDEBUG_LF_ARRAY
+*/
+
+void    BorDebugTypePARRAY_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * elementType,
+                              unsigned int       * indexType,
+                              unsigned int       * name,
+                              unsigned int       * size,
+                              unsigned int       * elements)
+{
+    BorDebugTypeARRAY_64(registerCookie, typeOffset, elementType, indexType,
+                       name, size, elements);
+}
+
+
+/*
+    DWORD elemType, DWORD indexType, DWORD name
+*/
+
+void    BorDebugTypePSTRING_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * elemType,
+                               unsigned int       * indexType,
+                               unsigned int       * name)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(elemType, c.u32());
+    bdPut(indexType, c.u32());
+    bdPut(name, c.u32());
+}
+
+
+/*
+    Same layout as BORDEBUG_LF_PROCEDURE
+*/
+
+void    BorDebugTypeCLOSURE_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * returnType,
+                               unsigned int       * callingConvention,
+                               unsigned int       * argCount,
+                               unsigned int       * argList)
+{
+    BorDebugTypePROCEDURE_64(registerCookie, typeOffset, returnType,
+                           callingConvention, argCount, argList);
+}
+
+
+/*
+    DWORD propType, WORD flags, DWORD arrayIndex, DWORD propIndex,
+    DWORD readSlot, DWORD writeSlot
+*/
+
+void    BorDebugTypePROPERTY_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * propType,
+                                unsigned int       * flags,
+                                unsigned int       * arrayIndex,
+                                unsigned int       * propIndex,
+                                unsigned int       * readSlot,
+                                unsigned int       * writeSlot)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(propType, c.u32());
+    bdPut(flags, c.u16());
+    bdPut(arrayIndex, c.u32());
+    bdPut(propIndex, c.u32());
+    bdPut(readSlot, c.u32());
+    bdPut(writeSlot, c.u32());
+}
+
+
+/*
+    DWORD name, for BORDEBUG_LF_LSTRING, BORDEBUG_LF_VARIANT and
+    BORDEBUG_LF_WSTRING
+*/
+
+unsigned int    BorDebugTypeLSTRING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u32();
+}
+
+
+unsigned int    BorDebugTypeVARIANT_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset)
+{
+    return BorDebugTypeLSTRING_64(registerCookie, typeOffset);
+}
+
+
+unsigned int    BorDebugTypeWSTRING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset)
+{
+    return BorDebugTypeLSTRING_64(registerCookie, typeOffset);
+}
+
+
+/*
+    DWORD refType, DWORD vtShape
+*/
+
+void    BorDebugTypeCLASSREF_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * refType,
+                                unsigned int       * vtShape)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(refType, c.u32());
+    bdPut(vtShape, c.u32());
+}
+
+
+/*
+    WORD count, DWORD type[count], for BORDEBUG_LF_ARGLIST and
+    BORDEBUG_LF_DERIVED
+*/
+
+unsigned int    BorDebugTypeARGLIST_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxTypes,
+                                       unsigned int       * typeIndexArray)
+{
+    BdCursor        c     = bdTypeRecord(registerCookie, typeOffset);
+    unsigned int    count = c.u16();
+
+    for (unsigned int i = 0; i < count && i < maxTypes && typeIndexArray; i++)
+        typeIndexArray[i] = c.u32();
+
+    return count;
+}
+
+
+unsigned int    BorDebugTypeDERIVED_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxTypes,
+                                       unsigned int       * derivedTypes)
+{
+    return BorDebugTypeARGLIST_64(registerCookie, typeOffset, maxTypes, derivedTypes);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    BORDEBUG_LF_FIELDLIST
+
+    A list of the leaves below, each padded to the next one with
+    LF_PAD bytes (0xF0 - 0xFF, the low nibble tells how many bytes
+    to skip), up to the end of the record.
+*/
+
+static void bdSkipField(BdCursor & c, unsigned int kind)
+{
+    switch (kind)
+    {
+        case BORDEBUG_LF_BCLASS:        // DWORD, WORD, numeric
+            c.skip(6);
+            c.skipNumeric();
+            break;
+
+        case BORDEBUG_LF_VBCLASS:       // DWORD, DWORD, WORD, numeric, numeric
+        case BORDEBUG_LF_IVBCLASS:
+            c.skip(10);
+            c.skipNumeric();
+            c.skipNumeric();
+            break;
+
+        case BORDEBUG_LF_ENUMERATE:     // WORD, DWORD, DWORD, numeric
+            c.skip(10);
+            c.skipNumeric();
+            break;
+
+        case BORDEBUG_LF_MEMBER:        // DWORD, WORD, DWORD, DWORD, numeric
+            c.skip(14);
+            c.skipNumeric();
+            break;
+
+        case BORDEBUG_LF_STMEMBER:      // DWORD, WORD, DWORD, DWORD
+            c.skip(14);
+            break;
+
+        case BORDEBUG_LF_METHOD:        // WORD, DWORD, DWORD
+            c.skip(10);
+            break;
+
+        case BORDEBUG_LF_NESTTYPE:      // DWORD, DWORD, DWORD
+            c.skip(12);
+            break;
+
+        case BORDEBUG_LF_FRIENDFCN:     // DWORD, DWORD
+        case BORDEBUG_LF_VFUNCTAB:
+            c.skip(8);
+            break;
+
+        case BORDEBUG_LF_INDEX:         // DWORD
+        case BORDEBUG_LF_FRIENDCLS:
+            c.skip(4);
+            break;
+
+        default:                        // unknown, can't go any further
+            c.pos = c.end;
+            break;
+    }
+}
+
+
+void    BorDebugTypeStartFIELDLIST_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset)
+{
+    BdFile    * f = bdFile(registerCookie);
+    BdCursor    c = bdTypeRecord(registerCookie, typeOffset);
+
+    f->fieldPos = c.pos;
+    f->fieldEnd = c.end;
+}
+
+
+void    BorDebugTypeNextFIELDLIST_64(BorDebugCookie       registerCookie,
+                                     unsigned int       * kind,
+                                     unsigned long long * offset)
+{
+    BdFile    * f = bdFile(registerCookie);
+    BdCursor    c = { f, f->fieldPos, f->fieldEnd };
+
+    while (c.has(1))
+    {
+        unsigned int    pad = bdPeek(f, c.pos, 1)[0];
+
+        if  (pad < 0xF0)
+            break;
+
+        c.skip((pad & 0x0F) ? (pad & 0x0F) : 1);
+    }
+
+    if  (!c.has(2))
+    {
+        f->fieldPos = f->fieldEnd;
+
+        bdPut(kind, 0);
+        bdPut(offset, 0);
+        return;
+    }
+
+    uint64_t        start = c.pos;
+    unsigned int    leaf  = c.u16();
+
+    bdSkipField(c, leaf);
+    f->fieldPos = c.pos;
+
+    bdPut(kind, leaf);
+    bdPut(offset, start);
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    BYTE length, BYTE position, DWORD type
+*/
+
+void    BorDebugTypeBITFIELD_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * length,
+                                unsigned int       * position,
+                                unsigned int       * typeIndex)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(length, c.u8());
+    bdPut(position, c.u8());
+    bdPut(typeIndex, c.u32());
+}
+
+
+/*
+    Up to the end of the record:
+    WORD attrib, DWORD type, DWORD browser, and DWORD vtabOffset for
+    introducing virtual methods (mprop 4 and 6)
+*/
+
+unsigned int    BorDebugTypeMETHODLIST_64(BorDebugCookie       registerCookie,
+                                          unsigned long long   typeOffset,
+                                          unsigned int         maxMethods,
+                                          unsigned int       * typeArray,
+                                          unsigned int       * attribArray,
+                                          unsigned int       * browserArray,
+                                          unsigned int       * vtabOffArray)
+{
+    BdCursor        c     = bdTypeRecord(registerCookie, typeOffset);
+    unsigned int    count = 0;
+
+    while (c.has(10))
+    {
+        unsigned int    attrib  = c.u16();
+        unsigned int    type    = c.u32();
+        unsigned int    browser = c.u32();
+        unsigned int    mprop   = (attrib >> 2) & 0x7;
+        unsigned int    vtabOff = (mprop == 4 || mprop == 6) ? c.u32() : 0;
+
+        if  (count < maxMethods)
+        {
+            if  (typeArray)
+                typeArray[count] = type;
+
+            if  (attribArray)
+                attribArray[count] = attrib;
+
+            if  (browserArray)
+                browserArray[count] = browser;
+
+            if  (vtabOffArray)
+                vtabOffArray[count] = vtabOff;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+
+/*
+    DWORD baseType, WORD attrib, numeric offset
+*/
+
+void    BorDebugTypeBCLASS_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * baseType,
+                              unsigned int       * attrib,
+                              unsigned int       * offset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(baseType, c.u32());
+    bdPut(attrib, c.u16());
+    bdPut(offset, (unsigned int)c.numeric());
+}
+
+
+/*
+    DWORD vbType, DWORD vbpType, WORD attrib, numeric vbpOffset,
+    numeric offset, for BORDEBUG_LF_VBCLASS and BORDEBUG_LF_IVBCLASS
+*/
+
+void    BorDebugTypeVBCLASS_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * vbType,
+                               unsigned int       * vbptype,
+                               unsigned int       * attrib,
+                               unsigned int       * vbpOffset,
+                               unsigned int       * offset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(vbType, c.u32());
+    bdPut(vbptype, c.u32());
+    bdPut(attrib, c.u16());
+    bdPut(vbpOffset, (unsigned int)c.numeric());
+    bdPut(offset, (unsigned int)c.numeric());
+}
+
+
+void    BorDebugTypeIVBCLASS_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * vbType,
+                                unsigned int       * vbpType,
+                                unsigned int       * attrib,
+                                unsigned int       * vbpOffset,
+                                unsigned int       * offset)
+{
+    BorDebugTypeVBCLASS_64(registerCookie, typeOffset, vbType, vbpType,
+                         attrib, vbpOffset, offset);
+}
+
+
+/*
+    WORD attrib, DWORD name, DWORD browser, numeric value
+*/
+
+void    BorDebugTypeENUMERATE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * attrib,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset,
+                                 unsigned int       * value)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(attrib, c.u16());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+    bdPut(value, (unsigned int)c.numeric());
+}
+
+
+/*
+    DWORD type, DWORD name
+*/
+
+void    BorDebugTypeFRIENDFCN_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD index
+*/
+
+unsigned int    BorDebugTypeINDEX_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u32();
+}
+
+
+/*
+    DWORD type, WORD attrib, DWORD name, DWORD browser, numeric offset
+*/
+
+void    BorDebugTypeMEMBER_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * typeIndex,
+                              unsigned int       * attrib,
+                              unsigned int       * name,
+                              unsigned int       * offset,
+                              unsigned int       * browserOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(attrib, c.u16());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+    bdPut(offset, (unsigned int)c.numeric());
+}
+
+
+/*
+    DWORD type, WORD attrib, DWORD name, DWORD browser
+*/
+
+void    BorDebugTypeSTMEMBER_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * attrib,
+                                unsigned int       * name,
+                                unsigned int       * browserOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(attrib, c.u16());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+/*
+    WORD count, DWORD methodList, DWORD name
+*/
+
+void    BorDebugTypeMETHOD_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * count,
+                              unsigned int       * methodList,
+                              unsigned int       * name)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(count, c.u16());
+    bdPut(methodList, c.u32());
+    bdPut(name, c.u32());
+}
+
+
+/*
+    DWORD type, DWORD name, DWORD browser
+*/
+
+void    BorDebugTypeNESTTYPE_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * name,
+                                unsigned int       * browserOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(name, c.u32());
+    bdPut(browserOffset, c.u32());
+}
+
+
+/*
+    DWORD type, DWORD offset
+*/
+
+void    BorDebugTypeVFUNCTAB_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * offset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    bdPut(typeIndex, c.u32());
+    bdPut(offset, c.u32());
+}
+
+
+/*
+    DWORD type
+*/
+
+unsigned int    BorDebugTypeFRIENDCLS_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u32();
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    Numeric leaves, the value follows the leaf
+*/
+
+char    BorDebugTypeCHAR_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return (char)c.u8();
+}
+
+
+short   BorDebugTypeSHORT_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return (short)c.u16();
+}
+
+
+unsigned short  BorDebugTypeUSHORT_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return (unsigned short)c.u16();
+}
+
+
+long    BorDebugTypeLONG_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return (long)(int)c.u32();
+}
+
+
+unsigned long   BorDebugTypeULONG_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u32();
+}
+
+
+float   BorDebugTypeREAL32_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset)
+{
+    BdCursor        c    = bdType(registerCookie, typeOffset);
+    unsigned int    bits = c.u32();
+    float           value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+double  BorDebugTypeREAL64_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset)
+{
+    BdCursor    c    = bdType(registerCookie, typeOffset);
+    uint64_t    bits = c.u64();
+    double      value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/*
+    80 bit IEEE extended: 64 bit mantissa with explicit integer bit,
+    15 bit exponent biased by 16383, sign
+*/
+
+long double     BorDebugTypeREAL80_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset)
+{
+    BdCursor        c        = bdType(registerCookie, typeOffset);
+    uint64_t        mantissa = c.u64();
+    unsigned int    signExp  = c.u16();
+    int             exponent = (int)(signExp & 0x7FFF);
+    long double     value;
+
+    if  (exponent == 0x7FFF)
+        value = mantissa << 1 ? (long double)NAN : (long double)INFINITY;
+    else
+        value = ldexpl((long double)mantissa, (exponent ? exponent : 1) - 16383 - 63);
+
+    return (signExp & 0x8000) ? -value : value;
+}
+
+
+long long       BorDebugTypeQUADWORD_64(BorDebugCookie       registerCookie,
+                                        unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return (long long)c.u64();
+}
+
+
+unsigned long long      BorDebugTypeUQUADWORD_64(BorDebugCookie       registerCookie,
+                                                 unsigned long long   typeOffset)
+{
+    BdCursor    c = bdType(registerCookie, typeOffset);
+
+    return c.u64();
+}
+
+
+/*
+    48 bit Pascal real: exponent byte biased by 129 (0 means zero),
+    39 bit fraction with an implicit leading 1, sign in the top bit
+*/
+
+double  BorDebugTypeREAL48_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset)
+{
+    BdCursor        c        = bdType(registerCookie, typeOffset);
+    unsigned char   bytes[6];
+
+    c.bytes(bytes, sizeof(bytes));
+
+    if  (bytes[0] == 0)
+        return 0.0;
+
+    uint64_t    fraction = 0;
+
+    for (int i = 5; i >= 1; i--)
+        fraction = (fraction << 8) | bytes[i];
+
+    fraction &= ((uint64_t)1 << 39) - 1;
+
+    double  value = ldexp(1.0 + ldexp((double)fraction, -39), (int)bytes[0] - 129);
+
+    return (bytes[5] & 0x80) ? -value : value;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    BorDebugTypeIndexToString
+
+    Type indices below 0x1000 are built-in types:
+        bits 0 - 2  size
+        bits 4 - 7  type
+        bits 8 - 10 pointer mode
+*/
+
+static const char * bdBasicTypeName(unsigned int type)
+{
+    switch (type)
+    {
+        case 0x0000:    return "";
+        case 0x0001:    return "absolute";
+        case 0x0002:    return "segment";
+        case 0x0003:    return "void";
+        case 0x0004:    return "currency";
+        case 0x0005:    return "pascal string";
+        case 0x0006:    return "pascal string";
+        case 0x0007:    return "pascal string";
+        case 0x0008:    return "untranslated";
+
+        case 0x0010:    return "signed char";
+        case 0x0011:    return "short";
+        case 0x0012:    return "long";
+        case 0x0013:    return "__int64";
+
+        case 0x0020:    return "unsigned char";
+        case 0x0021:    return "unsigned short";
+        case 0x0022:    return "unsigned long";
+        case 0x0023:    return "unsigned __int64";
+
+        case 0x0030:    return "bool";
+        case 0x0031:    return "WordBool";
+        case 0x0032:    return "LongBool";
+
+        case 0x0040:    return "float";
+        case 0x0041:    return "double";
+        case 0x0042:    return "long double";
+        case 0x0043:    return "real128";
+        case 0x0044:    return "real48";
+
+        case 0x0050:    return "complex float";
+        case 0x0051:    return "complex double";
+        case 0x0052:    return "complex long double";
+
+        case 0x0060:    return "bit";
+        case 0x0061:    return "pascal char";
+
+        case 0x0068:    return "signed char";
+        case 0x0069:    return "unsigned char";
+        case 0x0070:    return "char";
+        case 0x0071:    return "wchar_t";
+        case 0x0072:    return "short";
+        case 0x0073:    return "unsigned short";
+        case 0x0074:    return "int";
+        case 0x0075:    return "unsigned int";
+        case 0x0076:    return "__int64";
+        case 0x0077:    return "unsigned __int64";
+    }
+
+    return 0;
+}
+
+
+static void bdTypeString(BorDebugCookie registerCookie,
+                         unsigned int   typeIndex,
+                         std::string  & out,
+                         int            depth);
+
+
+static void bdNamedType(BorDebugCookie registerCookie,
+                        unsigned int   name,
+                        std::string  & out)
+{
+    char    buf[260];
+
+    BorDebugNameIndexToName(registerCookie, name, buf, sizeof(buf));
+    out += buf;
+}
+
+
+static void bdTypeString(BorDebugCookie registerCookie,
+                         unsigned int   typeIndex,
+                         std::string  & out,
+                         int            depth)
+{
+    char    buf[32];
+
+    if  (typeIndex & 0x80000000)
+    {
+        snprintf(buf, sizeof(buf), "EI[%u]", 0u - typeIndex);
+        out += buf;
+        return;
+    }
+
+    if  (typeIndex < BD_TYPE_BASE)
+    {
+        static const char * const modes[] =
+        {
+            "", " near *", " far *", " huge *", " *", " far32 *", " *", " *"
+        };
+
+        const char  * name = bdBasicTypeName(typeIndex & 0xFF);
+
+        if  (!name)
+        {
+            snprintf(buf, sizeof(buf), "0x%X", typeIndex);
+            out += buf;
+            return;
+        }
+
+        out += name;
+        out += modes[(typeIndex >> 8) & 0x7];
+        return;
+    }
+
+    unsigned long long  offset;
+    unsigned int        length;
+    unsigned int        kind;
+
+    BorDebugTypeFromIndex_64(registerCookie, typeIndex, &offset, &length, &kind);
+
+    if  (depth < BD_TYPE_MAX_DEPTH)
+    {
+        unsigned int    type;
+        unsigned int    name;
+        unsigned int    attrib;
+        unsigned int    count;
+
+        switch (kind)
+        {
+            case BORDEBUG_LF_MODIFIER:
+                BorDebugTypeMODIFIER_64(registerCookie, offset, &attrib, &type);
+
+                if  (attrib & 0x1)
+                    out += "const ";
+
+                if  (attrib & 0x2)
+                    out += "volatile ";
+
+                bdTypeString(registerCookie, type, out, depth + 1);
+                return;
+
+            case BORDEBUG_LF_POINTER:
+                BorDebugTypePOINTER_64(registerCookie, offset, &attrib, &type, 0, 0);
+                bdTypeString(registerCookie, type, out, depth + 1);
+                out += ((attrib >> 5) & 0x7) == 1 ? " &" : " *";
+                return;
+
+            case BORDEBUG_LF_ARRAY:
+            case BORDEBUG_LF_PARRAY:
+                BorDebugTypeARRAY_64(registerCookie, offset, &type, 0, 0, 0, &count);
+                bdTypeString(registerCookie, type, out, depth + 1);
+                snprintf(buf, sizeof(buf), "[%u]", count);
+                out += buf;
+                return;
+
+            case BORDEBUG_LF_CLASS:
+            case BORDEBUG_LF_STRUCT:
+                BorDebugTypeCLASS_64(registerCookie, offset, 0, 0, 0, 0, 0, 0, &name, 0);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_UNION:
+                BorDebugTypeUNION_64(registerCookie, offset, 0, 0, 0, 0, &name, 0);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_ENUM:
+                BorDebugTypeENUM_64(registerCookie, offset, 0, 0, 0, 0, &name);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_PROCEDURE:
+            case BORDEBUG_LF_CLOSURE:
+            case BORDEBUG_LF_MFUNCTION:
+            {
+                unsigned int    argList;
+
+                if  (kind == BORDEBUG_LF_MFUNCTION)
+                    BorDebugTypeMFUNCTION_64(registerCookie, offset, &type, 0, 0, 0, 0, &argList, 0);
+                else
+                    BorDebugTypePROCEDURE_64(registerCookie, offset, &type, 0, 0, &argList);
+
+                bdTypeString(registerCookie, type, out, depth + 1);
+                out += " (";
+
+                unsigned long long  argOffset;
+                unsigned int        args[32];
+
+                BorDebugTypeFromIndex_64(registerCookie, argList, &argOffset, &length, &kind);
+
+                count = kind == BORDEBUG_LF_ARGLIST ?
+                        BorDebugTypeARGLIST_64(registerCookie, argOffset, 32, args) : 0;
+
+                for (unsigned int i = 0; i < count && i < 32; i++)
+                {
+                    if  (i)
+                        out += ", ";
+
+                    bdTypeString(registerCookie, args[i], out, depth + 1);
+                }
+
+                out += ")";
+                return;
+            }
+
+            case BORDEBUG_LF_SET:
+                BorDebugTypeSET_64(registerCookie, offset, 0, &name, 0, 0);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_SUBRANGE:
+                BorDebugTypeSUBRANGE_64(registerCookie, offset, 0, &name, 0, 0, 0);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_PSTRING:
+                BorDebugTypePSTRING_64(registerCookie, offset, 0, 0, &name);
+                bdNamedType(registerCookie, name, out);
+                return;
+
+            case BORDEBUG_LF_LSTRING:
+            case BORDEBUG_LF_VARIANT:
+            case BORDEBUG_LF_WSTRING:
+                bdNamedType(registerCookie, BorDebugTypeLSTRING_64(registerCookie, offset), out);
+                return;
+        }
+    }
+
+    snprintf(buf, sizeof(buf), "0x%X", typeIndex);
+    out += buf;
+}
+
+
+void    BorDebugTypeIndexToString(BorDebugCookie registerCookie,
+                                  unsigned int   typeIndex,
+                                  char         * buf,
+                                  unsigned int   bufLen)
+{
+    std::string     out;
+
+    if  (!buf || !bufLen)
+        return;
+
+    try
+    {
+        bdTypeString(registerCookie, typeIndex, out, 0);
+    }
+    catch (...)
+    {
+        out.clear();
+    }
+
+    size_t  n = out.size() < bufLen - 1 ? out.size() : bufLen - 1;
+
+    memcpy(buf, out.data(), n);
+    buf[n] = 0;
+}
+
+
+//---------------------------------------------------------------------
+
+/*
+    32 bit offset versions of the API's above
+*/
+
+void    BorDebugTypeFromIndex(BorDebugCookie registerCookie,
+                              unsigned int   typeIndex,
+                              unsigned int * typeOffset,
+                              unsigned int * length,
+                              unsigned int * typeKind)
+{
+    unsigned long long  typeOffset64 = 0;
+
+    BorDebugTypeFromIndex_64(registerCookie, typeIndex,
+                             typeOffset ? &typeOffset64 : 0, length, typeKind);
+    bdPut(typeOffset, (unsigned int)typeOffset64);
+}
+
+
+void    BorDebugTypeFromOffset(BorDebugCookie registerCookie,
+                               unsigned int   typeOffset,
+                               unsigned int * length,
+                               unsigned int * typeKind)
+{
+    BorDebugTypeFromOffset_64(registerCookie, typeOffset, length, typeKind);
+}
+
+
+void    BorDebugTypeMODIFIER(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * attributes,
+                             unsigned int * typeIndex)
+{
+    BorDebugTypeMODIFIER_64(registerCookie, typeOffset, attributes, typeIndex);
+}
+
+
+void    BorDebugTypePOINTER(BorDebugCookie registerCookie,
+                            unsigned int   typeOffset,
+                            unsigned int * attributes,
+                            unsigned int * typeIndex,
+                            unsigned int * value1,
+                            unsigned int * value2)
+{
+    BorDebugTypePOINTER_64(registerCookie, typeOffset, attributes, typeIndex,
+                           value1, value2);
+}
+
+
+void    BorDebugTypeARRAY(BorDebugCookie registerCookie,
+                          unsigned int   typeOffset,
+                          unsigned int * elementType,
+                          unsigned int * indexType,
+                          unsigned int * name,
+                          unsigned int * size,
+                          unsigned int * elements)
+{
+    BorDebugTypeARRAY_64(registerCookie, typeOffset, elementType, indexType, name,
+                         size, elements);
+}
+
+
+void    BorDebugTypeCLASS(BorDebugCookie registerCookie,
+                          unsigned int   typeOffset,
+                          unsigned int * fieldCount,
+                          unsigned int * fieldList,
+                          unsigned int * property,
+                          unsigned int * containingClass,
+                          unsigned int * derivationList,
+                          unsigned int * vtable,
+                          unsigned int * name,
+                          unsigned int * classSize)
+{
+    BorDebugTypeCLASS_64(registerCookie, typeOffset, fieldCount, fieldList,
+                         property, containingClass, derivationList, vtable, name,
+                         classSize);
+}
+
+
+void    BorDebugTypeUNION(BorDebugCookie registerCookie,
+                          unsigned int   typeOffset,
+                          unsigned int * fieldCount,
+                          unsigned int * fieldList,
+                          unsigned int * property,
+                          unsigned int * containingClass,
+                          unsigned int * name,
+                          unsigned int * classSize)
+{
+    BorDebugTypeUNION_64(registerCookie, typeOffset, fieldCount, fieldList,
+                         property, containingClass, name, classSize);
+}
+
+
+void    BorDebugTypeENUM(BorDebugCookie registerCookie,
+                         unsigned int   typeOffset,
+                         unsigned int * memberCount,
+                         unsigned int * underType,
+                         unsigned int * memberList,
+                         unsigned int * containingClass,
+                         unsigned int * name)
+{
+    BorDebugTypeENUM_64(registerCookie, typeOffset, memberCount, underType,
+                        memberList, containingClass, name);
+}
+
+
+void    BorDebugTypePROCEDURE(BorDebugCookie registerCookie,
+                              unsigned int   typeOffset,
+                              unsigned int * returnType,
+                              unsigned int * callingConvention,
+                              unsigned int * argCount,
+                              unsigned int * argList)
+{
+    BorDebugTypePROCEDURE_64(registerCookie, typeOffset, returnType,
+                             callingConvention, argCount, argList);
+}
+
+
+void    BorDebugTypeMFUNCTION(BorDebugCookie registerCookie,
+                              unsigned int   typeOffset,
+                              unsigned int * returnType,
+                              unsigned int * classType,
+                              unsigned int * thisType,
+                              unsigned int * callingConvention,
+                              unsigned int * argCount,
+                              unsigned int * argList,
+                              unsigned int * thisAdjust)
+{
+    BorDebugTypeMFUNCTION_64(registerCookie, typeOffset, returnType, classType,
+                             thisType, callingConvention, argCount, argList,
+                             thisAdjust);
+}
+
+
+unsigned int    BorDebugTypeVTSHAPE(BorDebugCookie  registerCookie,
+                                    unsigned int    typeOffset,
+                                    unsigned int    maxCount,
+                                    unsigned char * descriptorArray)
+{
+    return BorDebugTypeVTSHAPE_64(registerCookie, typeOffset, maxCount,
+                                  descriptorArray);
+}
+
+
+unsigned int    BorDebugTypeLABEL(BorDebugCookie registerCookie,
+                                  unsigned int   typeOffset)
+{
+    return BorDebugTypeLABEL_64(registerCookie, typeOffset);
+}
+
+
+void    BorDebugTypeSET(BorDebugCookie registerCookie,
+                        unsigned int   typeOffset,
+                        unsigned int * elemType,
+                        unsigned int * name,
+                        unsigned int * lowByte,
+                        unsigned int * length)
+{
+    BorDebugTypeSET_64(registerCookie, typeOffset, elemType, name, lowByte, length);
+}
+
+
+void    BorDebugTypeSUBRANGE(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * baseType,
+                             unsigned int * name,
+                             unsigned int * loBound,
+                             unsigned int * hiBound,
+                             unsigned int * size)
+{
+    BorDebugTypeSUBRANGE_64(registerCookie, typeOffset, baseType, name, loBound,
+                            hiBound, size);
+}
+
+
+void    BorDebugTypePARRAY(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset,
+                           unsigned int * elementType,
+                           unsigned int * indexType,
+                           unsigned int * name,
+                           unsigned int * size,
+                           unsigned int * elements)
+{
+    BorDebugTypePARRAY_64(registerCookie, typeOffset, elementType, indexType,
+                          name, size, elements);
+}
+
+
+void    BorDebugTypePSTRING(BorDebugCookie registerCookie,
+                            unsigned int   typeOffset,
+                            unsigned int * elemType,
+                            unsigned int * indexType,
+                            unsigned int * name)
+{
+    BorDebugTypePSTRING_64(registerCookie, typeOffset, elemType, indexType, name);
+}
+
+
+void    BorDebugTypeCLOSURE(BorDebugCookie registerCookie,
+                            unsigned int   typeOffset,
+                            unsigned int * returnType,
+                            unsigned int * callingConvention,
+                            unsigned int * argCount,
+                            unsigned int * argList)
+{
+    BorDebugTypeCLOSURE_64(registerCookie, typeOffset, returnType,
+                           callingConvention, argCount, argList);
+}
+
+
+void    BorDebugTypePROPERTY(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * propType,
+                             unsigned int * flags,
+                             unsigned int * arrayIndex,
+                             unsigned int * propIndex,
+                             unsigned int * readSlot,
+                             unsigned int * writeSlot)
+{
+    BorDebugTypePROPERTY_64(registerCookie, typeOffset, propType, flags,
+                            arrayIndex, propIndex, readSlot, writeSlot);
+}
+
+
+unsigned int    BorDebugTypeLSTRING(BorDebugCookie registerCookie,
+                                    unsigned int   typeOffset)
+{
+    return BorDebugTypeLSTRING_64(registerCookie, typeOffset);
+}
+
+
+unsigned int    BorDebugTypeVARIANT(BorDebugCookie registerCookie,
+                                    unsigned int   typeOffset)
+{
+    return BorDebugTypeVARIANT_64(registerCookie, typeOffset);
+}
+
+
+unsigned int    BorDebugTypeWSTRING(BorDebugCookie registerCookie,
+                                    unsigned int   typeOffset)
+{
+    return BorDebugTypeWSTRING_64(registerCookie, typeOffset);
+}
+
+
+void    BorDebugTypeCLASSREF(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * refType,
+                             unsigned int * vtShape)
+{
+    BorDebugTypeCLASSREF_64(registerCookie, typeOffset, refType, vtShape);
+}
+
+
+unsigned int    BorDebugTypeARGLIST(BorDebugCookie registerCookie,
+                                    unsigned int   typeOffset,
+                                    unsigned int   maxTypes,
+                                    unsigned int * typeIndexArray)
+{
+    return BorDebugTypeARGLIST_64(registerCookie, typeOffset, maxTypes,
+                                  typeIndexArray);
+}
+
+
+unsigned int    BorDebugTypeDERIVED(BorDebugCookie registerCookie,
+                                    unsigned int   typeOffset,
+                                    unsigned int   maxTypes,
+                                    unsigned int * derivedTypes)
+{
+    return BorDebugTypeDERIVED_64(registerCookie, typeOffset, maxTypes,
+                                  derivedTypes);
+}
+
+
+void    BorDebugTypeStartFIELDLIST(BorDebugCookie registerCookie,
+                                   unsigned int   typeOffset)
+{
+    BorDebugTypeStartFIELDLIST_64(registerCookie, typeOffset);
+}
+
+
+void    BorDebugTypeNextFIELDLIST(BorDebugCookie registerCookie,
+                                  unsigned int * kind,
+                                  unsigned int * offset)
+{
+    unsigned long long  offset64 = 0;
+
+    BorDebugTypeNextFIELDLIST_64(registerCookie, kind, offset ? &offset64 : 0);
+    bdPut(offset, (unsigned int)offset64);
+}
+
+
+void    BorDebugTypeBITFIELD(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * length,
+                             unsigned int * position,
+                             unsigned int * typeIndex)
+{
+    BorDebugTypeBITFIELD_64(registerCookie, typeOffset, length, position, typeIndex);
+}
+
+
+unsigned int    BorDebugTypeMETHODLIST(BorDebugCookie registerCookie,
+                                       unsigned int   typeOffset,
+                                       unsigned int   maxMethods,
+                                       unsigned int * typeArray,
+                                       unsigned int * attribArray,
+                                       unsigned int * browserArray,
+                                       unsigned int * vtabOffArray)
+{
+    return BorDebugTypeMETHODLIST_64(registerCookie, typeOffset, maxMethods,
+                                     typeArray, attribArray, browserArray,
+                                     vtabOffArray);
+}
+
+
+void    BorDebugTypeBCLASS(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset,
+                           unsigned int * baseType,
+                           unsigned int * attrib,
+                           unsigned int * offset)
+{
+    BorDebugTypeBCLASS_64(registerCookie, typeOffset, baseType, attrib, offset);
+}
+
+
+void    BorDebugTypeVBCLASS(BorDebugCookie registerCookie,
+                            unsigned int   typeOffset,
+                            unsigned int * vbType,
+                            unsigned int * vbptype,
+                            unsigned int * attrib,
+                            unsigned int * vbpOffset,
+                            unsigned int * offset)
+{
+    BorDebugTypeVBCLASS_64(registerCookie, typeOffset, vbType, vbptype, attrib,
+                           vbpOffset, offset);
+}
+
+
+void    BorDebugTypeIVBCLASS(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * vbType,
+                             unsigned int * vbpType,
+                             unsigned int * attrib,
+                             unsigned int * vbpOffset,
+                             unsigned int * offset)
+{
+    BorDebugTypeIVBCLASS_64(registerCookie, typeOffset, vbType, vbpType, attrib,
+                            vbpOffset, offset);
+}
+
+
+void    BorDebugTypeENUMERATE(BorDebugCookie registerCookie,
+                              unsigned int   typeOffset,
+                              unsigned int * attrib,
+                              unsigned int * name,
+                              unsigned int * browserOffset,
+                              unsigned int * value)
+{
+    BorDebugTypeENUMERATE_64(registerCookie, typeOffset, attrib, name,
+                             browserOffset, value);
+}
+
+
+void    BorDebugTypeFRIENDFCN(BorDebugCookie registerCookie,
+                              unsigned int   typeOffset,
+                              unsigned int * typeIndex,
+                              unsigned int * name)
+{
+    BorDebugTypeFRIENDFCN_64(registerCookie, typeOffset, typeIndex, name);
+}
+
+
+unsigned int    BorDebugTypeINDEX(BorDebugCookie registerCookie,
+                                  unsigned int   typeOffset)
+{
+    return BorDebugTypeINDEX_64(registerCookie, typeOffset);
+}
+
+
+void    BorDebugTypeMEMBER(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset,
+                           unsigned int * typeIndex,
+                           unsigned int * attrib,
+                           unsigned int * name,
+                           unsigned int * offset,
+                           unsigned int * browserOffset)
+{
+    BorDebugTypeMEMBER_64(registerCookie, typeOffset, typeIndex, attrib, name,
+                          offset, browserOffset);
+}
+
+
+void    BorDebugTypeSTMEMBER(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * typeIndex,
+                             unsigned int * attrib,
+                             unsigned int * name,
+                             unsigned int * browserOffset)
+{
+    BorDebugTypeSTMEMBER_64(registerCookie, typeOffset, typeIndex, attrib, name,
+                            browserOffset);
+}
+
+
+void    BorDebugTypeMETHOD(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset,
+                           unsigned int * count,
+                           unsigned int * methodList,
+                           unsigned int * name)
+{
+    BorDebugTypeMETHOD_64(registerCookie, typeOffset, count, methodList, name);
+}
+
+
+void    BorDebugTypeNESTTYPE(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * typeIndex,
+                             unsigned int * name,
+                             unsigned int * browserOffset)
+{
+    BorDebugTypeNESTTYPE_64(registerCookie, typeOffset, typeIndex, name,
+                            browserOffset);
+}
+
+
+void    BorDebugTypeVFUNCTAB(BorDebugCookie registerCookie,
+                             unsigned int   typeOffset,
+                             unsigned int * typeIndex,
+                             unsigned int * offset)
+{
+    BorDebugTypeVFUNCTAB_64(registerCookie, typeOffset, typeIndex, offset);
+}
+
+
+unsigned int    BorDebugTypeFRIENDCLS(BorDebugCookie registerCookie,
+                                      unsigned int   typeOffset)
+{
+    return BorDebugTypeFRIENDCLS_64(registerCookie, typeOffset);
+}
+
+
+char    BorDebugTypeCHAR(BorDebugCookie registerCookie,
+                         unsigned int   typeOffset)
+{
+    return BorDebugTypeCHAR_64(registerCookie, typeOffset);
+}
+
+
+short   BorDebugTypeSHORT(BorDebugCookie registerCookie,
+                          unsigned int   typeOffset)
+{
+    return BorDebugTypeSHORT_64(registerCookie, typeOffset);
+}
+
+
+unsigned short  BorDebugTypeUSHORT(BorDebugCookie registerCookie,
+                                   unsigned int   typeOffset)
+{
+    return BorDebugTypeUSHORT_64(registerCookie, typeOffset);
+}
+
+
+long    BorDebugTypeLONG(BorDebugCookie registerCookie,
+                         unsigned int   typeOffset)
+{
+    return BorDebugTypeLONG_64(registerCookie, typeOffset);
+}
+
+
+unsigned long   BorDebugTypeULONG(BorDebugCookie registerCookie,
+                                  unsigned int   typeOffset)
+{
+    return BorDebugTypeULONG_64(registerCookie, typeOffset);
+}
+
+
+float   BorDebugTypeREAL32(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset)
+{
+    return BorDebugTypeREAL32_64(registerCookie, typeOffset);
+}
+
+
+double  BorDebugTypeREAL64(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset)
+{
+    return BorDebugTypeREAL64_64(registerCookie, typeOffset);
+}
+
+
+long double     BorDebugTypeREAL80(BorDebugCookie registerCookie,
+                                   unsigned int   typeOffset)
+{
+    return BorDebugTypeREAL80_64(registerCookie, typeOffset);
+}
+
+
+long long       BorDebugTypeQUADWORD(BorDebugCookie registerCookie,
+                                     unsigned int   typeOffset)
+{
+    return BorDebugTypeQUADWORD_64(registerCookie, typeOffset);
+}
+
+
+unsigned long long      BorDebugTypeUQUADWORD(BorDebugCookie registerCookie,
+                                              unsigned int   typeOffset)
+{
+    return BorDebugTypeUQUADWORD_64(registerCookie, typeOffset);
+}
+
+
+double  BorDebugTypeREAL48(BorDebugCookie registerCookie,
+                           unsigned int   typeOffset)
+{
+    return BorDebugTypeREAL48_64(registerCookie, typeOffset);
+}
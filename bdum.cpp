@@ -0,0 +1,861 @@
+//---------------------------------------------------------------------
+
+/*
+    Unmangler for names mangled by the Borland 32 bit compilers
+
+    A mangled name looks like this:
+
+        @qual@qual@name$qargs       function
+        @qual@qual@name             data
+        @qual@$bctr$qargs           special function, see bdOperators
+        @qual@$oTYPE$qargs          conversion operator
+        @$xt$TYPE                   type descriptor (RTTI)
+
+    A qualifier or name can be a template, written as %name$targs%.
+    The function prefix can carry 'x' (const) and 'w' (volatile) for
+    member functions, and 'qr' (__fastcall) or 'qs' (__stdcall) after
+    the 'q'.
+
+    Types:
+
+        v void          c char          zc signed char  uc unsigned char
+        s short         us ushort       i int           ui unsigned int
+        l long          ul ulong        j __int64       uj unsigned __int64
+        f float         d double        g long double   o bool
+        b wchar_t       e ...
+        x const         w volatile      pT pointer      rT reference
+        aN$T array      qargs$T function
+        MCT pointer to member of class C
+        tN  same type as argument N (1-9, then a-z for 10 and up)
+        N   class or enum, the next N characters are its qualified name
+
+    When a name can't be parsed, the unmangled output gets the source
+    line where that was found, in curly braces.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "bdpriv.h"
+
+
+namespace
+{
+
+
+struct UmError
+{
+    int     line;
+};
+
+
+#define UM_FAIL()   throw UmError{ __LINE__ }
+
+
+struct UmOperator
+{
+    const char  * code;
+    const char  * name;
+    unsigned int  kind;
+};
+
+
+const UmOperator    bdOperators[] =
+{
+    { "ctr",  0,              BORDEBUG_UM_CONSTRUCTOR },
+    { "dtr",  0,              BORDEBUG_UM_DESTRUCTOR  },
+    { "add",  "operator +",   BORDEBUG_UM_OPERATOR    },
+    { "sub",  "operator -",   BORDEBUG_UM_OPERATOR    },
+    { "mul",  "operator *",   BORDEBUG_UM_OPERATOR    },
+    { "div",  "operator /",   BORDEBUG_UM_OPERATOR    },
+    { "mod",  "operator %",   BORDEBUG_UM_OPERATOR    },
+    { "and",  "operator &",   BORDEBUG_UM_OPERATOR    },
+    { "or",   "operator |",   BORDEBUG_UM_OPERATOR    },
+    { "xor",  "operator ^",   BORDEBUG_UM_OPERATOR    },
+    { "not",  "operator !",   BORDEBUG_UM_OPERATOR    },
+    { "cmp",  "operator ~",   BORDEBUG_UM_OPERATOR    },
+    { "asg",  "operator =",   BORDEBUG_UM_OPERATOR    },
+    { "eql",  "operator ==",  BORDEBUG_UM_OPERATOR    },
+    { "neq",  "operator !=",  BORDEBUG_UM_OPERATOR    },
+    { "lss",  "operator <",   BORDEBUG_UM_OPERATOR    },
+    { "gtr",  "operator >",   BORDEBUG_UM_OPERATOR    },
+    { "leq",  "operator <=",  BORDEBUG_UM_OPERATOR    },
+    { "geq",  "operator >=",  BORDEBUG_UM_OPERATOR    },
+    { "lsh",  "operator <<",  BORDEBUG_UM_OPERATOR    },
+    { "rsh",  "operator >>",  BORDEBUG_UM_OPERATOR    },
+    { "inc",  "operator ++",  BORDEBUG_UM_OPERATOR    },
+    { "dec",  "operator --",  BORDEBUG_UM_OPERATOR    },
+    { "land", "operator &&",  BORDEBUG_UM_OPERATOR    },
+    { "lor",  "operator ||",  BORDEBUG_UM_OPERATOR    },
+    { "rand", "operator &=",  BORDEBUG_UM_OPERATOR    },
+    { "rdiv", "operator /=",  BORDEBUG_UM_OPERATOR    },
+    { "rlsh", "operator <<=", BORDEBUG_UM_OPERATOR    },
+    { "rmin", "operator -=",  BORDEBUG_UM_OPERATOR    },
+    { "rmod", "operator %=",  BORDEBUG_UM_OPERATOR    },
+    { "rmul", "operator *=",  BORDEBUG_UM_OPERATOR    },
+    { "ror",  "operator |=",  BORDEBUG_UM_OPERATOR    },
+    { "rplu", "operator +=",  BORDEBUG_UM_OPERATOR    },
+    { "rrsh", "operator >>=", BORDEBUG_UM_OPERATOR    },
+    { "rxor", "operator ^=",  BORDEBUG_UM_OPERATOR    },
+    { "coma", "operator ,",   BORDEBUG_UM_OPERATOR    },
+    { "call", "operator ()",  BORDEBUG_UM_OPERATOR    },
+    { "subs", "operator []",  BORDEBUG_UM_OPERATOR    },
+    { "ind",  "operator *",   BORDEBUG_UM_OPERATOR    },
+    { "adr",  "operator &",   BORDEBUG_UM_OPERATOR    },
+    { "arow", "operator ->",  BORDEBUG_UM_OPERATOR    },
+    { "arwm", "operator ->*", BORDEBUG_UM_OPERATOR    },
+    { "new",  "operator new", BORDEBUG_UM_OPERATOR    },
+    { "dele", "operator delete",   BORDEBUG_UM_OPERATOR },
+    { "nwa",  "operator new[]",    BORDEBUG_UM_OPERATOR },
+    { "dla",  "operator delete[]", BORDEBUG_UM_OPERATOR },
+};
+
+
+/*
+    Parser state for one name.  "text" is the unmangled output so
+    far, which is what is left when a parse error is thrown.
+*/
+
+struct UmParser
+{
+    const char *                p;
+    const char *                end;
+    unsigned int                flags;
+    std::vector<std::string>    args;
+    std::string                 text;
+
+    char    peek() const        { return p < end ? *p : 0; }
+    char    next()              { if (p >= end) UM_FAIL(); return *p++; }
+
+    void    expect(char c)
+    {
+        if  (next() != c)
+            UM_FAIL();
+    }
+
+    std::string     type(bool record);
+    std::string     argList(bool record);
+    std::string     qualified(const char * stop, std::string * last);
+    std::string     component(std::string * bare);
+};
+
+
+/*
+    One qualifier or name: an identifier or a template.  "bare" gets
+    the name without template arguments, as needed for constructors.
+*/
+
+std::string UmParser::component(std::string * bare)
+{
+    if  (peek() == '%')
+    {
+        p++;
+
+        const char  * start = p;
+
+        while (p < end && *p != '$' && *p != '%')
+            p++;
+
+        if  (p == start)
+            UM_FAIL();
+
+        std::string     name(start, p);
+
+        *bare = name;
+        expect('$');
+        flags |= BORDEBUG_UM_TEMPLATE;
+
+        name += '<';
+
+        for (bool first = true; peek() != '%'; first = false)
+        {
+            if  (!first)
+                name += ", ";
+
+            name += type(false);
+        }
+
+        p++;
+
+        if  (name[name.size() - 1] == '>')
+            name += ' ';
+
+        name += '>';
+        return name;
+    }
+
+    const char  * start = p;
+
+    while (p < end && *p != '@' && *p != '$' && *p != '%')
+        p++;
+
+    if  (p == start)
+        UM_FAIL();
+
+    *bare = std::string(start, p);
+    return *bare;
+}
+
+
+/*
+    Qualified name of a class used as a type, up to "stop"
+*/
+
+std::string UmParser::qualified(const char * stop, std::string * last)
+{
+    const char    * saveEnd = end;
+    std::string     result;
+
+    end = stop;
+
+    while (true)
+    {
+        std::string     bare;
+
+        result += component(&bare);
+
+        if  (last)
+            *last = bare;
+
+        if  (p == end)
+            break;
+
+        expect('@');
+        result += "::";
+    }
+
+    end = saveEnd;
+    return result;
+}
+
+
+std::string UmParser::argList(bool record)
+{
+    std::string     result;
+
+    if  (peek() == 'v' && (p + 1 == end || p[1] == '$'))
+    {
+        p++;
+        return result;
+    }
+
+    for (bool first = true; p < end && *p != '$'; first = false)
+    {
+        if  (!first)
+            result += ", ";
+
+        std::string     arg = type(record);
+
+        if  (record)
+        {
+            args.push_back(arg);
+            text += first ? "" : ", ";
+            text += arg;
+        }
+
+        result += arg;
+    }
+
+    return result;
+}
+
+
+std::string UmParser::type(bool record)
+{
+    bool            isConst    = false;
+    bool            isVolatile = false;
+    std::string     result;
+
+    while (peek() == 'x' || peek() == 'w')
+    {
+        if  (next() == 'x')
+            isConst = true;
+        else
+            isVolatile = true;
+    }
+
+    char    c = next();
+
+    switch (c)
+    {
+        case 'p':
+        case 'r':
+        {
+            const char  * declarator = c == 'p' ? "*" : "&";
+
+            if  (peek() == 'q')
+            {
+                p++;
+
+                std::string     params = argList(false);
+
+                expect('$');
+                result = type(false) + " (" + declarator + ")(" + params + ")";
+            }
+            else
+                result = type(false) + " " + declarator;
+
+            if  (isConst)
+                result += " const";
+
+            if  (isVolatile)
+                result += " volatile";
+
+            return result;
+        }
+
+        case 'a':
+        {
+            const char  * start = p;
+
+            while (peek() >= '0' && peek() <= '9')
+                p++;
+
+            std::string     count(start, p);
+
+            expect('$');
+            result = type(false) + " [" + count + "]";
+            break;
+        }
+
+        case 'q':
+        {
+            std::string     params = argList(false);
+
+            expect('$');
+            result = type(false) + " (" + params + ")";
+            break;
+        }
+
+        case 'M':
+        {
+            std::string     cls = type(false);
+
+            result = type(false) + " " + cls + "::*";
+            break;
+        }
+
+        case 't':
+        {
+            char            ref   = next();
+            unsigned int    index = ref >= '1' && ref <= '9' ? ref - '1' :
+                                    ref >= 'a' && ref <= 'z' ? ref - 'a' + 9 : ~0u;
+
+            if  (index >= args.size())
+                UM_FAIL();
+
+            result = args[index];
+            break;
+        }
+
+        case 'u':
+            switch (next())
+            {
+                case 'c':   result = "unsigned char";       break;
+                case 's':   result = "unsigned short";      break;
+                case 'i':   result = "unsigned int";        break;
+                case 'l':   result = "unsigned long";       break;
+                case 'j':   result = "unsigned __int64";    break;
+                default:    UM_FAIL();
+            }
+            break;
+
+        case 'z':
+            expect('c');
+            result = "signed char";
+            break;
+
+        case 'v':   result = "void";        break;
+        case 'c':   result = "char";        break;
+        case 's':   result = "short";       break;
+        case 'i':   result = "int";         break;
+        case 'l':   result = "long";        break;
+        case 'j':   result = "__int64";     break;
+        case 'f':   result = "float";       break;
+        case 'd':   result = "double";      break;
+        case 'g':   result = "long double"; break;
+        case 'o':   result = "bool";        break;
+        case 'b':   result = "wchar_t";     break;
+        case 'e':   result = "...";         break;
+
+        default:
+        {
+            if  (c < '0' || c > '9')
+                UM_FAIL();
+
+            size_t  len = (size_t)(c - '0');
+
+            while (peek() >= '0' && peek() <= '9')
+                len = len * 10 + (size_t)(next() - '0');
+
+            if  (len == 0 || len > (size_t)(end - p))
+                UM_FAIL();
+
+            result = qualified(p + len, 0);
+            break;
+        }
+    }
+
+    if  (isVolatile)
+        result = "volatile " + result;
+
+    if  (isConst)
+        result = "const " + result;
+
+    (void)record;
+    return result;
+}
+
+
+const UmOperator *  bdFindOperator(const char * code, size_t len)
+{
+    for (size_t i = 0; i < sizeof(bdOperators) / sizeof(bdOperators[0]); i++)
+    {
+        if  (strlen(bdOperators[i].code) == len &&
+             memcmp(bdOperators[i].code, code, len) == 0)
+        {
+            return &bdOperators[i];
+        }
+    }
+
+    return 0;
+}
+
+
+void    bdCopyOut(const std::string & text, char * dest, unsigned maxlen, unsigned int * flags)
+{
+    if  (!dest)
+        return;
+
+    if  (maxlen == 0)
+    {
+        *flags |= BORDEBUG_UM_BUFOVRFLW;
+        return;
+    }
+
+    size_t  n = text.size();
+
+    if  (n + 1 > maxlen)
+    {
+        n       = maxlen - 1;
+        *flags |= BORDEBUG_UM_BUFOVRFLW;
+    }
+
+    memcpy(dest, text.data(), n);
+    dest[n] = 0;
+}
+
+
+/*
+    Parse a complete mangled name.  Returns the kind and modifiers,
+    fills in the full text and the qualifier and base name parts.
+*/
+
+unsigned int    bdParse(UmParser    & um,
+                        int           doArgs,
+                        std::string & qual,
+                        std::string & base)
+{
+    unsigned int    kind = BORDEBUG_UM_UNKNOWN;
+
+    um.p++;
+
+    // type descriptor
+    if  (um.end - um.p >= 4 && memcmp(um.p, "$xt$", 4) == 0)
+    {
+        um.p   += 4;
+        um.text = "__tpdsc__ ";
+        base    = um.type(false);
+        um.text += base;
+
+        if  (um.p != um.end)
+            UM_FAIL();
+
+        return BORDEBUG_UM_TPDSC;
+    }
+
+    std::vector<std::string>    names;
+    std::string                 bare;
+
+    // qualifiers and name, or a special name
+    while (true)
+    {
+        if  (um.peek() == '$')
+        {
+            um.p++;
+
+            char    special = um.next();
+
+            if  (special == 'b')
+            {
+                const char  * start = um.p;
+
+                while (um.p < um.end && *um.p != '$')
+                    um.p++;
+
+                const UmOperator  * op = bdFindOperator(start, (size_t)(um.p - start));
+
+                if  (!op || names.empty())
+                    UM_FAIL();
+
+                kind = op->kind;
+
+                if  (op->name)
+                    base = op->name;
+                else
+                    base = std::string(kind == BORDEBUG_UM_DESTRUCTOR ? "~" : "") + bare;
+            }
+            else if (special == 'o')
+            {
+                kind = BORDEBUG_UM_CONVERSION;
+                base = "operator " + um.type(false);
+            }
+            else
+                UM_FAIL();
+
+            um.text += base;
+            break;
+        }
+
+        base = um.component(&bare);
+        um.text += base;
+
+        if  (um.peek() != '@')
+            break;
+
+        um.p++;
+        names.push_back(base);
+        um.text += "::";
+    }
+
+    for (size_t i = 0; i < names.size(); i++)
+        qual += (i ? "::" : "") + names[i];
+
+    if  (!names.empty())
+        kind |= BORDEBUG_UM_QUALIFIED;
+
+    if  (um.p == um.end)
+    {
+        if  ((kind & BORDEBUG_UM_KINDMASK) == BORDEBUG_UM_UNKNOWN)
+            kind |= BORDEBUG_UM_DATA;
+
+        return kind;
+    }
+
+    // function arguments
+    um.expect('$');
+
+    std::string     modifiers;
+
+    while (um.peek() == 'x' || um.peek() == 'w')
+        modifiers += um.next() == 'x' ? " const" : " volatile";
+
+    um.expect('q');
+
+    const char  * convention = "";
+
+    if  (um.peek() == 'q' && um.p + 1 < um.end && (um.p[1] == 'r' || um.p[1] == 's'))
+    {
+        convention = um.p[1] == 'r' ? "__fastcall " : "__stdcall ";
+        um.p += 2;
+    }
+
+    if  ((kind & BORDEBUG_UM_KINDMASK) == BORDEBUG_UM_UNKNOWN)
+        kind |= BORDEBUG_UM_FUNCTION;
+
+    if  (!doArgs)
+        return kind;
+
+    std::string     name = um.text;
+
+    um.text += "(";
+    um.argList(true);
+
+    if  (um.p != um.end)
+        UM_FAIL();
+
+    um.text = convention + name + "(" + um.text.substr(name.size() + 1) + ")" + modifiers;
+    return kind;
+}
+
+
+/*
+    Parse a mangled name into um.text.  A name that can't be parsed
+    gets the line where that was found.  Returns the kind and
+    modifiers.  Throws std::bad_alloc.
+*/
+
+unsigned int    bdParseName(UmParser        & um,
+                            const char      * src,
+                            int               doArgs,
+                            int               showTroubled,
+                            std::string     & qual,
+                            std::string     & base)
+{
+    unsigned int    kind;
+
+    um.p     = src;
+    um.end   = src + strlen(src);
+    um.flags = 0;
+
+    try
+    {
+        kind = bdParse(um, doArgs, qual, base);
+    }
+    catch (const UmError & e)
+    {
+        char    marker[32];
+
+        snprintf(marker, sizeof(marker), showTroubled ? "{%d: " : "{%d}...", e.line);
+
+        um.text += marker;
+
+        if  (showTroubled)
+        {
+            um.text += src;
+            um.text += "}";
+        }
+
+        kind = BORDEBUG_UM_ERROR;
+    }
+
+    return kind | um.flags;
+}
+
+
+/*
+    A part of BorDebugUnmangleBatch, the names one worker unmangles.
+    The names are one after the other in text, each followed by a
+    zero.
+*/
+
+enum
+{
+    UM_BATCH_PART   = 0x400,            // most names for a worker at a time
+    UM_BATCH_LEAST  = 0x40,             // least
+    UM_BATCH_GUESS  = 64,               // bytes of a name, before there are any
+};
+
+
+struct UmBatchPart
+{
+    std::string                 text;
+    std::vector<uint32_t>       ends;
+    std::vector<unsigned int>   kinds;
+    bool                        failed;
+};
+
+
+}   // namespace
+
+
+//---------------------------------------------------------------------
+
+BorDebugUmKind  bdUnmangle(const char * src,
+                           char       * dest,
+                           unsigned     maxlen,
+                           char       * qualP,
+                           char       * baseP,
+                           int          doArgs,
+                           int          showTroubled)
+{
+    if  (!src || src[0] != '@')
+    {
+        if  (src && dest)
+        {
+            unsigned int    ignored = 0;
+
+            bdCopyOut(src, dest, maxlen, &ignored);
+        }
+
+        return BORDEBUG_UM_NOT_MANGLED;
+    }
+
+    if  (!dest)
+        return BORDEBUG_UM_ERROR;
+
+    UmParser        um;
+    std::string     qual;
+    std::string     base;
+    unsigned int    kind;
+
+    try
+    {
+        kind = bdParseName(um, src, doArgs, showTroubled, qual, base);
+
+        bdCopyOut(um.text, dest, maxlen, &kind);
+
+        if  (qualP)
+            strcpy(qualP, qual.c_str());
+
+        if  (baseP)
+            strcpy(baseP, base.c_str());
+    }
+    catch (const std::bad_alloc &)
+    {
+        dest[0] = 0;
+        return BORDEBUG_UM_ERROR;
+    }
+
+    return (BorDebugUmKind)kind;
+}
+
+
+unsigned int    bdUnmangleString(const char   * src,
+                                 int            doArgs,
+                                 int            showTroubled,
+                                 std::string  & out)
+{
+    if  (!src || src[0] != '@')
+    {
+        out = src ? src : "";
+        return BORDEBUG_UM_NOT_MANGLED;
+    }
+
+    UmParser        um;
+    std::string     qual;
+    std::string     base;
+    unsigned int    kind = bdParseName(um, src, doArgs, showTroubled, qual, base);
+
+    out.swap(um.text);
+    return kind;
+}
+
+
+BorDebugUmKind  BorDebugUnmangle(char   *       src,
+                                 char   *       dest,
+                                 unsigned       maxlen,
+                                 char   *       qualP,
+                                 char   *       baseP,
+                                 int            doArgs)
+{
+    return bdUnmangle(src, dest, maxlen, qualP, baseP, doArgs,
+                      getenv("SHOW_TROUBLED_NAME") != 0);
+}
+
+
+BorDebugUmKind  BorDebugUnmangleEx(const char   * src,
+                                   char         * dest,
+                                   unsigned       maxlen,
+                                   char         * qualP,
+                                   char         * baseP,
+                                   int            doArgs,
+                                   int            showTroubled)
+{
+    return bdUnmangle(src, dest, maxlen, qualP, baseP, doArgs, showTroubled);
+}
+
+
+unsigned int    BorDebugUnmangleBatch(const char * const  * src,
+                                      unsigned int          count,
+                                      int                   doArgs,
+                                      int                   showTroubled,
+                                      char                * buf,
+                                      unsigned int          bufLen,
+                                      unsigned int        * starts,
+                                      BorDebugUmKind      * kinds)
+{
+    unsigned int    done = 0;
+    unsigned int    used = 0;
+
+    if  (!src || !buf || !starts)
+        return 0;
+
+    // A few parts for each thread at a time.  So that little is done
+    // for names that don't fit in buf, no more names than fit at the
+    // length so far, and a quarter.
+    size_t  threads = bdThreadCount();
+
+    while (done < count)
+    {
+        size_t  names = count - done;
+        size_t  room  = bufLen - used;
+        size_t  fit   = done ? room / (used / done + 1) : room / UM_BATCH_GUESS;
+
+        fit += fit / 4 + 1;
+
+        if  (names > fit)
+            names = fit;
+
+        if  (names > threads * 4 * UM_BATCH_PART)
+            names = threads * 4 * UM_BATCH_PART;
+
+        size_t  parts = (names + UM_BATCH_PART - 1) / UM_BATCH_PART;
+
+        if  (parts < threads && names >= threads * UM_BATCH_LEAST)
+            parts = threads;
+
+        size_t                      each = (names + parts - 1) / parts;
+        std::vector<UmBatchPart>    batch;
+
+        try
+        {
+            batch.resize(parts);
+        }
+        catch (const std::bad_alloc &)
+        {
+            return done;
+        }
+
+        unsigned int    first = done;
+
+        bdParallelFor(parts, [&](size_t k)
+        {
+            UmBatchPart   & part = batch[k];
+            size_t          from = first + k * each;
+            size_t          to   = from + each < first + names ? from + each : first + names;
+
+            part.failed = false;
+
+            try
+            {
+                std::string     one;
+
+                for (size_t i = from; i < to; i++)
+                {
+                    part.kinds.push_back(bdUnmangleString(src[i], doArgs, showTroubled, one));
+                    part.text.append(one.c_str(), one.size() + 1);
+                    part.ends.push_back((uint32_t)part.text.size());
+                }
+            }
+            catch (const std::bad_alloc &)
+            {
+                part.failed = true;
+            }
+        });
+
+        for (size_t k = 0; k < parts; k++)
+        {
+            const UmBatchPart   & part  = batch[k];
+            uint32_t              start = 0;
+
+            if  (part.failed)
+                return done;
+
+            for (size_t j = 0; j < part.ends.size(); j++)
+            {
+                uint32_t    len = part.ends[j] - start;
+
+                if  (len > bufLen - used)
+                    return done;
+
+                memcpy(buf + used, part.text.data() + start, len);
+                starts[done] = used;
+
+                if  (kinds)
+                    kinds[done] = (BorDebugUmKind)part.kinds[j];
+
+                used += len;
+                start = part.ends[j];
+                done++;
+            }
+        }
+    }
+
+    return done;
+}
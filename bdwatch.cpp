@@ -0,0 +1,247 @@
+//---------------------------------------------------------------------
+
+/*
+    File watcher, for BORDEBUG_REGISTER_WATCH
+
+    One inotify instance and one thread for the whole process.  The
+    directory of a file is watched rather than the file itself, so a
+    new file renamed over the old one is noticed as well as one that
+    is rewritten in place.  A file counts as changed when a writer
+    closes it, or when something is renamed to its name; a file that
+    is only created is still being written.
+*/
+
+//---------------------------------------------------------------------
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#include "bdpriv.h"
+
+
+enum
+{
+    BD_WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO,
+    BD_WATCH_BUFFER = 0x4000,
+};
+
+
+struct BdWatchDir
+{
+    std::string                                     dir;
+    std::unordered_map<std::string, unsigned int>   names;      // -> number of watches
+};
+
+
+struct BdWatcher
+{
+    std::mutex                              lock;
+    int                                     fd = -1;
+    bool                                    failed = false;
+    std::unordered_map<int, BdWatchDir>     dirs;       // by watch descriptor
+};
+
+
+// Never freed, the thread may still use it while the process exits
+static BdWatcher & bdWatcher()
+{
+    static BdWatcher    * watcher = new BdWatcher();
+
+    return *watcher;
+}
+
+
+static void bdSplitPath(const std::string & path, std::string & dir, std::string & name)
+{
+    size_t  slash = path.rfind('/');
+
+    dir  = path.substr(0, slash ? slash : 1);
+    name = path.substr(slash + 1);
+}
+
+
+/*
+    The watcher thread.  Events for one file tend to come in bursts,
+    so each batch only reports a file once.
+*/
+
+static void bdWatchThread(int fd)
+{
+    BdWatcher                         & w = bdWatcher();
+    alignas(struct inotify_event) char  buf[BD_WATCH_BUFFER];
+
+    while (true)
+    {
+        ssize_t     got = read(fd, buf, sizeof(buf));
+
+        if  (got < 0 && errno == EINTR)
+            continue;
+
+        if  (got <= 0)
+            return;
+
+        std::set<std::string>   changed;
+
+        {
+            std::lock_guard<std::mutex> hold(w.lock);
+
+            for (ssize_t pos = 0; pos < got; )
+            {
+                const struct inotify_event * event =
+                    reinterpret_cast<const struct inotify_event *>(buf + pos);
+
+                pos += sizeof(struct inotify_event) + event->len;
+
+                auto    found = w.dirs.find(event->wd);
+
+                if  (found == w.dirs.end())
+                    continue;
+
+                // the directory went away, and with it the watch
+                if  (event->mask & IN_IGNORED)
+                {
+                    w.dirs.erase(found);
+                    continue;
+                }
+
+                if  (event->len == 0 || !found->second.names.count(event->name))
+                    continue;
+
+                try
+                {
+                    changed.insert(found->second.dir + "/" + event->name);
+                }
+                catch (const std::bad_alloc &)
+                {
+                }
+            }
+        }
+
+        for (auto it = changed.begin(); it != changed.end(); ++it)
+            bdPoolFileChanged(*it);
+    }
+}
+
+
+// The inotify instance, started on first use.  The caller holds
+// w.lock.
+static bool bdWatchStart(BdWatcher & w)
+{
+    if  (w.fd >= 0)
+        return true;
+
+    if  (w.failed)
+        return false;
+
+    int fd = inotify_init1(IN_CLOEXEC);
+
+    if  (fd >= 0)
+    {
+        try
+        {
+            // like the worker pool, it stays until the process ends
+            std::thread(bdWatchThread, fd).detach();
+
+            w.fd = fd;
+            return true;
+        }
+        catch (const std::system_error &)
+        {
+            close(fd);
+        }
+    }
+
+    w.failed = true;
+    return false;
+}
+
+
+//---------------------------------------------------------------------
+
+std::string bdWatchPath(const char * fileName)
+{
+    std::string     dir;
+    std::string     name;
+    char            real[PATH_MAX];
+
+    bdSplitPath(fileName, dir, name);
+
+    if  (std::string(fileName).find('/') == std::string::npos)
+        dir = ".";
+
+    if  (name.empty() || !realpath(dir.c_str(), real))
+        return std::string();
+
+    dir = real;
+
+    return dir == "/" ? dir + name : dir + "/" + name;
+}
+
+
+bool    bdWatchAdd(const std::string & path)
+{
+    BdWatcher                 & w = bdWatcher();
+    std::lock_guard<std::mutex> hold(w.lock);
+    std::string                 dir;
+    std::string                 name;
+
+    if  (!bdWatchStart(w))
+        return false;
+
+    bdSplitPath(path, dir, name);
+
+    // the same directory always gets the same descriptor
+    int wd = inotify_add_watch(w.fd, dir.c_str(), BD_WATCH_EVENTS);
+
+    if  (wd < 0)
+        return false;
+
+    BdWatchDir  & watched = w.dirs[wd];
+
+    watched.dir = dir == "/" ? std::string() : dir;
+    watched.names[name]++;
+
+    return true;
+}
+
+
+void    bdWatchRemove(const std::string & path)
+{
+    BdWatcher                 & w = bdWatcher();
+    std::lock_guard<std::mutex> hold(w.lock);
+    std::string                 dir;
+    std::string                 name;
+
+    bdSplitPath(path, dir, name);
+
+    for (auto it = w.dirs.begin(); it != w.dirs.end(); ++it)
+    {
+        BdWatchDir  & watched = it->second;
+
+        if  ((watched.dir.empty() ? "/" : watched.dir) != dir)
+            continue;
+
+        auto    found = watched.names.find(name);
+
+        if  (found != watched.names.end() && --found->second == 0)
+            watched.names.erase(found);
+
+        if  (watched.names.empty())
+        {
+            inotify_rm_watch(w.fd, it->first);
+            w.dirs.erase(it);
+        }
+
+        return;
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef BORDEBUG_H
 #define BORDEBUG_H
 
+#include <stddef.h>
+
 #ifdef  __cplusplus
 extern  "C"
 {
@@ -91,7 +93,24 @@ extern  "C"
     might have a file with no debug info.
 
         BorDebugRegisterFile
+        BorDebugRegisterFileEx
+        BorDebugRegisterMemory
+        BorDebugRegisterIO
+        BorDebugRegisterFiles
+        BorDebugLoadFiles
+        BorDebugReregisterFile
         BorDebugUnregisterFile
+        BorDebugIndexReady
+
+    To keep files registered between uses, get them from the pool:
+
+        BorDebugPoolAcquire
+        BorDebugPoolRelease
+
+    To only find out whether a file has debug info, probe it:
+
+        BorDebugProbeFile
+        BorDebugProbeFiles
 
 
     Step 2:
@@ -159,6 +178,10 @@ extern  "C"
         BorDebugNamesTotalNames
         BorDebugNameIndexToUnmangledName
         BorDebugNameIndexToName
+        BorDebugNameIndexToNameView
+        BorDebugNameIndexesToNames
+        BorDebugNameIndexToUnmangledNameView
+        BorDebugUnmangleNames
         BorDebugRegIndexToName
 
 */
@@ -380,7 +403,7 @@ enum    BORDEBUG_leaf900s
     To allow some flexibility here, there are 3 possibilities:
 
     - set skipNames to non-zero.  This means the sstNames section
-      is not scanned, and no name index table is build, and no
+      is not scanned, and no name index table is built, and no
       names are cached at all.  This also means that you can't
       go from a name index to a string representation.  You will
       always get a blank string back from the nameIndex conversion
@@ -389,7 +412,7 @@ enum    BORDEBUG_leaf900s
 
     - set skipNames to zero, and set cacheNames to zero.  This
       means that the sstNames section is scanned and an index
-      table is build. The sstNames section is not cached though
+      table is built. The sstNames section is not cached though
       so each lookup of a name will cause a SEEK and a READ
       from the file, which is slow.  This option costs some
       time to build the index table, and takes up space for
@@ -397,11 +420,14 @@ enum    BORDEBUG_leaf900s
       save space because the sstNames section is not cached.
 
     - set skipNames to zero, and set cacheNames to non-zero.
-      The name index table is build and the whole sstNames
+      The name index table is built and the whole sstNames
       section stays also in memory.  Name accesses are very
       fast, but this is at the expense of the memory the
       sstNames takes up.
 
+    The name index table is built the first time a name is
+    needed, not during the registration.
+
 
     If you want you can cache your own names.  You can get the
     starting offset and size of the sstNames section from
@@ -441,13 +467,352 @@ BorDebugCookie  BorDebugRegisterFile(const char   * fileName,
                                      unsigned int * failure);
 
 
+/*
+
+    BorDebugRegisterFileEx
+
+
+    Same as BorDebugRegisterFile, with the choices passed as a
+    combination of BORDEBUG_REGISTER_XXXX options.
+
+    BORDEBUG_REGISTER_SKIPNAMES and BORDEBUG_REGISTER_CACHENAMES
+    are the skipNames and cacheNames arguments of
+    BorDebugRegisterFile.
+
+    BORDEBUG_REGISTER_MAP maps the whole file read-only into
+    memory, and all API's read straight from the mapping.  There
+    is no SEEK and READ per access, and no copy of the sstNames
+    section is made, so BORDEBUG_REGISTER_CACHENAMES is ignored.
+    The kernel is told how each subsection is accessed: symbol
+    and line number subsections sequentially, sstGlobalTypes and
+    sstNames randomly.  If the file can't be mapped, the normal
+    read mode is used.
+
+    Registration only reads the subsection directory.  The
+    sstGlobalTypes and sstNames indexes are built the first time
+    an API needs them.  BORDEBUG_REGISTER_EAGER builds them during
+    registration instead, so a damaged sstGlobalTypes or sstNames
+    makes the registration fail rather than leaving the index
+    empty.
+
+    BORDEBUG_REGISTER_ASYNC returns as soon as the subsection
+    directory is read, and builds the sstGlobalTypes and sstNames
+    indexes on a worker thread (see BorDebugSetThreadCount).  The
+    subsection, module, symbol and line number API's can be used
+    right away.  An API that needs an index which is still being
+    built waits for it; use BorDebugIndexReady to find out without
+    waiting.  With only one thread there is no worker, and the
+    indexes are built on first use as without this option.
+    BORDEBUG_REGISTER_ASYNC is ignored with BORDEBUG_REGISTER_EAGER.
+
+    BORDEBUG_REGISTER_INDEXCACHE keeps the sstGlobalTypes and
+    sstNames indexes in a sidecar file, see BorDebugSetIndexCacheDir.
+    When the indexes are needed and the sidecar matches the file,
+    the sidecar is mapped instead of building the indexes.  If not,
+    both indexes are built and the sidecar is written.  The sidecar
+    matches as long as the file size, the sstGlobalTypes signature
+    and count, the sstNames size and count, and the time stamps of
+    all modules are the same.
+
+    BORDEBUG_REGISTER_SHAREDINDEX does the same in a named shared
+    memory object instead of a sidecar file, so that many processes
+    working on the same file share one copy of the indexes.  The
+    first process builds the indexes into the object, the others
+    wait for it and map the object read-only, which costs next to
+    nothing.  Registrations with different
+    BORDEBUG_REGISTER_SKIPMODULES or BORDEBUG_REGISTER_SKIPTYPES
+    options use objects of their own.  The object stays until
+    BorDebugRemoveSharedIndex is called or the system restarts.
+    With both options the shared memory object is tried first, and
+    when the sidecar is used, the shared object is filled from it.
+
+    BORDEBUG_REGISTER_INDEXCACHE and BORDEBUG_REGISTER_SHAREDINDEX
+    have no effect with BORDEBUG_REGISTER_SKIPNAMES, or for an
+    image registered with BorDebugRegisterMemory.
+
+    The BORDEBUG_REGISTER_SKIPXXXX options leave subsections out
+    altogether, for programs that never need them:
+
+        SKIPMODULES     sstModule
+        SKIPSYMBOLS     sstAlignSym
+        SKIPLINES       sstSrcModule
+        SKIPGLOBALSYMS  sstGlobalSym and sstGlobalPub
+        SKIPTYPES       sstGlobalTypes
+
+    A skipped subsection is not in the subsection list returned
+    by BorDebugSubSectionCount and BorDebugSubSection.  Without
+    sstGlobalTypes every type index is invalid.  With
+    BORDEBUG_REGISTER_SKIPNAMES the sstNames subsection stays in
+    the list, so you can still cache your own names.
+
+    Registering a file that is registered already gives a cookie
+    of its own, but when the options are the same, apart from
+    BORDEBUG_REGISTER_EAGER and BORDEBUG_REGISTER_ASYNC, both share
+    one sstGlobalTypes index, one sstNames index and one copy of
+    sstNames.  Whichever registration needs an index first builds
+    it for all of them, and it stays until the last of them is
+    unregistered.  A file is the same when device, inode, size and
+    modification time are, so another path or a hard link to the
+    file shares as well, and a file that was rewritten doesn't.
+
+    BORDEBUG_REGISTER_WATCH only has an effect with
+    BorDebugPoolAcquire, see there.
+
+
+    fileName:   the name of the file with debug info
+    options:    BORDEBUG_REGISTER_XXXX values or'ed together
+    failure:    will be set on failure, as in BorDebugRegisterFile
+
+*/
+
+enum
+{
+    BORDEBUG_REGISTER_SKIPNAMES       = 0x00000001,
+    BORDEBUG_REGISTER_CACHENAMES      = 0x00000002,
+    BORDEBUG_REGISTER_MAP             = 0x00000004,
+    BORDEBUG_REGISTER_EAGER           = 0x00000008,
+
+    BORDEBUG_REGISTER_SKIPMODULES     = 0x00000010,
+    BORDEBUG_REGISTER_SKIPSYMBOLS     = 0x00000020,
+    BORDEBUG_REGISTER_SKIPLINES       = 0x00000040,
+    BORDEBUG_REGISTER_SKIPGLOBALSYMS  = 0x00000080,
+    BORDEBUG_REGISTER_SKIPTYPES       = 0x00000100,
+
+    BORDEBUG_REGISTER_ASYNC           = 0x00000200,
+    BORDEBUG_REGISTER_INDEXCACHE      = 0x00000400,
+    BORDEBUG_REGISTER_SHAREDINDEX     = 0x00000800,
+    BORDEBUG_REGISTER_WATCH           = 0x00001000,
+};
+
+
+BorDebugCookie  BorDebugRegisterFileEx(const char   * fileName,
+                                       unsigned int   options,
+                                       unsigned int * failure);
+
+
+/*
+
+    BorDebugRegisterMemory
+
+
+    Register debug info that is already in memory.  The image is
+    the complete contents of a .tds, .exe or .dll file, and is
+    read in place: it must stay valid and unchanged until
+    BorDebugUnregisterFile is called for the returned cookie.
+    The cookie works with all the API's below, like a cookie
+    from BorDebugRegisterFile.
+
+    BORDEBUG_REGISTER_MAP and BORDEBUG_REGISTER_CACHENAMES have
+    no effect here, all names are in memory already.  Registrations
+    of the same image, at the same address and with the same size,
+    share their indexes as described at BorDebugRegisterFileEx.
+
+
+    image:      start of the file image
+    size:       size of the file image in bytes
+    options:    BORDEBUG_REGISTER_XXXX values or'ed together
+    failure:    will be set on failure, as in BorDebugRegisterFile
+
+*/
+
+BorDebugCookie  BorDebugRegisterMemory(const void   * image,
+                                       size_t         size,
+                                       unsigned int   options,
+                                       unsigned int * failure);
+
+
+/*
+
+    BorDebugRegisterIO
+
+
+    Register debug info that is read through your own functions,
+    for files that don't live in a plain file: an object store, an
+    archive, or a cache of your own.  Like BorDebugRegisterMemory,
+    the data can hold a .tds as well as an .exe or .dll file.
+
+
+    BorDebugIO
+
+    read:       read "size" bytes at "offset" into "buffer".  Returns
+                the number of bytes read, which may be less than
+                asked for; it is then called again for the rest.
+                0 means the data can't be read.
+    size:       total size of the data in bytes
+    map:        optional, can be NULL.  Returns a pointer to all of
+                the data in memory, which must stay valid until
+                close is called, or NULL.  When it returns a pointer
+                the data is read in place, as by BorDebugRegisterMemory,
+                and read is not used.
+    close:      optional, can be NULL.  Called by
+                BorDebugUnregisterFile, or when the registration
+                fails, as the last call for this context.
+
+    All functions get the "context" passed to BorDebugRegisterIO.
+    With BORDEBUG_REGISTER_EAGER or BORDEBUG_REGISTER_ASYNC, read
+    can be called from several threads at once.
+
+    BORDEBUG_REGISTER_MAP has no effect here, use the map function
+    instead.  BORDEBUG_REGISTER_CACHENAMES keeps a copy of sstNames
+    as with a file, unless the data is mapped.
+
+
+    io:         the functions to use, copied during the call
+    context:    passed to each of the functions
+    options:    BORDEBUG_REGISTER_XXXX values or'ed together
+    failure:    will be set on failure, as in BorDebugRegisterFile
+
+*/
+
+typedef struct
+{
+    size_t                  (*read)(void               * context,
+                                    unsigned long long   offset,
+                                    void               * buffer,
+                                    size_t               size);
+    unsigned long long      (*size)(void * context);
+    const void *            (*map)(void * context);
+    void                    (*close)(void * context);
+}
+        BorDebugIO;
+
+
+BorDebugCookie  BorDebugRegisterIO(const BorDebugIO * io,
+                                   void             * context,
+                                   unsigned int       options,
+                                   unsigned int     * failure);
+
+
+/*
+
+    BorDebugRegisterFiles
+
+
+    Register a number of files at once, spread over the worker
+    threads (see BorDebugSetThreadCount).  Each file is registered
+    as by BorDebugRegisterFileEx.  With BORDEBUG_REGISTER_EAGER,
+    the type and name indexes of a file are built side by side
+    as well.
+
+
+    fileNames:  the names of the files with debug info
+    count:      number of files
+    options:    BORDEBUG_REGISTER_XXXX values or'ed together
+    cookies:    receives the registerCookie of each file, 0 on failure
+    failures:   receives the failure code of each file, can be NULL
+
+*/
+
+void    BorDebugRegisterFiles(const char * const  * fileNames,
+                              unsigned int          count,
+                              unsigned int          options,
+                              BorDebugCookie      * cookies,
+                              unsigned int        * failures);
+
+
+/*
+
+    BorDebugLoadFiles
+
+
+    Register a large number of files at once, for indexing whole
+    build trees.  Each file is registered as by
+    BorDebugRegisterFileEx with BORDEBUG_REGISTER_EAGER, but rather
+    than reading one file after another, the reads of all files are
+    queued together: first the debug headers and subsection
+    directories, then the sstNames and sstGlobalTypes sections, with
+    many reads in flight through io_uring.  Where io_uring isn't
+    there, or not allowed, the reads are spread over the worker
+    threads instead.  The indexes of the files are built on the
+    worker threads as their sections come in.
+
+    A few hundred files are worked on at a time, and their sections
+    are held in memory only until their indexes are built.
+    BORDEBUG_REGISTER_ASYNC is ignored, and with
+    BORDEBUG_REGISTER_MAP it works like BorDebugRegisterFiles.
+
+
+    fileNames:  the names of the files with debug info
+    count:      number of files
+    options:    BORDEBUG_REGISTER_XXXX values or'ed together
+    cookies:    receives the registerCookie of each file, 0 on failure
+    failures:   receives the failure code of each file, can be NULL
+
+*/
+
+void    BorDebugLoadFiles(const char * const  * fileNames,
+                          unsigned int          count,
+                          unsigned int          options,
+                          BorDebugCookie      * cookies,
+                          unsigned int        * failures);
+
+
+/*
+
+    BorDebugReregisterFile
+
+
+    Register a file again after it was rebuilt, while the cookie of
+    the previous build is still registered.  Works like
+    BorDebugRegisterFileEx with BORDEBUG_REGISTER_EAGER, but the
+    sstNames index is only built for the names that changed: where
+    the start and the end of the sstNames section are the same as in
+    the previous build, the index entries are taken from the previous
+    cookie, moved by the change in size, and only the names in
+    between are looked at.  The text is compared to find out what is
+    the same, a time stamp alone is not trusted.  When the previous
+    build never built its sstNames index, it is built as usual.
+
+    The previous cookie is not changed, unregister it when you are
+    done with it.  A matching index cache (BORDEBUG_REGISTER_INDEXCACHE
+    or BORDEBUG_REGISTER_SHAREDINDEX) or another registration of the
+    new file that has its indexes already is used as usual, and then
+    nothing is taken from the previous cookie.
+
+
+    BorDebugReindexInfo
+
+    modules:        sstModule subsections in the new file
+    changedModules: of those, the ones with another time stamp than
+                    the module at the same position in the previous
+                    build, or with no module there
+    names:          names in the new sstNames index
+    namesReused:    index entries taken from the previous cookie
+
+
+    previousCookie: the cookie of the previous build, can be NULL
+    fileName:       the name of the rebuilt file
+    options:        BORDEBUG_REGISTER_XXXX values or'ed together
+    info:           will be filled in on success, can be NULL
+    failure:        will be set on failure, as in BorDebugRegisterFile
+
+*/
+
+typedef struct
+{
+    unsigned int    modules;
+    unsigned int    changedModules;
+    unsigned int    names;
+    unsigned int    namesReused;
+}
+        BorDebugReindexInfo;
+
+
+BorDebugCookie  BorDebugReregisterFile(BorDebugCookie        previousCookie,
+                                       const char          * fileName,
+                                       unsigned int          options,
+                                       BorDebugReindexInfo * info,
+                                       unsigned int        * failure);
+
+
 /*
 
     BorDebugUnregisterFile
 
 
     Unregister a file that was previously registered.
-    This will free up any memory used.
+    This will free up any memory used.  An index that is being
+    built in the background is finished first.
 
 */
 
@@ -455,6 +820,442 @@ BorDebugCookie  BorDebugRegisterFile(const char   * fileName,
 void    BorDebugUnregisterFile(BorDebugCookie registerCookie);
 
 
+/*
+
+    BorDebugSetIndexCacheDir
+
+
+    Set where BORDEBUG_REGISTER_INDEXCACHE keeps its sidecar files.
+    By default, or when dir is NULL or empty, the sidecar of a file
+    is the file name with ".bdx" appended, next to the file.  With a
+    directory, all sidecars go into that directory, named after the
+    file and a hash of its full path.  The directory must exist.
+    Registrations with BORDEBUG_REGISTER_SKIPMODULES or
+    BORDEBUG_REGISTER_SKIPTYPES get sidecars of their own, with "-"
+    and those options in hex before the ".bdx".
+    When a sidecar can't be written the indexes are simply built
+    again the next time.
+
+    dir:    the cache directory, or NULL
+
+*/
+
+void    BorDebugSetIndexCacheDir(const char * dir);
+
+
+/*
+
+    BorDebugRemoveSharedIndex
+
+
+    Remove the shared memory objects that BORDEBUG_REGISTER_SHAREDINDEX
+    made for a file.  Processes that have them mapped keep using them,
+    the next registration builds a new one.
+
+    fileName:   the name of the file, as it was registered
+
+*/
+
+void    BorDebugRemoveSharedIndex(const char * fileName);
+
+
+/*
+
+    BorDebugIndexReady
+
+
+    Find out whether indexes are built, without waiting for them.
+    Only useful with BORDEBUG_REGISTER_ASYNC, otherwise an index is
+    either built already or built by the API that first needs it.
+
+    registerCookie: the cookie of the file
+    indexes:        BORDEBUG_INDEX_XXXX values or'ed together
+
+    return:         1 if all of the indexes are built, 0 if not
+
+*/
+
+enum
+{
+    BORDEBUG_INDEX_TYPES    = 0x00000001,
+    BORDEBUG_INDEX_NAMES    = 0x00000002,
+};
+
+
+int     BorDebugIndexReady(BorDebugCookie registerCookie, unsigned int indexes);
+
+
+
+
+//---------------------------------------------------------------------
+
+/*
+
+    Probing
+
+
+    Probing a file only reads the debug header and the subsection
+    directory, and the time stamps of the modules.  No index is
+    built, and the file is closed again before the call returns.
+    This is the quick way to find out whether a file has usable
+    debug info.
+
+
+    BorDebugProbeInfo
+
+    failure:            as in BorDebugRegisterFile, 0 if the file has
+                        usable debug info.  The other fields are only
+                        valid when failure is 0.
+    signature:          debug signature, 'FB09' or 'FB0A'
+    dirOffset:          file offset of the subsection directory
+    subSectionCount:    total number of subsections
+    moduleCount:        number of sstModule subsections
+    alignSymCount:      number of sstAlignSym subsections
+    srcModuleCount:     number of sstSrcModule subsections
+    globalSymCount:     number of sstGlobalSym and sstGlobalPub
+                        subsections
+    globalTypesCount:   number of sstGlobalTypes subsections
+    namesCount:         number of sstNames subsections
+    newestTimeStamp:    newest time stamp of all modules
+
+*/
+
+typedef struct
+{
+    unsigned int        failure;
+    unsigned int        signature;
+    unsigned long long  dirOffset;
+    unsigned int        subSectionCount;
+    unsigned int        moduleCount;
+    unsigned int        alignSymCount;
+    unsigned int        srcModuleCount;
+    unsigned int        globalSymCount;
+    unsigned int        globalTypesCount;
+    unsigned int        namesCount;
+    unsigned int        newestTimeStamp;
+}
+        BorDebugProbeInfo;
+
+
+/*
+
+    BorDebugProbeFile
+
+
+    Probe one file.
+
+    fileName:       the name of the file, as in BorDebugRegisterFile
+    info:           receives the details of the file
+    timeStamps:     receives the time stamp of each module in the
+                    order of the sstModule subsections, can be NULL
+    maxTimeStamps:  size of the timeStamps array
+
+    return:         the failure code, same as info->failure
+
+*/
+
+unsigned int    BorDebugProbeFile(const char         * fileName,
+                                  BorDebugProbeInfo  * info,
+                                  unsigned int       * timeStamps,
+                                  unsigned int         maxTimeStamps);
+
+
+/*
+
+    BorDebugProbeFiles
+
+
+    Probe a number of files at once, spread over the worker threads
+    (see BorDebugSetThreadCount).
+
+    fileNames:  the names of the files
+    count:      number of files
+    infos:      receives the details of each file
+
+*/
+
+void    BorDebugProbeFiles(const char * const  * fileNames,
+                           unsigned int          count,
+                           BorDebugProbeInfo   * infos);
+
+
+
+
+//---------------------------------------------------------------------
+
+/*
+
+    File pool
+
+
+    For programs that need the same files over and over, like a
+    symbol server.  A file acquired from the pool stays registered
+    after it is released, and the next BorDebugPoolAcquire for the
+    same file name and options hands out the same cookie again.
+    Files that are not in use are unregistered, least recently
+    used first, when the pool is over its limits.  A file that was
+    dropped is simply registered again on the next request.
+
+    Cookies are reference counted: every BorDebugPoolAcquire needs
+    a BorDebugPoolRelease.  Don't call BorDebugUnregisterFile for a
+    cookie from the pool.  All pool functions can be called from
+    several threads at once; a cookie can only be used by several
+    threads at once as far as the rest of the API allows it.
+
+
+    BorDebugPoolAcquire
+
+
+    Get a registered file from the pool, registering it with
+    BorDebugRegisterFileEx if it isn't there.  Failures are not
+    kept: the next request tries again.
+
+    With BORDEBUG_REGISTER_WATCH the pool watches the file with
+    inotify.  When it is rewritten, or another file is renamed over
+    it, the pool registers it again with BorDebugReregisterFile in
+    the background, and from then on hands out the new cookie.
+    Whoever holds the old cookie keeps using the old version of the
+    file, which is only unregistered when the last of them releases
+    it.  So acquire the file for each piece of work, rather than
+    once for the life of the program, to pick up new versions.  A
+    version that can't be registered, like a file that is only half
+    written, is skipped and the old one stays.  Without inotify the
+    option has no effect.
+
+    fileName:   the name of the file, as for BorDebugRegisterFileEx
+    options:    BORDEBUG_REGISTER_XXXX values, part of the lookup
+    failure:    will be set on failure, as in BorDebugRegisterFile
+
+
+    BorDebugPoolRelease
+
+
+    Hand back a cookie from BorDebugPoolAcquire.
+
+
+    BorDebugPoolSetLimits
+
+
+    Set how many files, and how many bytes of memory for all files
+    together, the pool keeps.  0 means no limit.  Files in use count
+    but are never dropped, so the pool can go over its limits while
+    they are.  The default is 64 files and no byte limit.
+
+
+    BorDebugPoolFlush
+
+
+    Unregister all files that are not in use.
+
+
+    BorDebugPoolGetStats
+
+
+    files:      files in the pool
+    inUse:      files acquired and not yet released
+    bytes:      memory of all files, as of their last release
+    hits:       requests served by a file in the pool
+    misses:     requests that had to register the file
+    evictions:  files dropped to stay within the limits
+    reloads:    new versions of watched files swapped in
+    retired:    old versions still held by someone
+
+*/
+
+typedef struct
+{
+    unsigned int        files;
+    unsigned int        inUse;
+    unsigned long long  bytes;
+    unsigned long long  hits;
+    unsigned long long  misses;
+    unsigned long long  evictions;
+    unsigned long long  reloads;
+    unsigned int        retired;
+}
+        BorDebugPoolStats;
+
+
+BorDebugCookie  BorDebugPoolAcquire(const char   * fileName,
+                                    unsigned int   options,
+                                    unsigned int * failure);
+
+void    BorDebugPoolRelease(BorDebugCookie registerCookie);
+
+void    BorDebugPoolSetLimits(unsigned int maxFiles, unsigned long long maxBytes);
+
+void    BorDebugPoolFlush(void);
+
+void    BorDebugPoolGetStats(BorDebugPoolStats * stats);
+
+
+
+
+//---------------------------------------------------------------------
+
+/*
+
+    Worker threads
+
+
+    Some work is spread over a pool of worker threads, like
+    BorDebugRegisterFiles and building indexes during a
+    registration with BORDEBUG_REGISTER_EAGER or in the background
+    with BORDEBUG_REGISTER_ASYNC.  The threads are started the
+    first time there is such work.
+
+
+    BorDebugSetThreadCount
+
+
+    Set the number of threads that work on one request, including
+    the calling thread.  1 means all work is done on the calling
+    thread, 0 means one thread per CPU, which is the default.
+    This may be called while other calls are in progress: work
+    that was queued already still runs, and new work gets the new
+    number of threads.
+
+
+    BorDebugThreadCount
+
+
+    return: number of threads that work on one request
+
+*/
+
+void            BorDebugSetThreadCount(unsigned int threads);
+
+unsigned int    BorDebugThreadCount(void);
+
+
+
+
+//---------------------------------------------------------------------
+
+/*
+
+    Memory
+
+
+    All memory of a registered file comes from an arena of its own,
+    which BorDebugUnregisterFile gives back in one go.  The arena in
+    turn gets its memory in large chunks from an allocator, malloc
+    and free by default.
+
+
+    BorDebugAllocator
+
+    alloc:      allocate "size" bytes, aligned as by malloc, or
+                return NULL
+    free:       give back a block from alloc, "size" is the size
+                that was asked for
+    context:    passed to alloc and free
+
+
+    BorDebugSetAllocator
+
+
+    Set the allocator for the files registered from now on.  Files
+    registered before keep using the allocator they started with.
+    NULL goes back to malloc and free.  Both functions may be called
+    from several threads at once.
+
+*/
+
+typedef struct
+{
+    void *      (*alloc)(void * context, size_t size);
+    void        (*free)(void * context, void * block, size_t size);
+    void *      context;
+}
+        BorDebugAllocator;
+
+
+void    BorDebugSetAllocator(const BorDebugAllocator * allocator);
+
+
+/*
+
+    BorDebugSetMemoryBudget
+
+
+    Set a ceiling for the memory a registered file uses for caches
+    that can be rebuilt from the file.  Today that is the copy of the
+    sstNames section and the unmangled names.  Under a budget the
+    copy is kept in pages, and the least recently used pages are
+    dropped to stay within the budget.  When the whole section fits,
+    it is kept in one piece as with BORDEBUG_REGISTER_CACHENAMES.
+    The unmangled names get what the copy leaves, and are all
+    dropped when a lower budget leaves too little.  0, the default,
+    means no ceiling: the section is copied or not as asked at
+    registration, and all unmangled names are kept.
+
+    The indexes themselves, the subsection directory and the read
+    window don't count: without them nothing can be looked up.  A
+    copy of sstNames shared with other registrations of the file is
+    no longer used by this one when it doesn't fit the budget, the
+    others keep it.  When a copy of its own is dropped, the sstNames
+    index is made smaller as it is built without a copy, unless it
+    is shared too or kept in an index cache.
+    Call this while no other call for the file is in progress.
+
+    registerCookie: the cookie of the file
+    bytes:          the budget in bytes, or 0
+
+
+    BorDebugGetMemoryUsage
+
+
+    Find out how much memory a registered file uses, to tune
+    budgets.  All sizes are in bytes.
+
+    budget:             as set with BorDebugSetMemoryBudget
+    arena:              all memory the file took from the allocator
+    directory:          subsection directory
+    typeIndex:          sstGlobalTypes index
+    nameIndex:          sstNames index
+    indexCache:         mapped index cache, not taken from the
+                        allocator, see BORDEBUG_REGISTER_INDEXCACHE
+    readWindow:         buffer for small reads from the file
+    nameText:           copy of sstNames, whole or in pages
+    nameTextHits:       name reads served by a cached page
+    nameTextMisses:     name reads that had to read a page
+    nameTextEvictions:  pages dropped to stay within the budget
+    shared:             indexes and sstNames copy shared with other
+                        registrations of the same file, see
+                        BorDebugRegisterFileEx; not in the sizes
+                        above, and the same for each of them
+    unmangled:          unmangled names kept, see
+                        BorDebugNameIndexToUnmangledName
+    unmangledNames:     number of names kept unmangled
+
+*/
+
+typedef struct
+{
+    unsigned long long  budget;
+    unsigned long long  arena;
+    unsigned long long  directory;
+    unsigned long long  typeIndex;
+    unsigned long long  nameIndex;
+    unsigned long long  indexCache;
+    unsigned long long  readWindow;
+    unsigned long long  nameText;
+    unsigned long long  nameTextHits;
+    unsigned long long  nameTextMisses;
+    unsigned long long  nameTextEvictions;
+    unsigned long long  shared;
+    unsigned long long  unmangled;
+    unsigned long long  unmangledNames;
+}
+        BorDebugMemoryUsage;
+
+
+void    BorDebugSetMemoryBudget(BorDebugCookie registerCookie, unsigned long long bytes);
+
+void    BorDebugGetMemoryUsage(BorDebugCookie registerCookie, BorDebugMemoryUsage * usage);
+
+
 
 
 //---------------------------------------------------------------------
@@ -2039,7 +2840,7 @@ void    BorDebugGlobalTypes(BorDebugCookie registerCookie,
     If you access types 0-based, you will get either
     crashes or bogus results.
 
-    Types are build up from leaves (BORDEBUG_LF_XXX records)
+    Types are built up from leaves (BORDEBUG_LF_XXX records)
 
     There are several types of leaves:
     - Types directly referenced in symbols (0x00000001 - 0x000000EE)
@@ -3791,8 +4592,8 @@ long double     BorDebugTypeREAL80(BorDebugCookie registerCookie,
 
 */
 
-__int64 BorDebugTypeQUADWORD(BorDebugCookie registerCookie,
-                             unsigned int   typeOffset);
+long long BorDebugTypeQUADWORD(BorDebugCookie registerCookie,
+                               unsigned int   typeOffset);
 
 
 /*
@@ -3811,8 +4612,8 @@ __int64 BorDebugTypeQUADWORD(BorDebugCookie registerCookie,
 
 */
 
-unsigned __int64 BorDebugTypeUQUADWORD(BorDebugCookie registerCookie,
-                                       unsigned int   typeOffset);
+unsigned long long BorDebugTypeUQUADWORD(BorDebugCookie registerCookie,
+                                         unsigned int   typeOffset);
 
 
 /*
@@ -3882,6 +4683,14 @@ unsigned int    BorDebugNamesTotalNames(BorDebugCookie registerCookie);
     bufLen characters.
     A buffer of 1024 char's is enough for most names
 
+    A name is unmangled once and kept for the next calls,
+    see BorDebugUnmangleNames.  SHOW_TROUBLED_NAME is looked
+    at on every call: the kept names are made with it as it
+    was for the first call, and while it is the other way
+    the names are unmangled again and not kept.  Several
+    threads may call this, BorDebugNameIndexToUnmangledNameView
+    and BorDebugUnmangleNames for a cookie at a time.
+
     name:   name index
     buf:    points to array of char's
     bufLen: size of buf array
@@ -3916,6 +4725,108 @@ void    BorDebugNameIndexToName(BorDebugCookie registerCookie,
                                 char         * buf,
                                 unsigned int   bufLen);
 
+
+/*
+
+    BorDebugNameIndexToNameView
+
+
+    Go from an index to the name as it appears in the
+    debug info, without copying it: text is set to point
+    at the name in the sstNames subsection, and the length
+    is returned.  The name is not always followed by a
+    zero, so use the length.
+
+    With BORDEBUG_REGISTER_MAP, or BORDEBUG_REGISTER_CACHENAMES
+    while the copy is kept (see BorDebugSetMemoryBudget), the
+    text stays valid as long as the file is registered.
+    Otherwise it points into a read buffer of the cookie, and
+    is only valid until the next call for the cookie.
+
+    name:   name index
+    text:   receives the start of the name, "" if there is
+            no such name
+    return: the length of the name, 0 if there is no such name
+
+*/
+
+unsigned int    BorDebugNameIndexToNameView(BorDebugCookie    registerCookie,
+                                            unsigned int      name,
+                                            const char     ** text);
+
+/*
+
+    BorDebugNameIndexesToNames
+
+
+    Go from a number of indexes to the names as they appear in
+    the debug info, as BorDebugNameIndexToName does for one.
+    Unless the names are in memory (BORDEBUG_REGISTER_MAP, or
+    BORDEBUG_REGISTER_CACHENAMES), the names are read in the
+    order of the file, and names close to each other with one
+    read, rather than one read for each name.
+
+    The names are put in buf one after the other, each followed
+    by a zero, in the order of the indexes.  The names that
+    don't fit are left out; call again for the rest.  0 is
+    returned when not even the first name fits.
+
+    names:  array of name indexes, a name that doesn't exist
+            gives ""
+    count:  number of indexes
+    buf:    points to array of char's
+    bufLen: size of buf array
+    starts: receives the offset of each name in buf
+    return: the number of names put in buf
+
+*/
+
+unsigned int    BorDebugNameIndexesToNames(BorDebugCookie         registerCookie,
+                                           const unsigned int   * names,
+                                           unsigned int           count,
+                                           char                 * buf,
+                                           unsigned int           bufLen,
+                                           unsigned int         * starts);
+
+/*
+
+    BorDebugNameIndexToUnmangledNameView
+
+
+    Go from an index to the unmangled name, as
+    BorDebugNameIndexToUnmangledName does, without copying it:
+    text is set to point at the kept name, which is followed by
+    a zero and stays valid as long as the file is registered.
+    A name that doesn't fit the budget (see
+    BorDebugSetMemoryBudget) is not kept; then the text is only
+    valid until the next call of this function on the same
+    thread.  Lowering the budget can drop all kept names.
+
+    name:   name index
+    text:   receives the start of the name, "" if there is
+            no such name
+    return: the length of the name, 0 if there is no such name
+
+
+    BorDebugUnmangleNames
+
+
+    Unmangle all names of the file and keep them, rather than
+    one at a time as they are asked for.  The names are read
+    with few reads, and unmangled on the worker threads (see
+    BorDebugSetThreadCount).  Names already kept are skipped.
+    Stops when the budget is used up.
+
+    return: the number of names kept
+
+*/
+
+unsigned int    BorDebugNameIndexToUnmangledNameView(BorDebugCookie    registerCookie,
+                                                     unsigned int      name,
+                                                     const char     ** text);
+
+unsigned int    BorDebugUnmangleNames(BorDebugCookie registerCookie);
+
 /*
 
     BorDebugRegIndexToName
@@ -3977,6 +4888,633 @@ void    BorDebugTypeIndexToString(BorDebugCookie registerCookie,
 
 
 
+//---------------------------------------------------------------------
+
+/*
+
+    64 bit offset API's
+
+
+    The API's above pass file offsets as unsigned int, which limits
+    them to files up to 4 GB.  Each API that takes or returns a file
+    offset has a counterpart with _64 appended to its name, which
+    passes file offsets as unsigned long long, for instance
+    BorDebugSymbolBPREL32_64 and BorDebugTypeREAL64_64.  Everything
+    else is the same, and both can be used on the same
+    registerCookie.
+
+    The file offsets are the offsets of subsections, symbols, types
+    and source file entries, the refSymOffset of GPROCREF and
+    GDATAREF symbols, and the offset of the subsection directory.
+    Other offsets, like code, frame and member offsets, stay
+    unsigned int.
+
+    For a file offset beyond 4 GB, the 32 bit API's only see the
+    low 32 bits.  Use the 64 bit API's for such files.
+
+*/
+
+unsigned long long      BorDebugSubSectionDirOffset_64(BorDebugCookie registerCookie);
+
+
+void    BorDebugSubSection_64(BorDebugCookie       registerCookie,
+                              unsigned int         subSectionNo,
+                              unsigned int       * subSectionType,
+                              unsigned int       * module,
+                              unsigned long long * offset,
+                              unsigned int       * size);
+
+
+void    BorDebugModule_64(BorDebugCookie       registerCookie,
+                          unsigned long long   offset,
+                          unsigned int       * overlay,
+                          unsigned int       * libIndex,
+                          unsigned int       * style,
+                          unsigned int       * name,
+                          unsigned int       * timeStamp,
+                          unsigned int       * segmentCount);
+
+
+void    BorDebugModuleSegment_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   moduleOffset,
+                                 unsigned int         segmentNo,
+                                 unsigned int       * segment,
+                                 unsigned int       * offset,
+                                 unsigned int       * size,
+                                 unsigned int       * flags);
+
+
+void    BorDebugStartSymbols_64(BorDebugCookie       registerCookie,
+                                unsigned int         subSectionType,
+                                unsigned long long   offset,
+                                unsigned int         size);
+
+
+void    BorDebugNextSymbol_64(BorDebugCookie       registerCookie,
+                              unsigned int       * kind,
+                              unsigned long long * symOffset,
+                              unsigned int       * symLen);
+
+
+void    BorDebugSymbolCOMPILE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * machine,
+                                 unsigned int       * language,
+                                 unsigned int       * flags,
+                                 char               * compilerName,
+                                 unsigned int         maxNameCount);
+
+void    BorDebugSymbolREGISTER_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * reg,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset);
+
+void    BorDebugSymbolCONST_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * browserOffset,
+                               unsigned int       * value);
+
+void    BorDebugSymbolUDT_64(BorDebugCookie       registerCookie,
+                             unsigned long long   symOffset,
+                             unsigned int       * typeIndex,
+                             unsigned int       * properties,
+                             unsigned int       * name,
+                             unsigned int       * browserOffset);
+
+void    BorDebugSymbolSSEARCH_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * firstProcSegment,
+                                 unsigned int       * firstProcOffset,
+                                 unsigned int       * codeSymCount,
+                                 unsigned int       * dataSymCount,
+                                 unsigned int       * firstData);
+
+void    BorDebugSymbolOBJNAME_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * signature,
+                                 unsigned int       * name);
+
+void    BorDebugSymbolGPROCREF_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned long long * refSymOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset,
+                                  unsigned int       * codeSegment,
+                                  unsigned int       * codeOffset);
+
+void    BorDebugSymbolGDATAREF_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   symOffset,
+                                  unsigned long long * refSymOffset,
+                                  unsigned int       * typeIndex,
+                                  unsigned int       * name,
+                                  unsigned int       * browserOffset,
+                                  unsigned int       * dataSegment,
+                                  unsigned int       * dataOffset);
+
+void    BorDebugSymbolEDATA_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * externIndex,
+                               unsigned int       * flags,
+                               unsigned int       * browserOffset);
+
+void    BorDebugSymbolEPROC_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * externIndex,
+                               unsigned int       * flags,
+                               unsigned int       * browserOffset);
+
+unsigned int    BorDebugSymbolUSES_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   symOffset,
+                                      unsigned int         nameCount,
+                                      unsigned int       * nameIndices);
+
+unsigned int    BorDebugSymbolNAMESPACE_64(BorDebugCookie       registerCookie,
+                                           unsigned long long   symOffset,
+                                           unsigned int         usingCount,
+                                           unsigned int       * name,
+                                           unsigned int       * browserOffset,
+                                           unsigned int       * usingIndices);
+
+unsigned int    BorDebugSymbolUSING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   symOffset,
+                                       unsigned int         nameCount,
+                                       unsigned int       * nameIndices);
+
+unsigned int    BorDebugSymbolPCONSTANT_64(BorDebugCookie       registerCookie,
+                                           unsigned long long   symOffset,
+                                           unsigned int       * typeIndex,
+                                           unsigned int       * name,
+                                           unsigned int       * properties,
+                                           unsigned int       * browserOffset,
+                                           unsigned int         valueMaxLen,
+                                           unsigned char      * value);
+
+void    BorDebugSymbolBPREL32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset);
+
+void    BorDebugSymbolLDATA32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset);
+
+void    BorDebugSymbolGDATA32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset);
+
+void    BorDebugSymbolPUB32_64(BorDebugCookie       registerCookie,
+                               unsigned long long   symOffset,
+                               unsigned int       * offset,
+                               unsigned int       * segment,
+                               unsigned int       * flags,
+                               unsigned int       * typeIndex,
+                               unsigned int       * name,
+                               unsigned int       * browserOffset);
+
+void    BorDebugSymbolLPROC32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * next,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * debugStart,
+                                 unsigned int       * debugEnd,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * flags,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset);
+
+unsigned int    BorDebugSymbolGPROC32_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   symOffset,
+                                         unsigned int       * parent,
+                                         unsigned int       * end,
+                                         unsigned int       * next,
+                                         unsigned int       * codeLength,
+                                         unsigned int       * debugStart,
+                                         unsigned int       * debugEnd,
+                                         unsigned int       * offset,
+                                         unsigned int       * segment,
+                                         unsigned int       * flags,
+                                         unsigned int       * typeIndex,
+                                         unsigned int       * name,
+                                         unsigned int       * browserOffset,
+                                         char               * linkName,
+                                         unsigned int         maxLinkName);
+
+void    BorDebugSymbolTHUNK32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * next,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * ordinal,
+                                 unsigned int       * name,
+                                 unsigned int       * delta);
+
+void    BorDebugSymbolBLOCK32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * parent,
+                                 unsigned int       * end,
+                                 unsigned int       * codeLength,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * name);
+
+void    BorDebugSymbolWITH32_64(BorDebugCookie       registerCookie,
+                                unsigned long long   symOffset,
+                                unsigned int       * parent,
+                                unsigned int       * codeLength,
+                                unsigned int       * offset,
+                                unsigned int       * segment,
+                                unsigned int       * flags,
+                                unsigned int       * typeIndex,
+                                unsigned int       * name,
+                                unsigned int       * varOffset);
+
+void    BorDebugSymbolLABEL32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment,
+                                 unsigned int       * nearFar,
+                                 unsigned int       * name);
+
+void    BorDebugSymbolENTRY32_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   symOffset,
+                                 unsigned int       * offset,
+                                 unsigned int       * segment);
+
+unsigned int    BorDebugSymbolOPTVAR32_64(BorDebugCookie       registerCookie,
+                                          unsigned long long   symOffset,
+                                          unsigned int         maxEntries,
+                                          unsigned int       * startEntries,
+                                          unsigned int       * lengthEntries,
+                                          unsigned int       * regNameEntries);
+
+void    BorDebugSymbolPROCRET32_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   symOffset,
+                                   unsigned int       * offset,
+                                   unsigned int       * length);
+
+void    BorDebugSymbolSAVREGS32_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   symOffset,
+                                   unsigned int       * mask,
+                                   unsigned int       * offset);
+
+unsigned int    BorDebugSymbolSLINK32_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   symOffset);
+
+
+void    BorDebugSrcModule_64(BorDebugCookie       registerCookie,
+                             unsigned long long   offset,
+                             unsigned int       * rangeCount,
+                             unsigned int       * sourceCount);
+
+void    BorDebugSrcModuleRanges_64(BorDebugCookie       registerCookie,
+                                   unsigned long long   offset,
+                                   unsigned int       * segments,
+                                   unsigned int       * segmentStarts,
+                                   unsigned int       * segmentEnds);
+
+void    BorDebugSrcModuleSources_64(BorDebugCookie       registerCookie,
+                                    unsigned long long   offset,
+                                    unsigned long long * sourceOffsets,
+                                    unsigned int       * names,
+                                    unsigned int       * rangeCounts);
+
+void    BorDebugSrcModuleSourceRanges_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   offset,
+                                         unsigned int         source,
+                                         unsigned int       * segments,
+                                         unsigned int       * segmentStarts,
+                                         unsigned int       * segmentEnds,
+                                         unsigned int       * lineNumberCounts);
+
+void    BorDebugSrcModuleLineNumbers_64(BorDebugCookie       registerCookie,
+                                        unsigned long long   offset,
+                                        unsigned int         source,
+                                        unsigned int         range,
+                                        unsigned int       * lineNumber,
+                                        unsigned int       * lineOffset);
+
+
+void    BorDebugGlobalSym_64(BorDebugCookie       registerCookie,
+                             unsigned long long   offset,
+                             unsigned int       * symHashFunction,
+                             unsigned int       * addrHashFunction,
+                             unsigned int       * symTableBytes,
+                             unsigned int       * symHashTableBytes,
+                             unsigned int       * addrHashTableBytes,
+                             unsigned int       * totalUDTs,
+                             unsigned int       * totalOtherSyms,
+                             unsigned int       * totalSymbols,
+                             unsigned int       * totalNameSpaces);
+
+
+void    BorDebugTypeFromIndex_64(BorDebugCookie       registerCookie,
+                                 unsigned int         typeIndex,
+                                 unsigned long long * typeOffset,
+                                 unsigned int       * length,
+                                 unsigned int       * typeKind);
+
+void    BorDebugTypeFromOffset_64(BorDebugCookie       registerCookie,
+                                  unsigned long long   typeOffset,
+                                  unsigned int       * length,
+                                  unsigned int       * typeKind);
+
+void    BorDebugTypeMODIFIER_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * attributes,
+                                unsigned int       * typeIndex);
+
+void    BorDebugTypePOINTER_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * attributes,
+                               unsigned int       * typeIndex,
+                               unsigned int       * value1,
+                               unsigned int       * value2);
+
+void    BorDebugTypeARRAY_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * elementType,
+                             unsigned int       * indexType,
+                             unsigned int       * name,
+                             unsigned int       * size,
+                             unsigned int       * elements);
+
+void    BorDebugTypeCLASS_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * fieldCount,
+                             unsigned int       * fieldList,
+                             unsigned int       * property,
+                             unsigned int       * containingClass,
+                             unsigned int       * derivationList,
+                             unsigned int       * vtable,
+                             unsigned int       * name,
+                             unsigned int       * classSize);
+
+void    BorDebugTypeUNION_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset,
+                             unsigned int       * fieldCount,
+                             unsigned int       * fieldList,
+                             unsigned int       * property,
+                             unsigned int       * containingClass,
+                             unsigned int       * name,
+                             unsigned int       * classSize);
+
+void    BorDebugTypeENUM_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset,
+                            unsigned int       * memberCount,
+                            unsigned int       * underType,
+                            unsigned int       * memberList,
+                            unsigned int       * containingClass,
+                            unsigned int       * name);
+
+void    BorDebugTypePROCEDURE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * returnType,
+                                 unsigned int       * callingConvention,
+                                 unsigned int       * argCount,
+                                 unsigned int       * argList);
+
+void    BorDebugTypeMFUNCTION_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * returnType,
+                                 unsigned int       * classType,
+                                 unsigned int       * thisType,
+                                 unsigned int       * callingConvention,
+                                 unsigned int       * argCount,
+                                 unsigned int       * argList,
+                                 unsigned int       * thisAdjust);
+
+unsigned int    BorDebugTypeVTSHAPE_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxCount,
+                                       unsigned char      * descriptorArray);
+
+unsigned int    BorDebugTypeLABEL_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset);
+
+void    BorDebugTypeSET_64(BorDebugCookie       registerCookie,
+                           unsigned long long   typeOffset,
+                           unsigned int       * elemType,
+                           unsigned int       * name,
+                           unsigned int       * lowByte,
+                           unsigned int       * length);
+
+void    BorDebugTypeSUBRANGE_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * baseType,
+                                unsigned int       * name,
+                                unsigned int       * loBound,
+                                unsigned int       * hiBound,
+                                unsigned int       * size);
+
+void    BorDebugTypePARRAY_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * elementType,
+                              unsigned int       * indexType,
+                              unsigned int       * name,
+                              unsigned int       * size,
+                              unsigned int       * elements);
+
+void    BorDebugTypePSTRING_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * elemType,
+                               unsigned int       * indexType,
+                               unsigned int       * name);
+
+void    BorDebugTypeCLOSURE_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * returnType,
+                               unsigned int       * callingConvention,
+                               unsigned int       * argCount,
+                               unsigned int       * argList);
+
+void    BorDebugTypePROPERTY_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * propType,
+                                unsigned int       * flags,
+                                unsigned int       * arrayIndex,
+                                unsigned int       * propIndex,
+                                unsigned int       * readSlot,
+                                unsigned int       * writeSlot);
+
+unsigned int    BorDebugTypeLSTRING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset);
+
+unsigned int    BorDebugTypeVARIANT_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset);
+
+void    BorDebugTypeCLASSREF_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * refType,
+                                unsigned int       * vtShape);
+
+unsigned int    BorDebugTypeWSTRING_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset);
+
+unsigned int    BorDebugTypeARGLIST_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxTypes,
+                                       unsigned int       * typeIndexArray);
+
+void    BorDebugTypeStartFIELDLIST_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset);
+
+void    BorDebugTypeNextFIELDLIST_64(BorDebugCookie       registerCookie,
+                                     unsigned int       * kind,
+                                     unsigned long long * offset);
+
+unsigned int    BorDebugTypeINDEX_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset);
+
+unsigned int    BorDebugTypeDERIVED_64(BorDebugCookie       registerCookie,
+                                       unsigned long long   typeOffset,
+                                       unsigned int         maxTypes,
+                                       unsigned int       * derivedTypes);
+
+void    BorDebugTypeBITFIELD_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * length,
+                                unsigned int       * position,
+                                unsigned int       * typeIndex);
+
+unsigned int    BorDebugTypeMETHODLIST_64(BorDebugCookie       registerCookie,
+                                          unsigned long long   typeOffset,
+                                          unsigned int         maxMethods,
+                                          unsigned int       * typeArray,
+                                          unsigned int       * attribArray,
+                                          unsigned int       * browserArray,
+                                          unsigned int       * vtabOffArray);
+
+void    BorDebugTypeBCLASS_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * baseType,
+                              unsigned int       * attrib,
+                              unsigned int       * offset);
+
+void    BorDebugTypeVBCLASS_64(BorDebugCookie       registerCookie,
+                               unsigned long long   typeOffset,
+                               unsigned int       * vbType,
+                               unsigned int       * vbptype,
+                               unsigned int       * attrib,
+                               unsigned int       * vbpOffset,
+                               unsigned int       * offset);
+
+void    BorDebugTypeIVBCLASS_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * vbType,
+                                unsigned int       * vbpType,
+                                unsigned int       * attrib,
+                                unsigned int       * vbpOffset,
+                                unsigned int       * offset);
+
+void    BorDebugTypeENUMERATE_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * attrib,
+                                 unsigned int       * name,
+                                 unsigned int       * browserOffset,
+                                 unsigned int       * value);
+
+void    BorDebugTypeFRIENDFCN_64(BorDebugCookie       registerCookie,
+                                 unsigned long long   typeOffset,
+                                 unsigned int       * typeIndex,
+                                 unsigned int       * name);
+
+void    BorDebugTypeMEMBER_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * typeIndex,
+                              unsigned int       * attrib,
+                              unsigned int       * name,
+                              unsigned int       * offset,
+                              unsigned int       * browserOffset);
+
+void    BorDebugTypeSTMEMBER_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * attrib,
+                                unsigned int       * name,
+                                unsigned int       * browserOffset);
+
+void    BorDebugTypeMETHOD_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset,
+                              unsigned int       * count,
+                              unsigned int       * methodList,
+                              unsigned int       * name);
+
+void    BorDebugTypeNESTTYPE_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * name,
+                                unsigned int       * browserOffset);
+
+void    BorDebugTypeVFUNCTAB_64(BorDebugCookie       registerCookie,
+                                unsigned long long   typeOffset,
+                                unsigned int       * typeIndex,
+                                unsigned int       * offset);
+
+unsigned int    BorDebugTypeFRIENDCLS_64(BorDebugCookie       registerCookie,
+                                         unsigned long long   typeOffset);
+
+char    BorDebugTypeCHAR_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset);
+
+short   BorDebugTypeSHORT_64(BorDebugCookie       registerCookie,
+                             unsigned long long   typeOffset);
+
+unsigned short  BorDebugTypeUSHORT_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset);
+
+long    BorDebugTypeLONG_64(BorDebugCookie       registerCookie,
+                            unsigned long long   typeOffset);
+
+unsigned long   BorDebugTypeULONG_64(BorDebugCookie       registerCookie,
+                                     unsigned long long   typeOffset);
+
+float   BorDebugTypeREAL32_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset);
+
+double  BorDebugTypeREAL64_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset);
+
+long double     BorDebugTypeREAL80_64(BorDebugCookie       registerCookie,
+                                      unsigned long long   typeOffset);
+
+long long       BorDebugTypeQUADWORD_64(BorDebugCookie       registerCookie,
+                                        unsigned long long   typeOffset);
+
+unsigned long long      BorDebugTypeUQUADWORD_64(BorDebugCookie       registerCookie,
+                                                 unsigned long long   typeOffset);
+
+double  BorDebugTypeREAL48_64(BorDebugCookie       registerCookie,
+                              unsigned long long   typeOffset);
+
+
 //---------------------------------------------------------------------
 
 /*
@@ -4270,6 +5808,62 @@ BorDebugUmKind  BorDebugUnmangle(char   *       src,
                                  int            doArgs);
 
 
+/*
+
+    BorDebugUnmangleEx
+
+
+    The same as BorDebugUnmangle, but SHOW_TROUBLED_NAME is not
+    looked at: showTroubled non-0 does what it does.  It keeps
+    nothing between calls, so any number of threads can call it
+    at once.
+
+
+    BorDebugUnmangleBatch
+
+
+    Unmangle a number of names at once, spread over the worker
+    threads (see BorDebugSetThreadCount), as BorDebugUnmangleEx
+    does with no limit on the length.  The names don't have to
+    come from a registered file.
+
+    The names are put in buf one after the other, each followed
+    by a zero, in the order of src.  A name that isn't mangled
+    is put there as it is.  The names that don't fit are left
+    out; call again for the rest.  0 is returned when not even
+    the first name fits.
+
+    src:            array of mangled names, NULL terminated
+    count:          number of names
+    doArgs:         as for BorDebugUnmangle
+    showTroubled:   as for BorDebugUnmangleEx
+    buf:            points to array of char's
+    bufLen:         size of buf array
+    starts:         receives the offset of each name in buf
+    kinds:          receives the return code of each name, as
+                    BorDebugUnmangle returns it, can be NULL
+    return:         the number of names put in buf
+
+*/
+
+BorDebugUmKind  BorDebugUnmangleEx(const char   * src,
+                                   char         * dest,
+                                   unsigned       maxlen,
+                                   char         * qualP,
+                                   char         * baseP,
+                                   int            doArgs,
+                                   int            showTroubled);
+
+unsigned int    BorDebugUnmangleBatch(const char * const  * src,
+                                      unsigned int          count,
+                                      int                   doArgs,
+                                      int                   showTroubled,
+                                      char                * buf,
+                                      unsigned int          bufLen,
+                                      unsigned int        * starts,
+                                      BorDebugUmKind      * kinds);
+
+
 //---------------------------------------------------------------------
 
 
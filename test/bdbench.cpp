@@ -0,0 +1,176 @@
+//---------------------------------------------------------------------
+
+/*
+    Scaling benchmark for the worker pool: times the parallel parts
+    of the library with 1, 2, 4 and 8 threads, and one per CPU.
+
+        register    BorDebugRegisterFileEx with BORDEBUG_REGISTER_EAGER,
+                    which builds the sstGlobalTypes and sstNames
+                    indexes on the pool
+        unmangle    BorDebugUnmangleBatch over all names in the file
+
+    Each figure is the best of a number of runs.
+
+    usage: bdbench file.tds [runs]
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bordebug.h"
+
+
+//---------------------------------------------------------------------
+
+typedef std::chrono::steady_clock   BdClock;
+
+
+static double   bdMillis(BdClock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(BdClock::now() - start).count();
+}
+
+
+static double   bdTimeRegister(const char * fileName, unsigned runs)
+{
+    double  best = 0;
+
+    for (unsigned run = 0; run < runs; run++)
+    {
+        unsigned            failure;
+        BdClock::time_point start  = BdClock::now();
+        BorDebugCookie      cookie = BorDebugRegisterFileEx(fileName,
+                                                            BORDEBUG_REGISTER_EAGER,
+                                                            &failure);
+        double              took   = bdMillis(start);
+
+        if  (!cookie)
+        {
+            fprintf(stderr, "bdbench: can't register %s (%u)\n", fileName, failure);
+            exit(1);
+        }
+
+        BorDebugUnregisterFile(cookie);
+
+        if  (run == 0 || took < best)
+            best = took;
+    }
+
+    return best;
+}
+
+
+static double   bdTimeUnmangle(const std::vector<const char *> & names,
+                               unsigned runs)
+{
+    std::vector<char>           buf(64u << 20);
+    std::vector<unsigned int>   starts(names.size());
+    double                      best = 0;
+
+    for (unsigned run = 0; run < runs; run++)
+    {
+        BdClock::time_point start = BdClock::now();
+        size_t              done  = 0;
+
+        while (done < names.size())
+        {
+            unsigned    got = BorDebugUnmangleBatch(&names[done],
+                                                    names.size() - done,
+                                                    1, 0, buf.data(),
+                                                    buf.size(),
+                                                    &starts[done], 0);
+
+            if  (got == 0)
+                break;
+
+            done += got;
+        }
+
+        double  took = bdMillis(start);
+
+        if  (run == 0 || took < best)
+            best = took;
+    }
+
+    return best;
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc < 2)
+    {
+        fprintf(stderr, "usage: %s file.tds [runs]\n", argv[0]);
+        return 2;
+    }
+
+    const char  * fileName = argv[1];
+    unsigned      runs     = argc > 2 ? atoi(argv[2]) : 3;
+
+    // the names to unmangle, read once up front
+    unsigned                    failure;
+    BorDebugCookie              cookie = BorDebugRegisterFileEx(fileName, 0, &failure);
+    std::vector<std::string>    text;
+    std::vector<const char *>   names;
+
+    if  (!cookie)
+    {
+        fprintf(stderr, "bdbench: can't register %s (%u)\n", fileName, failure);
+        return 1;
+    }
+
+    unsigned    total = BorDebugNamesTotalNames(cookie);
+    char        buf[4096];
+
+    text.reserve(total);
+    for (unsigned i = 1; i <= total; i++)
+    {
+        BorDebugNameIndexToName(cookie, i, buf, sizeof(buf));
+        text.push_back(buf);
+    }
+
+    for (const std::string & name : text)
+        names.push_back(name.c_str());
+
+    BorDebugUnregisterFile(cookie);
+
+    unsigned    cpus      = std::thread::hardware_concurrency();
+    unsigned    threads[] = { 1, 2, 4, 8, cpus };
+    double      register1 = 0;
+    double      unmangle1 = 0;
+
+    printf("%s: %u names, %u CPUs, best of %u runs\n\n", fileName, total, cpus, runs);
+    printf("threads   register ms  speedup   unmangle ms  speedup\n");
+
+    for (unsigned i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+    {
+        if  (i == 4 && (cpus <= 2 || cpus == 4 || cpus == 8))
+            break;
+
+        BorDebugSetThreadCount(threads[i]);
+
+        double  reg = bdTimeRegister(fileName, runs);
+        double  um  = bdTimeUnmangle(names, runs);
+
+        if  (i == 0)
+        {
+            register1 = reg;
+            unmangle1 = um;
+        }
+
+        printf("%7u   %11.1f  %6.2fx   %11.1f  %6.2fx\n", threads[i],
+               reg, register1 / reg, um, unmangle1 / um);
+    }
+
+    BorDebugSetThreadCount(0);
+    return 0;
+}
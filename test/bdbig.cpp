@@ -0,0 +1,225 @@
+//---------------------------------------------------------------------
+
+/*
+    Checks the _64 offset API's on a file larger than 4 GB.
+
+    The test makes a sparse .exe with the contents of sample.tds
+    5 GB into the file and the debug trailer at its end, so every
+    subsection, symbol and type offset is beyond 4 GB.  It is
+    registered in read mode and mapped, and looked at through the
+    _64 API's.  The 32 bit API's must see the low 32 bits.
+
+    usage: bdbig sample.tds
+*/
+
+//---------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "../bordebug.h"
+#include "bdtest.h"
+
+
+//---------------------------------------------------------------------
+
+static const unsigned long long BD_BASE = 5ull << 30;
+
+
+/*
+    Write the sparse file: a hole up to BD_BASE, the .tds contents,
+    and the 'FB09' trailer whose DWORD is the distance from the end
+    of the file back to BD_BASE.
+*/
+
+static bool bdMakeBigFile(const std::vector<unsigned char> & tds,
+                          std::string & fileName)
+{
+    const char  * dir = getenv("TMPDIR");
+    char          path[4096];
+
+    snprintf(path, sizeof(path), "%s/bdbigXXXXXX.exe", dir && *dir ? dir : "/tmp");
+
+    int     fd = mkstemps(path, 4);
+
+    if  (fd < 0)
+        return false;
+
+    fileName = path;
+
+    unsigned char   trailer[8];
+    unsigned int    back = (unsigned int)tds.size() + 8;
+
+    memcpy(trailer, tds.data(), 4);
+    trailer[4] = (unsigned char)back;
+    trailer[5] = (unsigned char)(back >> 8);
+    trailer[6] = (unsigned char)(back >> 16);
+    trailer[7] = (unsigned char)(back >> 24);
+
+    bool    ok = ftruncate(fd, BD_BASE) == 0 &&
+                 pwrite(fd, tds.data(), tds.size(), BD_BASE) == (ssize_t)tds.size() &&
+                 pwrite(fd, trailer, 8, BD_BASE + tds.size()) == 8;
+
+    close(fd);
+
+    if  (!ok)
+        unlink(path);
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------
+
+static void bdCheckBig(const char * fileName, unsigned options)
+{
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie  = BorDebugRegisterFileEx(fileName, options, &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (!cookie)
+        return;
+
+    char                buf[256];
+    unsigned            kind, module, size;
+    unsigned long long  offset;
+
+    CHECK(BorDebugSubSectionDirOffset_64(cookie) == BD_BASE + 924);
+    CHECK(BorDebugSubSectionDirOffset(cookie) == (unsigned)(BD_BASE + 924));
+    CHECK(BorDebugSubSectionCount(cookie) == 11);
+
+    // sstModule of the second module
+    BorDebugSubSection_64(cookie, 1, &kind, &module, &offset, &size);
+    CHECK(kind == BORDEBUG_SSTMODULE && module == 2);
+    CHECK(offset == BD_BASE + 48 && size == 40);
+
+    unsigned    subOffset32, kind32, module32, size32;
+
+    BorDebugSubSection(cookie, 1, &kind32, &module32, &subOffset32, &size32);
+    CHECK(subOffset32 == (unsigned)(BD_BASE + 48));
+
+    unsigned    name, stamp, segs;
+
+    BorDebugModule_64(cookie, offset, 0, 0, 0, &name, &stamp, &segs);
+    CHECK(stamp == 1001 && segs == 1);
+    BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+    CHECK_STR(buf, "module1.cpp");
+
+    // sstAlignSym of the third module
+    BorDebugSubSection_64(cookie, 5, &kind, &module, &offset, &size);
+    CHECK(kind == BORDEBUG_SSTALIGNSYM && offset == BD_BASE + 280);
+
+    unsigned            symKind, symLength;
+    unsigned long long  symOffset;
+    unsigned            count = 0;
+
+    BorDebugStartSymbols_64(cookie, kind, offset, size);
+    for (BorDebugNextSymbol_64(cookie, &symKind, &symOffset, &symLength);
+         symLength && count < 8;
+         BorDebugNextSymbol_64(cookie, &symKind, &symOffset, &symLength))
+    {
+        count++;
+        CHECK(symOffset > BD_BASE && symOffset < offset + size);
+
+        if  (symKind == BORDEBUG_S_GPROC32)
+        {
+            unsigned    codeOffset, segment, length;
+
+            CHECK(symOffset == BD_BASE + 284);
+            BorDebugSymbolGPROC32_64(cookie, symOffset, 0, 0, 0, &length, 0, 0,
+                                     &codeOffset, &segment, 0, 0, &name, 0, 0, 0);
+            CHECK(codeOffset == 0x200 && segment == 1 && length == 16);
+            BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+            CHECK_STR(buf, "@Foo@func2$qi");
+        }
+
+        if  (symKind == BORDEBUG_S_BPREL32)
+        {
+            unsigned    frame, type;
+
+            CHECK(symOffset == BD_BASE + 332);
+            BorDebugSymbolBPREL32_64(cookie, symOffset, &frame, &type, &name, 0);
+            CHECK(frame == 8 && type == 0x74);
+            BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+            CHECK_STR(buf, "arg2");
+        }
+    }
+    CHECK(count == 3);
+
+    // sstSrcModule of the first module
+    BorDebugSubSection_64(cookie, 6, &kind, &module, &offset, &size);
+    CHECK(kind == BORDEBUG_SSTSRCMODULE && offset == BD_BASE + 356);
+
+    unsigned long long  sourceOffsets[2];
+    unsigned            names[2], rangeCounts[2];
+    unsigned            lines[2], lineOffsets[2];
+
+    BorDebugSrcModuleSources_64(cookie, offset, sourceOffsets, names, rangeCounts);
+    CHECK(sourceOffsets[0] == offset + 20);
+    BorDebugNameIndexToName(cookie, names[0], buf, sizeof(buf));
+    CHECK_STR(buf, "src0.cpp");
+    BorDebugSrcModuleLineNumbers_64(cookie, offset, 0, 0, lines, lineOffsets);
+    CHECK(lines[0] == 10 && lineOffsets[0] == 0);
+    CHECK(lines[1] == 11 && lineOffsets[1] == 8);
+
+    // sstGlobalTypes
+    unsigned long long  typeOffset;
+    unsigned            length, typeKind;
+    unsigned            attributes, pointee;
+
+    BorDebugTypeFromIndex_64(cookie, 0x1000, &typeOffset, &length, &typeKind);
+    CHECK(typeOffset > BD_BASE + 524 && typeOffset < BD_BASE + 576);
+    CHECK(typeKind == BORDEBUG_LF_POINTER);
+    BorDebugTypePOINTER_64(cookie, typeOffset, &attributes, &pointee, 0, 0);
+    CHECK(pointee == 0x74);
+    BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+    CHECK_STR(buf, "int *");
+
+    unsigned    typeOffset32;
+
+    BorDebugTypeFromIndex(cookie, 0x1000, &typeOffset32, &length, &typeKind);
+    CHECK(typeOffset32 == (unsigned)typeOffset);
+
+    BorDebugUnregisterFile(cookie);
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc != 2)
+    {
+        fprintf(stderr, "usage: %s sample.tds\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<unsigned char>  tds;
+    std::string                 fileName;
+
+    if  (!bdReadFile(argv[1], tds))
+    {
+        fprintf(stderr, "bdbig: can't read %s\n", argv[1]);
+        return 2;
+    }
+
+    // not every file system can hold a sparse 5 GB file
+    if  (!bdMakeBigFile(tds, fileName))
+    {
+        printf("bdbig: skipped, can't make a sparse file over 4 GB\n");
+        return 0;
+    }
+
+    bdCheckBig(fileName.c_str(), 0);
+    bdCheckBig(fileName.c_str(), BORDEBUG_REGISTER_MAP);
+    bdCheckBig(fileName.c_str(), BORDEBUG_REGISTER_CACHENAMES);
+
+    unlink(fileName.c_str());
+    return bdCheckResult("bdbig");
+}
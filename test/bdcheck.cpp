@@ -0,0 +1,1987 @@
+//---------------------------------------------------------------------
+
+/*
+    Checks the bordebug.h API's against the sample.tds fixture, in
+    each of the ways a file can be registered.
+
+    usage: bdcheck sample.tds
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bordebug.h"
+#include "bdtest.h"
+
+
+//---------------------------------------------------------------------
+
+/*
+    The subsections in sample.tds: three sstModule, three sstAlignSym,
+    three sstSrcModule, sstGlobalTypes and sstNames.
+*/
+
+/*
+    The nth listed subsection of a kind, so the checks below work
+    when the BORDEBUG_REGISTER_SKIPXXXX options leave others out
+*/
+
+static bool bdFindSubSection(BorDebugCookie cookie, unsigned kind, unsigned nth,
+                             unsigned * offset, unsigned * size)
+{
+    unsigned    subKind, module;
+
+    *offset = *size = 0;
+
+    for (unsigned i = 0; i < BorDebugSubSectionCount(cookie); i++)
+    {
+        BorDebugSubSection(cookie, i, &subKind, &module, offset, size);
+        if  (subKind == kind && nth-- == 0)
+            return true;
+    }
+
+    *offset = *size = 0;
+    return false;
+}
+
+
+static void bdCheckSubSections(BorDebugCookie cookie)
+{
+    static const unsigned   kinds[] =
+    {
+        BORDEBUG_SSTMODULE,     BORDEBUG_SSTMODULE,     BORDEBUG_SSTMODULE,
+        BORDEBUG_SSTALIGNSYM,   BORDEBUG_SSTALIGNSYM,   BORDEBUG_SSTALIGNSYM,
+        BORDEBUG_SSTSRCMODULE,  BORDEBUG_SSTSRCMODULE,  BORDEBUG_SSTSRCMODULE,
+        BORDEBUG_SSTGLOBALTYPES,
+        BORDEBUG_SSTNAMES,
+    };
+    unsigned                count = BorDebugSubSectionCount(cookie);
+    unsigned                kind, module, offset, size;
+
+    CHECK(BorDebugSubSectionDirOffset(cookie) == 924);
+    CHECK(count == sizeof(kinds) / sizeof(kinds[0]));
+
+    for (unsigned i = 0; i < count && i < sizeof(kinds) / sizeof(kinds[0]); i++)
+    {
+        BorDebugSubSection(cookie, i, &kind, &module, &offset, &size);
+        CHECK(kind == kinds[i]);
+        CHECK(module == (i < 9 ? i % 3 + 1 : 0xFFFF));
+    }
+
+    BorDebugSubSection(cookie, 0, &kind, &module, &offset, &size);
+    CHECK(offset == 8 && size == 40);
+    BorDebugSubSection(cookie, 10, &kind, &module, &offset, &size);
+    CHECK(offset == 576 && size == 346);
+}
+
+
+static void bdCheckModules(BorDebugCookie cookie)
+{
+    char        buf[256];
+    unsigned    overlay, lib, style, name, stamp, segs;
+    unsigned    segment, offset, size, flags;
+
+    for (unsigned i = 0; i < 3; i++)
+    {
+        unsigned    subOffset, subSize;
+
+        CHECK(bdFindSubSection(cookie, BORDEBUG_SSTMODULE, i, &subOffset, &subSize));
+        BorDebugModule(cookie, subOffset, &overlay, &lib, &style, &name,
+                       &stamp, &segs);
+        CHECK(stamp == 1000 + i);
+        CHECK(segs == 1);
+
+        BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+        char    want[32];
+        snprintf(want, sizeof(want), "module%u.cpp", i);
+        CHECK_STR(buf, want);
+
+        BorDebugModuleSegment(cookie, subOffset, 0, &segment, &offset,
+                              &size, &flags);
+        CHECK(segment == 1 && offset == 0x100 * i && size == 0x100);
+        CHECK(flags == 1);
+    }
+}
+
+
+static void bdCheckSymbols(BorDebugCookie cookie)
+{
+    char        buf[256];
+    unsigned    subOffset, subSize;
+    unsigned    symKind, symOffset, symLength;
+    unsigned    kinds[8];
+    unsigned    count = 0;
+
+    CHECK(bdFindSubSection(cookie, BORDEBUG_SSTALIGNSYM, 1, &subOffset, &subSize));
+    BorDebugStartSymbols(cookie, BORDEBUG_SSTALIGNSYM, subOffset, subSize);
+
+    for (BorDebugNextSymbol(cookie, &symKind, &symOffset, &symLength);
+         symLength && count < 8;
+         BorDebugNextSymbol(cookie, &symKind, &symOffset, &symLength))
+    {
+        kinds[count++] = symKind;
+
+        if  (symKind == BORDEBUG_S_GPROC32)
+        {
+            unsigned    parent, end, next, length, start, stop, offset;
+            unsigned    segment, flags, type, name, browser;
+
+            BorDebugSymbolGPROC32(cookie, symOffset, &parent, &end, &next,
+                                  &length, &start, &stop, &offset,
+                                  &segment, &flags, &type, &name, &browser,
+                                  0, 0);
+            CHECK(offset == 0x100 && segment == 1 && length == 16);
+            BorDebugNameIndexToUnmangledName(cookie, name, buf, sizeof(buf));
+            CHECK_STR(buf, "Foo::func1(int)");
+        }
+
+        if  (symKind == BORDEBUG_S_BPREL32)
+        {
+            unsigned    offset, type, name, browser;
+
+            BorDebugSymbolBPREL32(cookie, symOffset, &offset, &type, &name,
+                                  &browser);
+            CHECK(offset == 8);
+            BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+            CHECK_STR(buf, "arg1");
+            BorDebugTypeIndexToString(cookie, type, buf, sizeof(buf));
+            CHECK_STR(buf, "int");
+        }
+    }
+
+    CHECK(count == 3);
+    CHECK(kinds[0] == BORDEBUG_S_GPROC32);
+    CHECK(kinds[1] == BORDEBUG_S_BPREL32);
+    CHECK(kinds[2] == BORDEBUG_S_END);
+}
+
+
+static void bdCheckLines(BorDebugCookie cookie)
+{
+    char        buf[256];
+    unsigned    subOffset, subSize;
+    unsigned    ranges, sources;
+    unsigned    sourceOffsets[4], names[4], rangeCounts[4];
+    unsigned    lines[4], offsets[4];
+
+    CHECK(bdFindSubSection(cookie, BORDEBUG_SSTSRCMODULE, 2, &subOffset, &subSize));
+    BorDebugSrcModule(cookie, subOffset, &ranges, &sources);
+    CHECK(ranges == 1 && sources == 1);
+
+    BorDebugSrcModuleSources(cookie, subOffset, sourceOffsets, names,
+                             rangeCounts);
+    BorDebugNameIndexToName(cookie, names[0], buf, sizeof(buf));
+    CHECK_STR(buf, "src2.cpp");
+    CHECK(rangeCounts[0] == 1);
+
+    BorDebugSrcModuleLineNumbers(cookie, subOffset, 0, 0, lines, offsets);
+    CHECK(lines[0] == 10 && offsets[0] == 0x200);
+    CHECK(lines[1] == 11 && offsets[1] == 0x208);
+}
+
+
+static void bdCheckTypes(BorDebugCookie cookie)
+{
+    char        buf[256];
+    unsigned    signature, total;
+    unsigned    offset, length, kind;
+
+    BorDebugGlobalTypes(cookie, &signature, &total);
+    CHECK(signature == 1 && total == 2);
+
+    BorDebugTypeFromIndex(cookie, 0x1000, &offset, &length, &kind);
+    CHECK(kind == BORDEBUG_LF_POINTER);
+    BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+    CHECK_STR(buf, "int *");
+}
+
+
+static void bdCheckNames(BorDebugCookie cookie, bool skipNames)
+{
+    static const char * const   unmangled[] =
+    {
+        "__fastcall System::AnsiString::AnsiString()",
+        "Foo::bar(int, const char *)",
+        "__fastcall Sysutils::Exception::Exception(const System::AnsiString)",
+        "__tpdsc__ System::TObject",
+        "std::vector<int>::size() const",
+        "plain_c_name",
+        "Foo::operator =(const Foo &)",
+        "Foo::~Foo()",
+    };
+    char        buf[256];
+
+    if  (skipNames)
+    {
+        CHECK(BorDebugNamesTotalNames(cookie) == 0);
+        return;
+    }
+
+    CHECK(BorDebugNamesTotalNames(cookie) == 22);
+
+    BorDebugNameIndexToName(cookie, 2, buf, sizeof(buf));
+    CHECK_STR(buf, "@Foo@bar$qipxc");
+    BorDebugNameIndexToName(cookie, 21, buf, sizeof(buf));
+    CHECK_STR(buf, "src2.cpp");
+    BorDebugNameIndexToName(cookie, 22, buf, sizeof(buf));
+    CHECK_STR(buf, "Foo");
+
+    // a few at a time: "src2.cpp", "" and "Foo" fill 14 bytes
+    const unsigned  batch[] = { 21, 99, 22, 2 };
+    unsigned        starts[4];
+
+    CHECK(BorDebugNameIndexesToNames(cookie, batch, 4, buf, 14, starts) == 3);
+    CHECK_STR(buf + starts[0], "src2.cpp");
+    CHECK_STR(buf + starts[1], "");
+    CHECK_STR(buf + starts[2], "Foo");
+    CHECK(BorDebugNameIndexesToNames(cookie, batch, 4, buf, 9, starts) == 1);
+    CHECK(BorDebugNameIndexesToNames(cookie, batch, 4, buf, 8, starts) == 0);
+    CHECK(BorDebugNameIndexesToNames(cookie, batch + 3, 1, buf, sizeof(buf), starts) == 1);
+    CHECK_STR(buf + starts[0], "@Foo@bar$qipxc");
+
+    for (unsigned i = 0; i < sizeof(unmangled) / sizeof(unmangled[0]); i++)
+    {
+        BorDebugNameIndexToUnmangledName(cookie, i + 1, buf, sizeof(buf));
+        CHECK_STR(buf, unmangled[i]);
+    }
+
+    // SHOW_TROUBLED_NAME counts on every call, though "@bad@$z" was
+    // kept without it
+    char        troubled[256];
+
+    BorDebugNameIndexToUnmangledName(cookie, 9, buf, sizeof(buf));
+    setenv("SHOW_TROUBLED_NAME", "1", 1);
+    BorDebugNameIndexToUnmangledName(cookie, 9, troubled, sizeof(troubled));
+    unsetenv("SHOW_TROUBLED_NAME");
+    CHECK(strstr(troubled, "@bad@$z") != 0 && strstr(buf, "@bad@$z") == 0);
+    BorDebugNameIndexToUnmangledName(cookie, 9, troubled, sizeof(troubled));
+    CHECK_STR(troubled, buf);
+}
+
+
+static void bdCheckUnmangle()
+{
+    char        buf[256];
+    char        qual[256];
+    char        base[256];
+    unsigned    kind;
+
+    kind = BorDebugUnmangle((char *)"@Foo@bar$qipxc", buf, sizeof(buf),
+                            qual, base, 1);
+    CHECK_STR(buf, "Foo::bar(int, const char *)");
+    CHECK_STR(qual, "Foo");
+    CHECK_STR(base, "bar");
+    CHECK((kind & 0xFF) == 1);
+
+    kind = BorDebugUnmangle((char *)"@A@%T$ii%@f$qv", buf, sizeof(buf),
+                            qual, base, 1);
+    CHECK_STR(buf, "A::T<int, int>::f()");
+    CHECK_STR(qual, "A::T<int, int>");
+
+    BorDebugUnmangle((char *)"@Foo@bar$qipxc", buf, sizeof(buf), 0, 0, 0);
+    CHECK_STR(buf, "Foo::bar");
+
+    kind = BorDebugUnmangle((char *)"@Foo@bar$qipxc", buf, 8, 0, 0, 1);
+    CHECK_STR(buf, "Foo::ba");
+    CHECK(kind & 0x1000000);
+}
+
+
+//---------------------------------------------------------------------
+
+static void bdCheckFile(const char * fileName, unsigned options)
+{
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie = BorDebugRegisterFileEx(fileName, options,
+                                                    &failure);
+
+    CHECK(cookie != 0);
+    CHECK(failure == 0);
+    if  (!cookie)
+        return;
+
+    bool    skipNames = (options & BORDEBUG_REGISTER_SKIPNAMES) != 0;
+
+    bdCheckSubSections(cookie);
+    bdCheckTypes(cookie);
+    bdCheckNames(cookie, skipNames);
+
+    // the rest look the names up as well
+    if  (!skipNames)
+    {
+        bdCheckModules(cookie);
+        bdCheckSymbols(cookie);
+        bdCheckLines(cookie);
+    }
+
+    BorDebugUnregisterFile(cookie);
+}
+
+
+static void bdCheckMemory(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+
+    CHECK(bdReadFile(fileName, image));
+    if  (image.empty())
+        return;
+
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie = BorDebugRegisterMemory(image.data(),
+                                                    image.size(), 0,
+                                                    &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (!cookie)
+        return;
+
+    bdCheckSubSections(cookie);
+    bdCheckSymbols(cookie);
+    bdCheckTypes(cookie);
+    bdCheckNames(cookie, false);
+
+    BorDebugUnregisterFile(cookie);
+}
+
+
+/*
+    Add an sstGlobalPub entry to the directory of sample.tds, which
+    has none.  It is the last thing in the file, so the entry goes at
+    the end.  It points at the symbols of the first module, which is
+    enough to be listed.
+*/
+
+static bool bdAddGlobalPub(std::vector<unsigned char> & image)
+{
+    if  (image.size() < 8)
+        return false;
+
+    uint32_t    dir   = bdGet32(&image[4]);
+    uint32_t    count = dir + 16 <= image.size() ? bdGet32(&image[dir + 4]) : 0;
+
+    if  (dir + 16 + (uint64_t)count * 12 != image.size() || count < 4)
+        return false;
+
+    unsigned char   entry[12];
+
+    memcpy(entry, &image[dir + 16 + 3 * 12], 12);
+    entry[0] = BORDEBUG_SSTGLOBALPUB & 0xFF;
+    entry[1] = BORDEBUG_SSTGLOBALPUB >> 8;
+    entry[2] = entry[3] = 0xFF;
+
+    image.insert(image.end(), entry, entry + 12);
+    bdPut32(&image[dir + 4], count + 1);
+    return true;
+}
+
+
+/*
+    Each BORDEBUG_REGISTER_SKIPXXXX option takes its subsections out
+    of the list, so their APIs find nothing, and the rest still work.
+*/
+
+static void bdCheckSkipped(const char * fileName)
+{
+    static const struct
+    {
+        unsigned    option;
+        unsigned    kind;
+        unsigned    skipped;
+    }
+    skips[] =
+    {
+        { BORDEBUG_REGISTER_SKIPMODULES,    BORDEBUG_SSTMODULE,     3 },
+        { BORDEBUG_REGISTER_SKIPSYMBOLS,    BORDEBUG_SSTALIGNSYM,   3 },
+        { BORDEBUG_REGISTER_SKIPLINES,      BORDEBUG_SSTSRCMODULE,  3 },
+        { BORDEBUG_REGISTER_SKIPGLOBALSYMS, BORDEBUG_SSTGLOBALPUB,  1 },
+    };
+    std::vector<unsigned char>  image;
+
+    CHECK(bdReadFile(fileName, image) && bdAddGlobalPub(image));
+    if  (image.empty())
+        return;
+
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie  = BorDebugRegisterMemory(image.data(), image.size(), 0, &failure);
+    unsigned        offset, size;
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (!cookie)
+        return;
+
+    CHECK(BorDebugSubSectionCount(cookie) == 12);
+    CHECK(bdFindSubSection(cookie, BORDEBUG_SSTGLOBALPUB, 0, &offset, &size));
+    BorDebugUnregisterFile(cookie);
+
+    for (const auto & skip : skips)
+    {
+        cookie = BorDebugRegisterMemory(image.data(), image.size(), skip.option, &failure);
+
+        CHECK(cookie != 0 && failure == 0);
+        if  (!cookie)
+            continue;
+
+        unsigned    count = BorDebugSubSectionCount(cookie);
+        unsigned    kind, module;
+
+        CHECK(count == 12 - skip.skipped);
+        CHECK(!bdFindSubSection(cookie, skip.kind, 0, &offset, &size));
+        CHECK(offset == 0 && size == 0);
+
+        BorDebugSubSection(cookie, count, &kind, &module, &offset, &size);
+        CHECK(kind == BORDEBUG_SSTINVALID && offset == 0 && size == 0);
+
+        CHECK(BorDebugSubSectionDirOffset(cookie) == 924);
+        bdCheckTypes(cookie);
+        bdCheckNames(cookie, false);
+
+        if  (skip.kind != BORDEBUG_SSTMODULE)
+            bdCheckModules(cookie);
+        if  (skip.kind != BORDEBUG_SSTALIGNSYM)
+            bdCheckSymbols(cookie);
+        if  (skip.kind != BORDEBUG_SSTSRCMODULE)
+            bdCheckLines(cookie);
+        if  (skip.kind != BORDEBUG_SSTGLOBALPUB)
+            CHECK(bdFindSubSection(cookie, BORDEBUG_SSTGLOBALPUB, 0, &offset, &size));
+
+        BorDebugUnregisterFile(cookie);
+    }
+}
+
+
+/*
+    BorDebugProbeFile reports what the directory of sample.tds holds,
+    and only a failure code for a file that is not a .tds.
+    BorDebugProbeFiles gives the same file by file.
+*/
+
+static void bdCheckProbe(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    CHECK(bdReadFile(fileName, image) && !dir.empty());
+    if  (image.size() < 8 || dir.empty())
+        return;
+
+    BorDebugProbeInfo   info;
+    unsigned            stamps[4] = { 0, 0, 0, 7 };
+
+    CHECK(BorDebugProbeFile(fileName, &info, stamps, 4) == 0);
+    CHECK(info.failure == 0);
+    CHECK(info.signature == bdGet32((const unsigned char *)"FB09"));
+    CHECK(info.dirOffset == 924 && info.subSectionCount == 11);
+    CHECK(info.moduleCount == 3 && info.alignSymCount == 3 && info.srcModuleCount == 3);
+    CHECK(info.globalSymCount == 0 && info.globalTypesCount == 1 && info.namesCount == 1);
+    CHECK(info.newestTimeStamp == 1002);
+    CHECK(stamps[0] == 1000 && stamps[1] == 1001 && stamps[2] == 1002 && stamps[3] == 7);
+
+    // no more stamps than asked for
+    memset(stamps, 0, sizeof(stamps));
+    CHECK(BorDebugProbeFile(fileName, 0, stamps, 2) == 0);
+    CHECK(stamps[0] == 1000 && stamps[1] == 1001 && stamps[2] == 0);
+
+    // the newest stamp from the first module, and a global sym entry
+    std::vector<unsigned char>  newer = image;
+    unsigned                    offset, size, failure = ~0u;
+    BorDebugCookie              cookie = BorDebugRegisterFileEx(fileName, 0, &failure);
+
+    CHECK(cookie != 0 && bdFindSubSection(cookie, BORDEBUG_SSTMODULE, 0, &offset, &size));
+    if  (cookie)
+        BorDebugUnregisterFile(cookie);
+
+    bdPut32(&newer[offset + 12], 5000);
+    CHECK(bdAddGlobalPub(newer));
+
+    std::vector<unsigned char>  junk(image.size());
+    std::vector<unsigned char>  truncated(image.begin(), image.begin() + image.size() / 2);
+
+    for (size_t i = 0; i < junk.size(); i++)
+        junk[i] = (unsigned char)(i * 7 + 3);
+
+    std::string     newerName     = dir + "/newer.tds";
+    std::string     junkName      = dir + "/junk.tds";
+    std::string     truncatedName = dir + "/truncated.tds";
+    std::string     otherName     = dir + "/sample.txt";
+    std::string     missingName   = dir + "/missing.tds";
+
+    CHECK(bdWriteFile(newerName.c_str(), newer));
+    CHECK(bdWriteFile(junkName.c_str(), junk));
+    CHECK(bdWriteFile(truncatedName.c_str(), truncated));
+    CHECK(bdWriteFile(otherName.c_str(), image));
+
+    CHECK(BorDebugProbeFile(newerName.c_str(), &info, stamps, 4) == 0);
+    CHECK(info.subSectionCount == 12 && info.globalSymCount == 1);
+    CHECK(info.newestTimeStamp == 5000 && stamps[0] == 5000 && stamps[2] == 1002);
+
+    CHECK(BorDebugProbeFile(junkName.c_str(), &info, 0, 0) == 3);
+    CHECK(info.failure == 3 && info.signature == 0 && info.subSectionCount == 0);
+    CHECK(info.newestTimeStamp == 0 && info.dirOffset == 0);
+    CHECK(BorDebugProbeFile(truncatedName.c_str(), &info, 0, 0) == 4 && info.failure == 4);
+    CHECK(BorDebugProbeFile(otherName.c_str(), &info, 0, 0) == 1 && info.failure == 1);
+    CHECK(BorDebugProbeFile(missingName.c_str(), &info, 0, 0) == 2);
+
+    // nothing but the failure code
+    BorDebugProbeInfo   missing;
+
+    memset(&missing, 0, sizeof(missing));
+    missing.failure = 2;
+    CHECK(memcmp(&info, &missing, sizeof(info)) == 0);
+
+    const char  * files[] =
+    {
+        fileName, newerName.c_str(), junkName.c_str(), truncatedName.c_str(),
+        otherName.c_str(), missingName.c_str(),
+    };
+    const unsigned  count = sizeof(files) / sizeof(files[0]);
+    std::vector<const char *>       list;
+
+    for (unsigned i = 0; i < 40; i++)
+        list.push_back(files[i % count]);
+
+    std::vector<BorDebugProbeInfo>  infos(list.size());
+
+    memset(&infos[0], 0xAA, infos.size() * sizeof(infos[0]));
+    BorDebugSetThreadCount(4);
+    BorDebugProbeFiles(&list[0], (unsigned)list.size(), &infos[0]);
+    BorDebugSetThreadCount(0);
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        BorDebugProbeFile(list[i], &info, 0, 0);
+        CHECK(memcmp(&infos[i], &info, sizeof(info)) == 0);
+    }
+
+    unlink(newerName.c_str());
+    unlink(junkName.c_str());
+    unlink(truncatedName.c_str());
+    unlink(otherName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    A damaged directory, whose sstNames entry points past the end of
+    the image, is turned down rather than read out of bounds.
+*/
+
+static void bdCheckDamaged(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+
+    CHECK(bdReadFile(fileName, image));
+    if  (image.size() < 8)
+        return;
+
+    uint32_t    dir   = bdGet32(&image[4]);
+    uint32_t    count = bdGet32(&image[dir + 4]);
+    uint32_t    entry = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if  (bdGet32(&image[dir + 16 + i * 12]) == (0xFFFFu << 16 | 0x130))
+            entry = dir + 16 + i * 12;
+    }
+
+    CHECK(entry != 0);
+    if  (!entry)
+        return;
+
+    for (int i = 0; i < 2; i++)
+    {
+        std::vector<unsigned char>  damaged = image;
+        unsigned                    failure = ~0u;
+
+        if  (i == 0)
+            bdPut32(&damaged[entry + 8], (uint32_t)image.size());
+        else
+            bdPut32(&damaged[entry + 4], (uint32_t)image.size() + 0x10000);
+
+        CHECK(BorDebugRegisterMemory(damaged.data(), damaged.size(), 0, &failure) == 0);
+        CHECK(failure == 4);
+    }
+
+    // the same as a mapped file
+    std::string     dirName  = bdTempDir();
+    std::string     copyName = dirName + "/damaged.tds";
+    unsigned        failure  = ~0u;
+
+    bdPut32(&image[entry + 8], (uint32_t)image.size());
+    CHECK(!dirName.empty() && bdWriteFile(copyName.c_str(), image));
+    CHECK(BorDebugRegisterFileEx(copyName.c_str(), BORDEBUG_REGISTER_MAP, &failure) == 0);
+    CHECK(failure == 4);
+
+    unlink(copyName.c_str());
+    rmdir(dirName.c_str());
+}
+
+
+/*
+    BorDebugRegisterIO backends: one that only reads, a few bytes at
+    a time, and one that maps the data, which must then never be
+    read.  Either way close is called once, also when registering
+    fails.
+*/
+
+struct BdTestIO
+{
+    const std::vector<unsigned char>  * image;
+    unsigned                            reads;
+    unsigned                            closes;
+};
+
+
+static size_t   bdTestRead(void * context, unsigned long long offset, void * buffer, size_t size)
+{
+    BdTestIO    * io = static_cast<BdTestIO *>(context);
+
+    io->reads++;
+
+    if  (offset >= io->image->size())
+        return 0;
+
+    size_t  got = io->image->size() - offset;
+
+    // short reads, so the library has to ask for the rest
+    if  (got > size)
+        got = size;
+    if  (got > 100)
+        got = 100;
+
+    memcpy(buffer, io->image->data() + offset, got);
+    return got;
+}
+
+
+static unsigned long long   bdTestSize(void * context)
+{
+    return static_cast<BdTestIO *>(context)->image->size();
+}
+
+
+static const void * bdTestMap(void * context)
+{
+    return static_cast<BdTestIO *>(context)->image->data();
+}
+
+
+static void bdTestClose(void * context)
+{
+    static_cast<BdTestIO *>(context)->closes++;
+}
+
+
+static void bdCheckIO(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+
+    CHECK(bdReadFile(fileName, image));
+    if  (image.empty())
+        return;
+
+    for (int i = 0; i < 2; i++)
+    {
+        BorDebugIO      io      = { bdTestRead, bdTestSize, i ? bdTestMap : 0, bdTestClose };
+        BdTestIO        context = { &image, 0, 0 };
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterIO(&io, &context,
+                                                     BORDEBUG_REGISTER_CACHENAMES,
+                                                     &failure);
+
+        CHECK(cookie != 0 && failure == 0);
+        if  (!cookie)
+            continue;
+
+        bdCheckSubSections(cookie);
+        bdCheckModules(cookie);
+        bdCheckSymbols(cookie);
+        bdCheckLines(cookie);
+        bdCheckTypes(cookie);
+        bdCheckNames(cookie, false);
+
+        CHECK(i ? context.reads == 0 : context.reads > 0);
+        CHECK(context.closes == 0);
+        BorDebugUnregisterFile(cookie);
+        CHECK(context.closes == 1);
+    }
+
+    // junk data, and a backend without read
+    std::vector<unsigned char>  junk(image.size(), 0x5A);
+    BdTestIO                    context = { &junk, 0, 0 };
+    BorDebugIO                  io      = { bdTestRead, bdTestSize, 0, bdTestClose };
+    unsigned                    failure = ~0u;
+
+    CHECK(BorDebugRegisterIO(&io, &context, 0, &failure) == 0);
+    CHECK(failure == 3);
+    CHECK(context.closes == 1);
+
+    io.read         = 0;
+    context.closes  = 0;
+    CHECK(BorDebugRegisterIO(&io, &context, 0, &failure) == 0);
+    CHECK(failure == 2);
+    CHECK(context.closes == 1);
+}
+
+
+/*
+    A sidecar whose type offsets point outside sstGlobalTypes, or
+    don't go up, must not be used: the indexes are built again and
+    the sidecar is rewritten.
+*/
+
+static void bdCheckBadSidecar(const char      * copyName,
+                              const char      * sidecarName,
+                              uint32_t          first,
+                              uint32_t          second)
+{
+    std::vector<unsigned char>  sidecar;
+
+    CHECK(bdReadFile(sidecarName, sidecar));
+    if  (sidecar.size() < 48)
+        return;
+
+    uint32_t    types;
+    uint32_t    header;
+
+    memcpy(&header, &sidecar[4], 4);
+    memcpy(&types, &sidecar[36], 4);
+    CHECK(types == 2 && header + 8 <= sidecar.size());
+    if  (types != 2 || header + 8 > sidecar.size())
+        return;
+
+    memcpy(&sidecar[header], &first, 4);
+    memcpy(&sidecar[header + 4], &second, 4);
+    CHECK(bdWriteFile(sidecarName, sidecar));
+
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName,
+                                                     BORDEBUG_REGISTER_INDEXCACHE,
+                                                     &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (!cookie)
+        return;
+
+    bdCheckTypes(cookie);
+    bdCheckSymbols(cookie);
+    BorDebugUnregisterFile(cookie);
+
+    // the rebuilt sidecar has the right offsets again
+    uint32_t    offsets[2] = { 1, 1 };
+
+    CHECK(bdReadFile(sidecarName, sidecar) && header + 8 <= sidecar.size());
+    if  (header + 8 <= sidecar.size())
+        memcpy(offsets, &sidecar[header], 8);
+    CHECK(offsets[0] == 0 && offsets[1] == 10);
+}
+
+
+static void bdCheckIndexCache(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdReadFile(fileName, image));
+    if  (dir.empty() || image.empty())
+        return;
+
+    std::string     copyName    = dir + "/sample.tds";
+    std::string     sidecarName = copyName + ".bdx";
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+
+    // the first registration writes the sidecar, the second uses it,
+    // and SKIPTYPES and SKIPMODULES have sidecars of their own
+    static const struct
+    {
+        unsigned    options;
+        bool        mapped;
+    }
+    steps[] =
+    {
+        { 0,                                false },
+        { 0,                                true  },
+        { BORDEBUG_REGISTER_SKIPTYPES,      false },
+        { BORDEBUG_REGISTER_SKIPTYPES,      true  },
+        { BORDEBUG_REGISTER_SKIPMODULES,    false },
+        { 0,                                true  },
+        { BORDEBUG_REGISTER_SKIPMODULES,    true  },
+    };
+    std::map<unsigned, ino_t>   inodes;
+
+    for (const auto & step : steps)
+    {
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName.c_str(),
+                                                         BORDEBUG_REGISTER_INDEXCACHE | step.options,
+                                                         &failure);
+
+        CHECK(cookie != 0 && failure == 0);
+        if  (!cookie)
+            continue;
+
+        if  (!(step.options & BORDEBUG_REGISTER_SKIPTYPES))
+            bdCheckTypes(cookie);
+        bdCheckNames(cookie, false);
+
+        BorDebugUnregisterFile(cookie);
+
+        // a sidecar that was written anew is another file
+        char            suffix[16] = ".bdx";
+        struct stat     st;
+
+        if  (step.options)
+            snprintf(suffix, sizeof(suffix), "-%03x.bdx", step.options);
+
+        CHECK(stat((copyName + suffix).c_str(), &st) == 0);
+        CHECK((st.st_ino == inodes[step.options]) == step.mapped);
+        inodes[step.options] = st.st_ino;
+    }
+
+    unlink((copyName + "-100.bdx").c_str());
+    unlink((copyName + "-010.bdx").c_str());
+
+    bdCheckBadSidecar(copyName.c_str(), sidecarName.c_str(), 0, 0xFFFFFFF0);
+    bdCheckBadSidecar(copyName.c_str(), sidecarName.c_str(), 10, 0);
+    bdCheckBadSidecar(copyName.c_str(), sidecarName.c_str(), 0, 34);
+
+    unlink(sidecarName.c_str());
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    Registrations with and without BORDEBUG_REGISTER_SKIPTYPES each
+    get a shared index of their own, and the second of each maps it.
+*/
+
+static void bdCheckSharedIndex(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdReadFile(fileName, image));
+    if  (dir.empty() || image.empty())
+        return;
+
+    std::string     copyName = dir + "/sample.tds";
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+    BorDebugRemoveSharedIndex(copyName.c_str());
+
+    for (int i = 0; i < 4; i++)
+    {
+        unsigned        options = BORDEBUG_REGISTER_SHAREDINDEX |
+                                  (i & 1 ? BORDEBUG_REGISTER_SKIPTYPES : 0);
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName.c_str(), options, &failure);
+        char            buf[256];
+
+        CHECK(cookie != 0 && failure == 0);
+        if  (!cookie)
+            continue;
+
+        BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+        CHECK_STR(buf, i & 1 ? "0x1000" : "int *");
+        bdCheckNames(cookie, false);
+        BorDebugUnregisterFile(cookie);
+    }
+
+    BorDebugRemoveSharedIndex(copyName.c_str());
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    Two registrations of a file with the same options, give or take
+    BORDEBUG_REGISTER_EAGER, share one copy of sstNames: their views
+    of a name are the same text.  Other SKIPTYPES or SKIPMODULES
+    options get a copy of their own.  The shared copy stays after
+    the registration that built it is gone.
+*/
+
+static const char * bdCachedView(BorDebugCookie cookie, unsigned name)
+{
+    const char  * text = 0;
+
+    CHECK(BorDebugNameIndexToNameView(cookie, name, &text) == 3);
+    CHECK(text && strncmp(text, "Foo", 3) == 0);
+
+    return text;
+}
+
+
+static void bdCheckSharing(const char * fileName)
+{
+    unsigned        failure = ~0u;
+    BorDebugCookie  builder = BorDebugRegisterFileEx(fileName, BORDEBUG_REGISTER_CACHENAMES, &failure);
+    BorDebugCookie  sharer  = BorDebugRegisterFileEx(fileName,
+                                                     BORDEBUG_REGISTER_CACHENAMES |
+                                                     BORDEBUG_REGISTER_EAGER,
+                                                     &failure);
+    BorDebugCookie  noTypes = BorDebugRegisterFileEx(fileName,
+                                                     BORDEBUG_REGISTER_CACHENAMES |
+                                                     BORDEBUG_REGISTER_SKIPTYPES,
+                                                     &failure);
+    BorDebugCookie  noMods  = BorDebugRegisterFileEx(fileName,
+                                                     BORDEBUG_REGISTER_CACHENAMES |
+                                                     BORDEBUG_REGISTER_SKIPMODULES,
+                                                     &failure);
+
+    CHECK(builder && sharer && noTypes && noMods);
+    if  (!builder || !sharer || !noTypes || !noMods)
+        return;
+
+    const char            * text = bdCachedView(builder, 22);
+    BorDebugMemoryUsage     usage;
+    char                    buf[256];
+
+    CHECK(bdCachedView(sharer, 22) == text);
+    CHECK(bdCachedView(noTypes, 22) != text);
+    CHECK(bdCachedView(noMods, 22) != text);
+    CHECK(bdCachedView(noMods, 22) != bdCachedView(noTypes, 22));
+
+    BorDebugGetMemoryUsage(sharer, &usage);
+    CHECK(usage.shared > 0 && usage.nameIndex == 0 && usage.nameText == 0);
+
+    BorDebugTypeIndexToString(builder, 0x1000, buf, sizeof(buf));
+    CHECK_STR(buf, "int *");
+    BorDebugTypeIndexToString(noTypes, 0x1000, buf, sizeof(buf));
+    CHECK_STR(buf, "0x1000");
+
+    // the builder goes first, the others keep what it built
+    BorDebugUnregisterFile(builder);
+
+    CHECK(bdCachedView(sharer, 22) == text);
+    BorDebugTypeIndexToString(sharer, 0x1000, buf, sizeof(buf));
+    CHECK_STR(buf, "int *");
+    bdCheckNames(sharer, false);
+
+    BorDebugCookie  later = BorDebugRegisterFileEx(fileName, BORDEBUG_REGISTER_CACHENAMES, &failure);
+
+    CHECK(later != 0);
+    if  (later)
+    {
+        CHECK(bdCachedView(later, 22) == text);
+        BorDebugUnregisterFile(later);
+    }
+
+    BorDebugUnregisterFile(sharer);
+    BorDebugUnregisterFile(noTypes);
+    BorDebugUnregisterFile(noMods);
+}
+
+
+/*
+    sample.tds with "extra" more names after its own, in "image"
+*/
+
+static bool bdManyNames(const char                   * fileName,
+                        unsigned                       extra,
+                        std::vector<unsigned char>   & image,
+                        std::vector<std::string>     & names)
+{
+    unsigned        failure;
+    BorDebugCookie  cookie = BorDebugRegisterFileEx(fileName, 0, &failure);
+    char            buf[512];
+
+    names.clear();
+
+    if  (!cookie || !bdReadFile(fileName, image))
+        return false;
+
+    for (unsigned i = 1; i <= BorDebugNamesTotalNames(cookie); i++)
+    {
+        BorDebugNameIndexToName(cookie, i, buf, sizeof(buf));
+        names.push_back(buf);
+    }
+
+    BorDebugUnregisterFile(cookie);
+
+    for (unsigned i = 0; i < extra; i++)
+    {
+        snprintf(buf, sizeof(buf), "@Ns%u@Cls%u@method%u$qqrx17System@AnsiStringi", i % 97, i % 1013, i);
+        names.push_back(buf);
+    }
+
+    return bdSetNames(image, names);
+}
+
+
+/*
+    A types lookup with BORDEBUG_REGISTER_INDEXCACHE and no sidecar
+    builds the name index as well, into the shared arena, but only
+    hands over the type index.  The cookie that holds the last
+    reference then frees the name index as it goes.
+*/
+
+static void bdCheckSharedTeardown(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 20000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    std::string     copyName = dir + "/names.tds";
+    char            buf[256];
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+
+    for (int i = 0; i < 2; i++)
+    {
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName.c_str(),
+                                                         BORDEBUG_REGISTER_INDEXCACHE,
+                                                         &failure);
+
+        CHECK(cookie != 0 && failure == 0);
+        if  (!cookie)
+            continue;
+
+        BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+        CHECK_STR(buf, "int *");
+
+        // the second time from the sidecar, names as well
+        if  (i == 1)
+        {
+            CHECK(BorDebugNamesTotalNames(cookie) == names.size());
+            BorDebugNameIndexToName(cookie, (unsigned)names.size(), buf, sizeof(buf));
+            CHECK_STR(buf, names.back().c_str());
+        }
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    unlink((copyName + ".bdx").c_str());
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    BorDebugReregisterFile after edits to sstNames: one name changed
+    in place, one grown, one inserted and one deleted, and names
+    over 255 bytes at the head, in the middle and at the tail.  The
+    names must be those of a registration of its own, and the ones
+    in front of and after the edit taken from the previous cookie.
+*/
+
+static std::vector<std::string> bdAllNames(BorDebugCookie cookie)
+{
+    std::vector<std::string>    names;
+
+    for (unsigned i = 1; i <= BorDebugNamesTotalNames(cookie); i++)
+    {
+        const char    * text = 0;
+        unsigned        len  = BorDebugNameIndexToNameView(cookie, i, &text);
+
+        names.push_back(std::string(text, len));
+    }
+
+    return names;
+}
+
+
+static void bdCheckReregister(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 3000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    std::string     longName = "@Long@" + std::string(300, 'x') + "$qv";
+    size_t          middle   = names.size() / 2;
+
+    names.insert(names.begin(), longName + "Head");
+    names.insert(names.begin() + middle, longName + "Middle");
+    names.push_back(longName + "Tail");
+    CHECK(bdSetNames(image, names));
+
+    // the time stamp of the second module
+    uint32_t    modOffset = 0;
+
+    for (uint32_t i = 0, dirOffset = bdGet32(&image[4]); i < bdGet32(&image[dirOffset + 4]); i++)
+    {
+        const unsigned char   * entry = &image[dirOffset + 16 + i * 12];
+
+        if  ((entry[0] | entry[1] << 8) == 0x120 && (entry[2] | entry[3] << 8) == 2)
+            modOffset = bdGet32(entry + 4);
+    }
+
+    CHECK(modOffset != 0);
+
+    std::string     baseName = dir + "/base.tds";
+
+    CHECK(bdWriteFile(baseName.c_str(), image));
+
+    static const unsigned   options[] = { 0, BORDEBUG_REGISTER_CACHENAMES, BORDEBUG_REGISTER_MAP };
+
+    for (unsigned option : options)
+    {
+        unsigned        failure = ~0u;
+        BorDebugCookie  base    = BorDebugRegisterFileEx(baseName.c_str(), option, &failure);
+
+        CHECK(base != 0);
+        if  (!base)
+            continue;
+
+        // the index must be there to be taken
+        CHECK(bdAllNames(base) == names);
+
+        for (int edit = 0; edit < 8; edit++)
+        {
+            std::vector<std::string>    edited = names;
+            std::vector<unsigned char>  image2 = image;
+            bool                        stamp  = false;
+
+            switch (edit)
+            {
+            case 0: edited[middle + 10][5] ^= 1;                                break;
+            case 1: edited[middle + 10] += "Grown";                             break;
+            case 2: edited.insert(edited.begin() + middle + 10, "@New@name$qv"); break;
+            case 3: edited.erase(edited.begin() + middle + 10);                 break;
+            case 4: edited.front() += "x";                                      break;
+            case 5: edited[middle] += "x";                                      break;
+            case 6: edited.back()  += "x";                                      break;
+            case 7: stamp = true;                                               break;
+            }
+
+            CHECK(bdSetNames(image2, edited));
+            if  (stamp)
+                bdPut32(&image2[modOffset + 12], bdGet32(&image2[modOffset + 12]) + 1);
+
+            char    editName[64];
+
+            snprintf(editName, sizeof(editName), "/edit%u-%d.tds", option, edit);
+
+            std::string             newName = dir + editName;
+            BorDebugReindexInfo     info;
+
+            CHECK(bdWriteFile(newName.c_str(), image2));
+
+            BorDebugCookie  cookie = BorDebugReregisterFile(base, newName.c_str(), option, &info, &failure);
+
+            // SKIPTYPES, so it builds an index of its own
+            BorDebugCookie  fresh  = BorDebugRegisterFileEx(newName.c_str(),
+                                                            option | BORDEBUG_REGISTER_SKIPTYPES,
+                                                            &failure);
+
+            CHECK(cookie != 0 && fresh != 0);
+            if  (cookie && fresh)
+            {
+                std::vector<std::string>    got = bdAllNames(cookie);
+
+                CHECK(got == edited);
+                CHECK(got == bdAllNames(fresh));
+
+                CHECK(info.names == edited.size());
+                CHECK(info.modules == 3);
+                CHECK(info.changedModules == (stamp ? 1u : 0u));
+
+                // all but the few names around the edit
+                CHECK(info.namesReused + 10 >= edited.size() && info.namesReused <= edited.size());
+            }
+
+            if  (cookie)
+                BorDebugUnregisterFile(cookie);
+            if  (fresh)
+                BorDebugUnregisterFile(fresh);
+
+            unlink(newName.c_str());
+        }
+
+        BorDebugUnregisterFile(base);
+    }
+
+    unlink(baseName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    BorDebugRegisterFiles on the worker threads gives for each file
+    what BorDebugRegisterFileEx gives: good copies, the same copy
+    many times, a truncated one, a missing one and one with another
+    extension.
+*/
+
+static void bdCheckRegisterFiles(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    CHECK(bdReadFile(fileName, image) && !dir.empty());
+    if  (image.empty() || dir.empty())
+        return;
+
+    std::vector<unsigned char>  truncated(image.begin(), image.begin() + image.size() / 2);
+    std::vector<std::string>    fileNames;
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        fileNames.push_back(dir + "/good" + std::to_string(i) + ".tds");
+        CHECK(bdWriteFile(fileNames.back().c_str(), image));
+    }
+
+    fileNames.push_back(dir + "/truncated.tds");
+    CHECK(bdWriteFile(fileNames.back().c_str(), truncated));
+    fileNames.push_back(dir + "/missing.tds");
+    fileNames.push_back(dir + "/good.txt");
+    CHECK(bdWriteFile(fileNames.back().c_str(), image));
+
+    std::vector<const char *>   list;
+
+    for (unsigned i = 0; i < 64; i++)
+        list.push_back(fileNames[i % fileNames.size()].c_str());
+
+    static const unsigned   options[] =
+    {
+        0,
+        BORDEBUG_REGISTER_EAGER,
+        BORDEBUG_REGISTER_CACHENAMES | BORDEBUG_REGISTER_EAGER,
+        BORDEBUG_REGISTER_MAP,
+        BORDEBUG_REGISTER_SKIPNAMES,
+    };
+
+    BorDebugSetThreadCount(4);
+
+    for (unsigned option : options)
+    {
+        std::vector<BorDebugCookie> cookies(list.size());
+        std::vector<unsigned>       failures(list.size(), ~0u);
+
+        BorDebugRegisterFiles(&list[0], (unsigned)list.size(), option, &cookies[0], &failures[0]);
+
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            unsigned        failure    = ~0u;
+            BorDebugCookie  registered = BorDebugRegisterFileEx(list[i], option, &failure);
+
+            CHECK(failures[i] == failure);
+            CHECK((cookies[i] != 0) == (registered != 0));
+
+            // a cookie of its own each time
+            for (size_t j = 0; j < i && cookies[i]; j++)
+                CHECK(cookies[j] != cookies[i]);
+
+            if  (cookies[i])
+            {
+                bdCheckSubSections(cookies[i]);
+                bdCheckTypes(cookies[i]);
+                bdCheckNames(cookies[i], (option & BORDEBUG_REGISTER_SKIPNAMES) != 0);
+            }
+
+            if  (registered)
+                BorDebugUnregisterFile(registered);
+        }
+
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            if  (cookies[i])
+                BorDebugUnregisterFile(cookies[i]);
+        }
+    }
+
+    // without failures
+    std::vector<BorDebugCookie> cookies(list.size());
+
+    BorDebugRegisterFiles(&list[0], (unsigned)list.size(), 0, &cookies[0], 0);
+
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        CHECK((cookies[i] != 0) == (i % fileNames.size() < 4));
+        if  (cookies[i])
+            BorDebugUnregisterFile(cookies[i]);
+    }
+
+    BorDebugSetThreadCount(0);
+
+    unsigned    failure = ~0u;
+
+    CHECK(BorDebugRegisterFileEx(fileNames[4].c_str(), 0, &failure) == 0 && failure == 4);
+
+    for (size_t i = 0; i < fileNames.size(); i++)
+        unlink(fileNames[i].c_str());
+
+    rmdir(dir.c_str());
+}
+
+
+/*
+    BORDEBUG_REGISTER_ASYNC, with workers to build the indexes on:
+    lookups made while the build may still run give what
+    BORDEBUG_REGISTER_EAGER gives, and unregistering while it runs
+    is safe.
+*/
+
+static void bdCheckAsync(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 100000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    std::string     copyName = dir + "/async.tds";
+    unsigned        failure  = ~0u;
+    char            buf[256];
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+    BorDebugSetThreadCount(4);
+
+    // the last names first, the build gets to them last
+    BorDebugCookie  cookie = BorDebugRegisterFileEx(copyName.c_str(), BORDEBUG_REGISTER_ASYNC, &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (cookie)
+    {
+        unsigned    count = BorDebugNamesTotalNames(cookie);
+
+        CHECK(count == names.size());
+        for (unsigned i = count; i > count - 100 && i > 0; i--)
+        {
+            BorDebugNameIndexToName(cookie, i, buf, sizeof(buf));
+            CHECK_STR(buf, names[i - 1].c_str());
+        }
+
+        BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+        CHECK_STR(buf, "int *");
+        CHECK(BorDebugIndexReady(cookie, BORDEBUG_INDEX_TYPES | BORDEBUG_INDEX_NAMES) == 1);
+
+        std::vector<std::string>    async = bdAllNames(cookie);
+
+        BorDebugUnregisterFile(cookie);
+
+        cookie = BorDebugRegisterFileEx(copyName.c_str(), BORDEBUG_REGISTER_EAGER, &failure);
+        CHECK(cookie != 0);
+        if  (cookie)
+        {
+            CHECK(bdAllNames(cookie) == async);
+            BorDebugUnregisterFile(cookie);
+        }
+    }
+
+    // gone before the build is done, or while it runs
+    for (int i = 0; i < 20; i++)
+    {
+        cookie = BorDebugRegisterFileEx(copyName.c_str(),
+                                        BORDEBUG_REGISTER_ASYNC | (i & 1 ? BORDEBUG_REGISTER_CACHENAMES : 0),
+                                        &failure);
+        CHECK(cookie != 0);
+        if  (!cookie)
+            continue;
+
+        if  (i & 2)
+            BorDebugIndexReady(cookie, BORDEBUG_INDEX_NAMES);
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    // back to one per CPU
+    BorDebugSetThreadCount(0);
+
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    An allocator that keeps track of its blocks: after the files are
+    unregistered each block must be freed once, with the size it was
+    allocated with.
+*/
+
+struct BdCountingAllocator
+{
+    std::mutex                  lock;
+    std::map<void *, size_t>    blocks;
+    unsigned                    allocs;
+    unsigned                    badFrees;
+};
+
+
+static void *   bdCountingAlloc(void * context, size_t size)
+{
+    BdCountingAllocator       * a     = static_cast<BdCountingAllocator *>(context);
+    void                      * block = malloc(size);
+    std::lock_guard<std::mutex> hold(a->lock);
+
+    if  (block)
+    {
+        a->blocks[block] = size;
+        a->allocs++;
+    }
+
+    return block;
+}
+
+
+static void bdCountingFree(void * context, void * block, size_t size)
+{
+    BdCountingAllocator       * a = static_cast<BdCountingAllocator *>(context);
+    std::lock_guard<std::mutex> hold(a->lock);
+    auto                        found = a->blocks.find(block);
+
+    if  (found == a->blocks.end() || found->second != size)
+        a->badFrees++;
+    else
+        a->blocks.erase(found);
+
+    free(block);
+}
+
+
+static void bdCheckAllocator(const char * fileName)
+{
+    BdCountingAllocator     counting;
+    BorDebugAllocator       allocator = { bdCountingAlloc, bdCountingFree, &counting };
+
+    counting.allocs   = 0;
+    counting.badFrees = 0;
+
+    BorDebugSetAllocator(&allocator);
+
+    static const unsigned   options[] =
+    {
+        0,
+        BORDEBUG_REGISTER_CACHENAMES,
+        BORDEBUG_REGISTER_MAP,
+        BORDEBUG_REGISTER_EAGER,
+    };
+
+    std::vector<BorDebugCookie> cookies;
+    char                        buf[256];
+
+    // twice each, so the second shares the indexes of the first
+    for (int i = 0; i < 2; i++)
+    {
+        for (unsigned option : options)
+        {
+            unsigned        failure = ~0u;
+            BorDebugCookie  cookie  = BorDebugRegisterFileEx(fileName, option, &failure);
+
+            CHECK(cookie != 0);
+            if  (!cookie)
+                continue;
+
+            bdCheckSymbols(cookie);
+            bdCheckTypes(cookie);
+            bdCheckNames(cookie, false);
+            BorDebugNameIndexToUnmangledName(cookie, 2, buf, sizeof(buf));
+            cookies.push_back(cookie);
+        }
+    }
+
+    // files registered from now on don't use it
+    BorDebugSetAllocator(0);
+
+    unsigned        failure = ~0u;
+    BorDebugCookie  other   = BorDebugRegisterFileEx(fileName, BORDEBUG_REGISTER_SKIPTYPES, &failure);
+    unsigned        allocs  = counting.allocs;
+
+    CHECK(other != 0);
+    if  (other)
+    {
+        bdCheckNames(other, false);
+        BorDebugUnregisterFile(other);
+    }
+
+    CHECK(counting.allocs == allocs);
+
+    for (size_t i = 0; i < cookies.size(); i++)
+        BorDebugUnregisterFile(cookies[i]);
+
+    CHECK(counting.allocs > 0);
+    CHECK(counting.blocks.empty());
+    CHECK(counting.badFrees == 0);
+}
+
+
+/*
+    A memory budget far below the size of sstNames: the names are
+    read through the page cache, which stays within the budget with
+    the unmangled names, and every name still comes out right.  A
+    budget the section fits in keeps it in one piece.
+*/
+
+static void bdCheckBudget(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 20000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    std::string     copyName = dir + "/budget.tds";
+    const unsigned  budget   = 0x10000;
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+
+    static const unsigned   options[] = { 0, BORDEBUG_REGISTER_CACHENAMES };
+
+    for (unsigned option : options)
+    {
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName.c_str(), option, &failure);
+        char            buf[256];
+
+        CHECK(cookie != 0);
+        if  (!cookie)
+            continue;
+
+        BorDebugSetMemoryBudget(cookie, budget);
+
+        // front to back, then jumping about, so pages are dropped
+        // and read again
+        CHECK(bdAllNames(cookie) == names);
+
+        for (unsigned i = 0; i < names.size(); i += 997)
+        {
+            unsigned    name = (unsigned)((i * 7919ull) % names.size()) + 1;
+
+            BorDebugNameIndexToName(cookie, name, buf, sizeof(buf));
+            CHECK_STR(buf, names[name - 1].c_str());
+            BorDebugNameIndexToUnmangledName(cookie, name, buf, sizeof(buf));
+        }
+
+        BorDebugMemoryUsage     usage;
+
+        BorDebugGetMemoryUsage(cookie, &usage);
+        CHECK(usage.budget == budget);
+        CHECK(usage.nameText > 0 && usage.nameText + usage.unmangled <= budget);
+        CHECK(usage.nameTextHits > 0 && usage.nameTextMisses > 0 && usage.nameTextEvictions > 0);
+
+        // room for all of it: the second time round nothing is read
+        BorDebugSetMemoryBudget(cookie, image.size() * 2);
+        CHECK(bdAllNames(cookie) == names);
+        BorDebugGetMemoryUsage(cookie, &usage);
+
+        unsigned long long  misses = usage.nameTextMisses;
+
+        CHECK(bdAllNames(cookie) == names);
+        BorDebugGetMemoryUsage(cookie, &usage);
+        CHECK(usage.nameTextMisses == misses);
+        CHECK(usage.nameText <= image.size() * 2);
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    // a budget after the index was built next to a copy of its own,
+    // which only BorDebugRegisterIO has, makes the index compact
+    BorDebugIO          io      = { bdTestRead, bdTestSize, 0, bdTestClose };
+    BdTestIO            context = { &image, 0, 0 };
+    unsigned            failure = ~0u;
+    BorDebugCookie      cookie  = BorDebugRegisterIO(&io, &context, BORDEBUG_REGISTER_CACHENAMES, &failure);
+    BorDebugMemoryUsage usage;
+
+    CHECK(cookie != 0);
+    if  (cookie)
+    {
+        CHECK(bdAllNames(cookie) == names);
+        BorDebugGetMemoryUsage(cookie, &usage);
+        CHECK(usage.nameIndex >= names.size() * 4);
+
+        BorDebugSetMemoryBudget(cookie, budget);
+        BorDebugGetMemoryUsage(cookie, &usage);
+        CHECK(usage.nameIndex < names.size() * 2);
+        CHECK(bdAllNames(cookie) == names);
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    BorDebugNameIndexToNameView gives the text and length that
+    BorDebugNameIndexToName copies, names over 255 bytes included.
+    In memory, with BORDEBUG_REGISTER_MAP or CACHENAMES, the text
+    stays where it is while the file is registered.
+*/
+
+static void bdCheckNameViews(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 2000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    names.insert(names.begin() + 1000, "@Long@" + std::string(400, 'v') + "$qv");
+    names.push_back("@Long@" + std::string(300, 'w') + "$qv");
+    CHECK(bdSetNames(image, names));
+
+    std::string     copyName = dir + "/views.tds";
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+
+    static const unsigned   options[] = { 0, BORDEBUG_REGISTER_CACHENAMES, BORDEBUG_REGISTER_MAP };
+
+    for (unsigned option : options)
+    {
+        unsigned        failure = ~0u;
+        BorDebugCookie  cookie  = BorDebugRegisterFileEx(copyName.c_str(), option, &failure);
+        char            buf[1024];
+
+        CHECK(cookie != 0);
+        if  (!cookie)
+            continue;
+
+        std::vector<const char *>   texts;
+
+        for (unsigned i = 1; i <= names.size(); i++)
+        {
+            const char    * text = 0;
+            unsigned        len  = BorDebugNameIndexToNameView(cookie, i, &text);
+
+            BorDebugNameIndexToName(cookie, i, buf, sizeof(buf));
+            CHECK(len == strlen(buf) && len == names[i - 1].size());
+            CHECK(text && memcmp(text, buf, len) == 0);
+            texts.push_back(text);
+        }
+
+        const char    * text = 0;
+
+        CHECK(BorDebugNameIndexToNameView(cookie, (unsigned)names.size() + 1, &text) == 0);
+        CHECK(text && *text == 0);
+
+        // other calls in between don't move names that are in memory
+        if  (option)
+        {
+            CHECK(bdAllNames(cookie) == names);
+            BorDebugNameIndexToUnmangledName(cookie, 2, buf, sizeof(buf));
+            BorDebugTypeIndexToString(cookie, 0x1000, buf, sizeof(buf));
+
+            for (unsigned i = 1; i <= names.size(); i++)
+            {
+                CHECK(BorDebugNameIndexToNameView(cookie, i, &text) == names[i - 1].size());
+                CHECK(text == texts[i - 1]);
+                CHECK(memcmp(texts[i - 1], names[i - 1].data(), names[i - 1].size()) == 0);
+            }
+        }
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+/*
+    BorDebugNameIndexToUnmangledNameView and BorDebugUnmangleNames
+    keep the names BorDebugNameIndexToUnmangledName gives, in place
+    while the file is registered.  SHOW_TROUBLED_NAME set for a call
+    gives the troubled text without touching the kept names.
+*/
+
+static void bdCheckUnmangledViews(const char * fileName)
+{
+    std::vector<unsigned char>  image;
+    std::vector<std::string>    names;
+    std::string                 dir = bdTempDir();
+
+    CHECK(!dir.empty() && bdManyNames(fileName, 5000, image, names));
+    if  (dir.empty() || names.empty())
+        return;
+
+    std::string     copyName = dir + "/unmangled.tds";
+    unsigned        failure  = ~0u;
+    char            buf[1024];
+
+    CHECK(bdWriteFile(copyName.c_str(), image));
+
+    // what one name at a time gives
+    std::vector<std::string>    unmangled;
+    BorDebugCookie              cookie = BorDebugRegisterFileEx(copyName.c_str(), 0, &failure);
+
+    CHECK(cookie != 0);
+    if  (!cookie)
+        return;
+
+    for (unsigned i = 1; i <= names.size(); i++)
+    {
+        BorDebugNameIndexToUnmangledName(cookie, i, buf, sizeof(buf));
+        unmangled.push_back(buf);
+    }
+
+    BorDebugUnregisterFile(cookie);
+
+    for (int all = 0; all < 2; all++)
+    {
+        cookie = BorDebugRegisterFileEx(copyName.c_str(), 0, &failure);
+        CHECK(cookie != 0);
+        if  (!cookie)
+            continue;
+
+        if  (all)
+        {
+            CHECK(BorDebugUnmangleNames(cookie) == names.size());
+
+            BorDebugMemoryUsage usage;
+
+            BorDebugGetMemoryUsage(cookie, &usage);
+            CHECK(usage.unmangledNames == names.size());
+        }
+
+        std::vector<const char *>   texts;
+
+        for (unsigned i = 1; i <= names.size(); i++)
+        {
+            const char    * text = 0;
+            unsigned        len  = BorDebugNameIndexToUnmangledNameView(cookie, i, &text);
+
+            CHECK(text && len == unmangled[i - 1].size() && text[len] == 0);
+            CHECK_STR(text, unmangled[i - 1].c_str());
+            texts.push_back(text);
+        }
+
+        // "@bad@$z" troubled, and then as it was kept
+        const char    * text = 0;
+
+        setenv("SHOW_TROUBLED_NAME", "1", 1);
+        BorDebugNameIndexToUnmangledNameView(cookie, 9, &text);
+        CHECK(text != texts[8] && strstr(text, "@bad@$z") != 0);
+        BorDebugNameIndexToUnmangledName(cookie, 10, buf, sizeof(buf));
+        unsetenv("SHOW_TROUBLED_NAME");
+
+        for (unsigned i = 1; i <= names.size(); i++)
+        {
+            CHECK(BorDebugNameIndexToUnmangledNameView(cookie, i, &text) == unmangled[i - 1].size());
+            CHECK(text == texts[i - 1]);
+            CHECK_STR(texts[i - 1], unmangled[i - 1].c_str());
+        }
+
+        CHECK(BorDebugNameIndexToUnmangledNameView(cookie, (unsigned)names.size() + 1, &text) == 0);
+        CHECK(text && *text == 0);
+
+        BorDebugUnregisterFile(cookie);
+    }
+
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+}
+
+
+static void bdCheckFailures(const char * fileName)
+{
+    unsigned    failure = 0;
+
+    CHECK(BorDebugRegisterFile("no-such-file.tds", 0, 0, &failure) == 0);
+    CHECK(failure == 2);
+
+    std::string     other = std::string(fileName) + ".txt";
+    CHECK(BorDebugRegisterFile(other.c_str(), 0, 0, &failure) == 0);
+    CHECK(failure == 1);
+}
+
+
+/*
+    BorDebugUnmangleEx gives what BorDebugUnmangle gives with
+    SHOW_TROUBLED_NAME as showTroubled says, from several threads at
+    once, and BorDebugUnmangleBatch what it gives one name at a time.
+*/
+
+static void bdCheckUnmangleBatch()
+{
+    std::vector<std::string>    names =
+    {
+        "@System@AnsiString@$bctr$qqrv", "@Foo@bar$qipxc", "@bad@$z", "plain_c_name",
+        "@std@%vector$i%@size$xqv", "@$xt$14System@TObject", "@A@%T$ii%@f$qv", "",
+    };
+
+    for (unsigned i = 0; i < 500; i++)
+        names.push_back("@Ns" + std::to_string(i % 7) + "@Cls" + std::to_string(i) +
+                        "@method$qqrx17System@AnsiStringi" + std::string(i % 5, 'i'));
+
+    // longer unmangled than the default buffer of BorDebugUnmangle
+    std::string     args;
+
+    for (unsigned i = 0; i < 200; i++)
+        args += "x17System@AnsiString";
+
+    names.push_back("@Long@f$q" + args);
+
+    std::vector<const char *>   src;
+
+    for (size_t i = 0; i < names.size(); i++)
+        src.push_back(names[i].c_str());
+
+    // so the batch is spread over workers on any machine
+    BorDebugSetThreadCount(4);
+
+    for (int troubled = 0; troubled < 2; troubled++)
+    {
+        for (int doArgs = 0; doArgs < 2; doArgs++)
+        {
+            std::vector<std::string>    want;
+            std::vector<unsigned>       kinds;
+
+            // the old API, with the environment variable
+            if  (troubled)
+                setenv("SHOW_TROUBLED_NAME", "1", 1);
+
+            for (size_t i = 0; i < names.size(); i++)
+            {
+                std::vector<char>   name(names[i].begin(), names[i].end());
+                char                dest[8192];
+                char                qual[8192]   = "";
+                char                base[8192]   = "";
+                char                exDest[8192];
+                char                exQual[8192] = "";
+                char                exBase[8192] = "";
+
+                // a name that isn't mangled leaves qual and base as
+                // they are
+                name.push_back(0);
+
+                unsigned    kind   = BorDebugUnmangle(&name[0], dest, sizeof(dest), qual, base, doArgs);
+                unsigned    exKind = BorDebugUnmangleEx(src[i], exDest, sizeof(exDest), exQual, exBase,
+                                                        doArgs, troubled);
+
+                CHECK(kind == exKind);
+                CHECK_STR(exDest, dest);
+                CHECK_STR(exQual, qual);
+                CHECK_STR(exBase, base);
+
+                want.push_back(dest);
+                kinds.push_back(kind);
+            }
+
+            unsetenv("SHOW_TROUBLED_NAME");
+
+            // a few names at a time
+            std::vector<unsigned>       starts(names.size());
+            std::vector<BorDebugUmKind> got(names.size());
+            std::vector<char>           buf(6000);
+            unsigned                    done = 0;
+
+            while (done < names.size())
+            {
+                unsigned    count = BorDebugUnmangleBatch(&src[done], (unsigned)names.size() - done,
+                                                          doArgs, troubled, &buf[0], (unsigned)buf.size(),
+                                                          &starts[0], &got[0]);
+
+                CHECK(count > 0);
+                if  (count == 0)
+                    break;
+
+                for (unsigned i = 0; i < count; i++)
+                {
+                    CHECK_STR(&buf[starts[i]], want[done + i].c_str());
+                    CHECK((unsigned)got[i] == kinds[done + i]);
+                }
+
+                done += count;
+            }
+
+            // from several threads, each the whole list
+            std::vector<std::thread>    threads;
+            unsigned                    wrong[4] = { 0, 0, 0, 0 };
+
+            for (unsigned t = 0; t < 4; t++)
+            {
+                threads.emplace_back([&, t]
+                {
+                    char    dest[8192];
+
+                    for (size_t i = 0; i < names.size(); i++)
+                    {
+                        unsigned    kind = BorDebugUnmangleEx(src[i], dest, sizeof(dest), 0, 0,
+                                                              doArgs, troubled);
+
+                        if  (kind != kinds[i] || want[i] != dest)
+                            wrong[t]++;
+                    }
+                });
+            }
+
+            for (size_t t = 0; t < threads.size(); t++)
+                threads[t].join();
+
+            CHECK(wrong[0] + wrong[1] + wrong[2] + wrong[3] == 0);
+        }
+    }
+
+    BorDebugSetThreadCount(0);
+
+    // not even the first name fits
+    unsigned    start;
+    char        small[4];
+
+    CHECK(BorDebugUnmangleBatch(&src[0], 1, 1, 0, small, sizeof(small), &start, 0) == 0);
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc != 2)
+    {
+        fprintf(stderr, "usage: %s sample.tds\n", argv[0]);
+        return 2;
+    }
+
+    static const unsigned   options[] =
+    {
+        0,
+        BORDEBUG_REGISTER_CACHENAMES,
+        BORDEBUG_REGISTER_SKIPNAMES,
+        BORDEBUG_REGISTER_MAP,
+        BORDEBUG_REGISTER_EAGER,
+    };
+
+    for (unsigned option : options)
+        bdCheckFile(argv[1], option);
+
+    bdCheckMemory(argv[1]);
+    bdCheckSkipped(argv[1]);
+    bdCheckProbe(argv[1]);
+    bdCheckDamaged(argv[1]);
+    bdCheckIO(argv[1]);
+    bdCheckIndexCache(argv[1]);
+    bdCheckSharing(argv[1]);
+    bdCheckSharedIndex(argv[1]);
+    bdCheckSharedTeardown(argv[1]);
+    bdCheckReregister(argv[1]);
+    bdCheckRegisterFiles(argv[1]);
+    bdCheckAsync(argv[1]);
+    bdCheckAllocator(argv[1]);
+    bdCheckBudget(argv[1]);
+    bdCheckNameViews(argv[1]);
+    bdCheckUnmangledViews(argv[1]);
+    bdCheckUnmangle();
+    bdCheckUnmangleBatch();
+    bdCheckFailures(argv[1]);
+
+    return bdCheckResult("bdcheck");
+}
@@ -0,0 +1,308 @@
+//---------------------------------------------------------------------
+
+/*
+    Checks the file pool: BorDebugPoolAcquire and the rest, and the
+    reload of files acquired with BORDEBUG_REGISTER_WATCH.
+
+    The test works on copies of sample.tds in a directory of its own.
+
+    usage: bdfiles sample.tds
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bordebug.h"
+#include "bdtest.h"
+
+
+//---------------------------------------------------------------------
+
+static std::string  bdLastName(BorDebugCookie cookie)
+{
+    char    buf[256];
+
+    BorDebugNameIndexToName(cookie, BorDebugNamesTotalNames(cookie), buf, sizeof(buf));
+    return buf;
+}
+
+
+/*
+    Acquire and release, so the file is in the pool but not in use
+*/
+
+static void bdTouch(const std::string & fileName)
+{
+    unsigned        failure = ~0u;
+    BorDebugCookie  cookie  = BorDebugPoolAcquire(fileName.c_str(), 0, &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (cookie)
+        BorDebugPoolRelease(cookie);
+}
+
+
+/*
+    Hits and misses, reference counts, least recently used files
+    dropped first under both limits, and files in use never dropped.
+*/
+
+static void bdCheckPool(const std::string & dir, const std::vector<unsigned char> & image)
+{
+    std::string         a = dir + "/a.tds";
+    std::string         b = dir + "/b.tds";
+    std::string         c = dir + "/c.tds";
+    BorDebugPoolStats   stats;
+    unsigned            failure = ~0u;
+
+    CHECK(bdWriteFile(a.c_str(), image));
+    CHECK(bdWriteFile(b.c_str(), image));
+    CHECK(bdWriteFile(c.c_str(), image));
+
+    BorDebugPoolFlush();
+    BorDebugPoolGetStats(&stats);
+
+    unsigned long long  hits      = stats.hits;
+    unsigned long long  misses    = stats.misses;
+    unsigned long long  evictions = stats.evictions;
+
+    CHECK(stats.files == 0 && stats.inUse == 0);
+
+    // the same file twice is one registration with two references
+    BorDebugCookie  first  = BorDebugPoolAcquire(a.c_str(), 0, &failure);
+    BorDebugCookie  second = BorDebugPoolAcquire(a.c_str(), 0, &failure);
+
+    CHECK(first != 0 && second == first);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.misses == misses + 1 && stats.hits == hits + 1);
+    CHECK(stats.files == 1 && stats.inUse == 1);
+
+    // other options are another registration
+    BorDebugCookie  other = BorDebugPoolAcquire(a.c_str(), BORDEBUG_REGISTER_CACHENAMES, &failure);
+
+    CHECK(other != 0 && other != first);
+    BorDebugPoolRelease(other);
+
+    BorDebugPoolRelease(first);
+    BorDebugPoolFlush();
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 1 && stats.inUse == 1);
+    CHECK(BorDebugNamesTotalNames(second) == 22);
+
+    BorDebugPoolRelease(second);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 1 && stats.inUse == 0);
+
+    BorDebugPoolFlush();
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 0 && stats.evictions == evictions + 2);
+
+    // two files at most: c pushes out a, the least recently used
+    BorDebugPoolSetLimits(2, 0);
+    bdTouch(a);
+    bdTouch(b);
+    bdTouch(c);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 2 && stats.evictions == evictions + 3);
+
+    misses = stats.misses;
+    bdTouch(b);
+    bdTouch(c);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.misses == misses);
+
+    // now b is the oldest
+    bdTouch(a);
+    bdTouch(c);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.misses == misses + 1 && stats.evictions == evictions + 4);
+
+    misses = stats.misses;
+    bdTouch(b);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.misses == misses + 1);
+
+    // room for two and a half files by bytes
+    BorDebugPoolFlush();
+    BorDebugPoolSetLimits(0, 0);
+    bdTouch(a);
+    BorDebugPoolGetStats(&stats);
+
+    unsigned long long  bytes = stats.bytes;
+
+    CHECK(bytes > 0);
+    BorDebugPoolSetLimits(0, bytes * 5 / 2);
+    evictions = stats.evictions;
+    bdTouch(b);
+    bdTouch(c);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 2 && stats.evictions == evictions + 1);
+    CHECK(stats.bytes <= bytes * 5 / 2);
+
+    misses = stats.misses;
+    bdTouch(b);
+    bdTouch(c);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.misses == misses);
+
+    // a file in use stays, over the limits and through a flush
+    BorDebugPoolFlush();
+    BorDebugPoolSetLimits(1, 0);
+
+    BorDebugCookie  held = BorDebugPoolAcquire(a.c_str(), 0, &failure);
+
+    CHECK(held != 0);
+    bdTouch(b);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 1 && stats.inUse == 1);
+
+    BorDebugPoolFlush();
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 1 && stats.inUse == 1);
+
+    char    buf[256];
+
+    BorDebugNameIndexToName(held, 22, buf, sizeof(buf));
+    CHECK_STR(buf, "Foo");
+
+    hits = stats.hits;
+    CHECK(BorDebugPoolAcquire(a.c_str(), 0, &failure) == held);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.hits == hits + 1);
+
+    BorDebugPoolRelease(held);
+    BorDebugPoolRelease(held);
+    BorDebugPoolFlush();
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.files == 0 && stats.inUse == 0);
+
+    BorDebugPoolSetLimits(64, 0);
+
+    unlink(a.c_str());
+    unlink(b.c_str());
+    unlink(c.c_str());
+}
+
+
+/*
+    A new build renamed over a watched file is swapped in on the
+    watcher thread.  The next acquire gets it, while the cookie of
+    the old build keeps its names until it is released.
+*/
+
+static void bdCheckWatch(const std::string & dir, const std::vector<unsigned char> & image)
+{
+    // without inotify BORDEBUG_REGISTER_WATCH has no effect
+    int     fd = inotify_init1(IN_CLOEXEC);
+
+    if  (fd < 0)
+    {
+        printf("bdfiles: watch skipped, no inotify\n");
+        return;
+    }
+
+    close(fd);
+
+    std::string                 fileName = dir + "/watch.tds";
+    std::string                 newName  = dir + "/watch.new";
+    std::vector<unsigned char>  image2   = image;
+    unsigned                    failure  = ~0u;
+
+    CHECK(bdWriteFile(fileName.c_str(), image));
+
+    BorDebugCookie  old = BorDebugPoolAcquire(fileName.c_str(), BORDEBUG_REGISTER_WATCH, &failure);
+
+    CHECK(old != 0 && failure == 0);
+    if  (!old)
+        return;
+
+    std::vector<std::string>    names;
+    unsigned                    count = BorDebugNamesTotalNames(old);
+    char                        buf[256];
+
+    for (unsigned i = 1; i <= count; i++)
+    {
+        BorDebugNameIndexToName(old, i, buf, sizeof(buf));
+        names.push_back(buf);
+    }
+
+    names.push_back("@Build2@$bctr$qv");
+    CHECK(bdSetNames(image2, names));
+    CHECK(bdWriteFile(newName.c_str(), image2));
+
+    BorDebugPoolStats   stats;
+
+    BorDebugPoolGetStats(&stats);
+
+    unsigned long long  reloads = stats.reloads;
+    unsigned            retired = stats.retired;
+
+    CHECK(rename(newName.c_str(), fileName.c_str()) == 0);
+
+    for (int i = 0; i < 500 && stats.reloads == reloads; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        BorDebugPoolGetStats(&stats);
+    }
+
+    CHECK(stats.reloads == reloads + 1);
+    CHECK(stats.retired == retired + 1);
+
+    BorDebugCookie  cookie = BorDebugPoolAcquire(fileName.c_str(), BORDEBUG_REGISTER_WATCH, &failure);
+
+    CHECK(cookie != 0 && cookie != old && failure == 0);
+    if  (cookie)
+    {
+        CHECK(BorDebugNamesTotalNames(cookie) == count + 1);
+        CHECK_STR(bdLastName(cookie).c_str(), "@Build2@$bctr$qv");
+    }
+
+    // the old build is untouched by the reload
+    CHECK(BorDebugNamesTotalNames(old) == count);
+    CHECK_STR(bdLastName(old).c_str(), names[count - 1].c_str());
+
+    BorDebugPoolRelease(old);
+    BorDebugPoolGetStats(&stats);
+    CHECK(stats.retired == retired);
+
+    if  (cookie)
+        BorDebugPoolRelease(cookie);
+
+    BorDebugPoolFlush();
+    unlink(fileName.c_str());
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc != 2)
+    {
+        fprintf(stderr, "usage: %s sample.tds\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    if  (!bdReadFile(argv[1], image) || dir.empty())
+    {
+        fprintf(stderr, "bdfiles: can't read %s or make a directory\n", argv[1]);
+        return 2;
+    }
+
+    bdCheckPool(dir, image);
+    bdCheckWatch(dir, image);
+
+    rmdir(dir.c_str());
+    return bdCheckResult("bdfiles");
+}
@@ -0,0 +1,191 @@
+//---------------------------------------------------------------------
+
+/*
+    Checks the sstNames index of a file large enough to be scanned in
+    parts, see bdScanNames, and to be compacted, see bdCompactNames.
+
+    Every name must come out as it does from a serial scan into the
+    full offsets: one thread and BORDEBUG_REGISTER_CACHENAMES.  Runs
+    of names over 255 bytes, some with a 0 length byte, are put over
+    the places where the section is split for 2, 3 and 4 parts, so a
+    part starts in the middle of one.
+
+    usage: bdlarge large.tds     (mksample.py large.tds 8 350000)
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "../bordebug.h"
+#include "bdtest.h"
+
+
+//---------------------------------------------------------------------
+
+static std::vector<std::string> bdAllNames(BorDebugCookie cookie)
+{
+    std::vector<std::string>    names;
+
+    for (unsigned i = 1; i <= BorDebugNamesTotalNames(cookie); i++)
+    {
+        const char    * text = 0;
+        unsigned        len  = BorDebugNameIndexToNameView(cookie, i, &text);
+
+        names.push_back(std::string(text, len));
+    }
+
+    return names;
+}
+
+
+/*
+    Long names that take up exactly "bytes", a length byte and a 0
+    each, the first with a 0 length byte
+*/
+
+static void bdLongNames(uint32_t bytes, std::vector<std::string> & run)
+{
+    static const unsigned   lengths[] = { 256, 300, 512, 257, 400, 511, 768 };
+
+    for (unsigned i = 0; bytes; i++)
+    {
+        uint32_t    len = lengths[i % (sizeof(lengths) / sizeof(lengths[0]))];
+
+        // what is left must make a long name of its own
+        if  (len + 2 > bytes || bytes - len - 2 < 258)
+            len = bytes - 2;
+
+        std::string     tag = std::to_string(run.size());
+
+        run.push_back("@Long@" + tag + std::string(len - 9 - tag.size(), 'n') + "$qv");
+        bytes -= len + 2;
+    }
+}
+
+
+/*
+    Replace the names around "split" by long ones that take up the
+    same bytes, so the size of the section and with it every split
+    stays where it was.  A name with a 0 length byte starts right at
+    the split, where a part would take the 0 for the end of a name.
+*/
+
+static void bdLongNamesAt(std::vector<std::string> & names, uint32_t split)
+{
+    uint32_t    pos   = 4;
+    size_t      first = 0;
+
+    // the names from 2 KB before the split to 2 KB after it
+    while (first < names.size() && pos + names[first].size() + 2 < split - 0x800)
+        pos += (uint32_t)names[first++].size() + 2;
+
+    size_t      last  = first;
+    uint32_t    bytes = 0;
+
+    while (last < names.size() && pos + bytes < split + 0x800)
+        bytes += (uint32_t)names[last++].size() + 2;
+
+    std::vector<std::string>    run;
+
+    bdLongNames(split - pos, run);
+    bdLongNames(pos + bytes - split, run);
+
+    names.erase(names.begin() + first, names.begin() + last);
+    names.insert(names.begin() + first, run.begin(), run.end());
+}
+
+
+static bool bdMakeLongNames(const char * fileName, const std::string & copyName, std::vector<std::string> & names)
+{
+    std::vector<unsigned char>  image;
+    unsigned                    failure = ~0u;
+    BorDebugCookie              cookie  = BorDebugRegisterFileEx(fileName, 0, &failure);
+
+    if  (!cookie || !bdReadFile(fileName, image))
+        return false;
+
+    names = bdAllNames(cookie);
+    BorDebugUnregisterFile(cookie);
+
+    uint32_t    size = 4;
+
+    for (size_t i = 0; i < names.size(); i++)
+        size += (uint32_t)names[i].size() + 2;
+
+    for (uint32_t parts = 2; parts <= 4; parts++)
+    {
+        for (uint32_t k = 1; k < parts; k++)
+            bdLongNamesAt(names, 4 + (size - 4) / parts * k);
+    }
+
+    return bdSetNames(image, names) && bdWriteFile(copyName.c_str(), image);
+}
+
+
+static std::vector<std::string> bdNamesWith(const char * fileName, unsigned threads, unsigned options)
+{
+    std::vector<std::string>    names;
+    unsigned                    failure = ~0u;
+
+    BorDebugSetThreadCount(threads);
+
+    BorDebugCookie  cookie = BorDebugRegisterFileEx(fileName, options | BORDEBUG_REGISTER_EAGER, &failure);
+
+    CHECK(cookie != 0 && failure == 0);
+    if  (cookie)
+    {
+        names = bdAllNames(cookie);
+        BorDebugUnregisterFile(cookie);
+    }
+
+    return names;
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc != 2)
+    {
+        fprintf(stderr, "usage: %s large.tds\n", argv[0]);
+        return 2;
+    }
+
+    std::string                 dir = bdTempDir();
+    std::string                 copyName = dir + "/long.tds";
+    std::vector<std::string>    longNames;
+
+    CHECK(!dir.empty() && bdMakeLongNames(argv[1], copyName, longNames));
+
+    const char  * files[] = { argv[1], copyName.c_str() };
+
+    for (const char * fileName : files)
+    {
+        std::vector<std::string>    serial = bdNamesWith(fileName, 1, BORDEBUG_REGISTER_CACHENAMES);
+
+        CHECK(serial.size() > 300000);
+        if  (fileName != argv[1])
+            CHECK(serial == longNames);
+
+        for (unsigned threads = 2; threads <= 4; threads++)
+        {
+            CHECK(bdNamesWith(fileName, threads, 0) == serial);
+            CHECK(bdNamesWith(fileName, threads, BORDEBUG_REGISTER_CACHENAMES) == serial);
+            CHECK(bdNamesWith(fileName, threads, BORDEBUG_REGISTER_MAP) == serial);
+        }
+
+        CHECK(bdNamesWith(fileName, 1, 0) == serial);
+    }
+
+    BorDebugSetThreadCount(0);
+
+    unlink(copyName.c_str());
+    rmdir(dir.c_str());
+    return bdCheckResult("bdlarge");
+}
@@ -0,0 +1,219 @@
+//---------------------------------------------------------------------
+
+/*
+    Checks BorDebugLoadFiles against BorDebugRegisterFileEx, file by
+    file: good files, a truncated one, junk, a missing one and one
+    with another extension must get the same cookies and the same
+    failure codes.
+
+    The checks run twice: in a child process where io_uring_setup
+    is turned down, so the reads go through the fallback, and then
+    as usual.
+
+    usage: bdload sample.tds
+*/
+
+//---------------------------------------------------------------------
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if __has_include(<linux/seccomp.h>)
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "../bordebug.h"
+#include "bdtest.h"
+
+
+//---------------------------------------------------------------------
+
+// Same names and types, or both not registered
+static void bdCheckSame(BorDebugCookie loaded, BorDebugCookie registered, const char * fileName)
+{
+    CHECK((loaded != 0) == (registered != 0));
+    if  (!loaded || !registered)
+        return;
+
+    CHECK(BorDebugSubSectionCount(loaded) == BorDebugSubSectionCount(registered));
+    CHECK(BorDebugNamesTotalNames(loaded) == BorDebugNamesTotalNames(registered));
+
+    char    a[512];
+    char    b[512];
+
+    for (unsigned i = 1; i <= BorDebugNamesTotalNames(registered); i++)
+    {
+        BorDebugNameIndexToName(loaded, i, a, sizeof(a));
+        BorDebugNameIndexToName(registered, i, b, sizeof(b));
+        CHECK_STR(a, b);
+    }
+
+    BorDebugTypeIndexToString(loaded, 0x1000, a, sizeof(a));
+    BorDebugTypeIndexToString(registered, 0x1000, b, sizeof(b));
+    CHECK_STR(a, b);
+
+    if  (bdFailures)
+        fprintf(stderr, "bdload: in %s\n", fileName);
+}
+
+
+static void bdCheckLoad(const std::string & dir, const std::vector<unsigned char> & image)
+{
+    std::vector<unsigned char>  truncated(image.begin(), image.begin() + image.size() / 2);
+    std::vector<unsigned char>  junk(image.size());
+    std::vector<unsigned char>  large = image;
+    std::vector<std::string>    fileNames;
+
+    for (size_t i = 0; i < junk.size(); i++)
+        junk[i] = (unsigned char)(i * 7 + 3);
+
+    // more names than one read of the edges takes
+    std::vector<std::string>    names;
+
+    for (unsigned i = 0; i < 5000; i++)
+        names.push_back("@Load@name" + std::to_string(i) + "$qv");
+
+    CHECK(bdSetNames(large, names));
+
+    fileNames.push_back(dir + "/good.tds");
+    fileNames.push_back(dir + "/truncated.tds");
+    fileNames.push_back(dir + "/junk.tds");
+    fileNames.push_back(dir + "/missing.tds");
+    fileNames.push_back(dir + "/large.tds");
+    fileNames.push_back(dir + "/good.txt");
+
+    CHECK(bdWriteFile(fileNames[0].c_str(), image));
+    CHECK(bdWriteFile(fileNames[1].c_str(), truncated));
+    CHECK(bdWriteFile(fileNames[2].c_str(), junk));
+    CHECK(bdWriteFile(fileNames[4].c_str(), large));
+    CHECK(bdWriteFile(fileNames[5].c_str(), image));
+
+    // the good ones more than once, and more files than are loaded
+    // at a time
+    std::vector<const char *>   list;
+
+    for (unsigned i = 0; i < 300; i++)
+        list.push_back(fileNames[i % fileNames.size()].c_str());
+
+    static const unsigned   options[] = { 0, BORDEBUG_REGISTER_CACHENAMES, BORDEBUG_REGISTER_SKIPTYPES };
+
+    for (unsigned option : options)
+    {
+        std::vector<BorDebugCookie> cookies(list.size());
+        std::vector<unsigned>       failures(list.size(), ~0u);
+
+        BorDebugLoadFiles(&list[0], (unsigned)list.size(), option, &cookies[0], &failures[0]);
+
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            unsigned        failure    = ~0u;
+            BorDebugCookie  registered = BorDebugRegisterFileEx(list[i], option, &failure);
+
+            CHECK(failures[i] == failure);
+            bdCheckSame(cookies[i], registered, list[i]);
+
+            if  (cookies[i])
+                BorDebugUnregisterFile(cookies[i]);
+            if  (registered)
+                BorDebugUnregisterFile(registered);
+        }
+    }
+
+    // what each file should give
+    unsigned        failure = ~0u;
+
+    CHECK(BorDebugRegisterFileEx(fileNames[1].c_str(), 0, &failure) == 0 && failure == 4);
+    CHECK(BorDebugRegisterFileEx(fileNames[3].c_str(), 0, &failure) == 0 && failure == 2);
+    CHECK(BorDebugRegisterFileEx(fileNames[5].c_str(), 0, &failure) == 0 && failure == 1);
+
+    for (size_t i = 0; i < fileNames.size(); i++)
+        unlink(fileNames[i].c_str());
+}
+
+
+/*
+    Turn down io_uring_setup with ENOSYS for this process, as on a
+    kernel without io_uring.  False when that can't be done.
+*/
+
+static bool bdNoRing()
+{
+#if defined(SECCOMP_MODE_FILTER) && defined(__NR_io_uring_setup)
+    struct sock_filter  filter[] =
+    {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_setup, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | ENOSYS),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+    };
+    struct sock_fprog   program = { sizeof(filter) / sizeof(filter[0]), filter };
+
+    if  (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0 ||
+         prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) != 0)
+        return false;
+
+    return syscall(__NR_io_uring_setup, 1, 0) < 0 && errno == ENOSYS;
+#else
+    return false;
+#endif
+}
+
+
+//---------------------------------------------------------------------
+
+int main(int argc, char ** argv)
+{
+    if  (argc != 2)
+    {
+        fprintf(stderr, "usage: %s sample.tds\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<unsigned char>  image;
+    std::string                 dir = bdTempDir();
+
+    if  (!bdReadFile(argv[1], image) || dir.empty())
+    {
+        fprintf(stderr, "bdload: can't read %s or make a directory\n", argv[1]);
+        return 2;
+    }
+
+    // before the library starts any threads
+    pid_t   child = fork();
+
+    if  (child == 0)
+    {
+        if  (!bdNoRing())
+        {
+            printf("bdload: fallback skipped, can't turn down io_uring\n");
+            fflush(stdout);
+            _exit(0);
+        }
+
+        bdCheckLoad(dir, image);
+
+        int result = bdCheckResult("bdload without io_uring");
+
+        fflush(stdout);
+        _exit(result);
+    }
+
+    int     status = 0;
+
+    CHECK(child > 0 && waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    bdCheckLoad(dir, image);
+
+    rmdir(dir.c_str());
+    return bdCheckResult("bdload");
+}
@@ -0,0 +1,177 @@
+#ifndef BDTEST_H
+#define BDTEST_H
+
+//---------------------------------------------------------------------
+
+/*
+    Check macros shared by the test programs.  A failed check is
+    reported with its line and counted in bdFailures; main returns
+    non-zero when there were any.
+*/
+
+//---------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+
+static unsigned bdFailures;
+
+
+#define CHECK(cond)                                                     \
+    do                                                                  \
+    {                                                                   \
+        if  (!(cond))                                                   \
+        {                                                               \
+            fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__,   \
+                    #cond);                                             \
+            bdFailures++;                                               \
+        }                                                               \
+    } while (0)
+
+
+#define CHECK_STR(got, want)                                            \
+    do                                                                  \
+    {                                                                   \
+        if  (strcmp((got), (want)) != 0)                                \
+        {                                                               \
+            fprintf(stderr, "%s:%d: got \"%s\", want \"%s\"\n",         \
+                    __FILE__, __LINE__, (got), (want));                 \
+            bdFailures++;                                               \
+        }                                                               \
+    } while (0)
+
+
+inline bool bdReadFile(const char * fileName, std::vector<unsigned char> & data)
+{
+    FILE          * fp = fopen(fileName, "rb");
+    unsigned char   buf[4096];
+    size_t          got;
+
+    data.clear();
+
+    if  (!fp)
+        return false;
+
+    while ((got = fread(buf, 1, sizeof(buf), fp)) != 0)
+        data.insert(data.end(), buf, buf + got);
+
+    fclose(fp);
+    return !data.empty();
+}
+
+
+inline bool bdWriteFile(const char * fileName, const std::vector<unsigned char> & data)
+{
+    FILE    * fp = fopen(fileName, "wb");
+    bool      ok = fp && fwrite(data.data(), 1, data.size(), fp) == data.size();
+
+    if  (fp && fclose(fp) != 0)
+        ok = false;
+
+    return ok;
+}
+
+
+// A new directory under $TMPDIR or /tmp, or "" if it can't be made
+inline std::string bdTempDir()
+{
+    const char  * dir = getenv("TMPDIR");
+    char          path[4096];
+
+    snprintf(path, sizeof(path), "%s/bdtestXXXXXX", dir && *dir ? dir : "/tmp");
+
+    return mkdtemp(path) ? path : "";
+}
+
+
+inline uint32_t bdGet32(const unsigned char * p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+
+inline void bdPut32(unsigned char * p, uint32_t value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+
+/*
+    Give a .tds made by mksample.py other names: its sstNames is the
+    last subsection, right before the directory, so the new one takes
+    its place and the directory moves.  A name over 255 bytes gets
+    255 in its length byte, as a linker writes it.
+*/
+
+inline bool bdSetNames(std::vector<unsigned char> & image, const std::vector<std::string> & names)
+{
+    if  (image.size() < 8)
+        return false;
+
+    uint32_t    dir   = bdGet32(&image[4]);
+    uint32_t    count = dir + 16 <= image.size() ? bdGet32(&image[dir + 4]) : 0;
+    uint32_t    entry = 0;
+
+    if  (dir + 16 + (uint64_t)count * 12 > image.size())
+        return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if  ((image[dir + 16 + i * 12] | image[dir + 17 + i * 12] << 8) == 0x130)
+            entry = dir + 16 + i * 12;
+    }
+
+    if  (!entry || bdGet32(&image[entry + 4]) > dir)
+        return false;
+
+    std::vector<unsigned char>  directory(image.begin() + dir, image.begin() + dir + 16 + count * 12);
+    uint32_t                    offset = bdGet32(&image[entry + 4]);
+    uint32_t                    at     = entry - dir;
+
+    image.resize(offset + 4);
+    bdPut32(&image[offset], (uint32_t)names.size());
+
+    for (const std::string & name : names)
+    {
+        image.push_back((unsigned char)(name.size() < 255 ? name.size() : 255));
+        image.insert(image.end(), name.begin(), name.end());
+        image.push_back(0);
+    }
+
+    uint32_t    size = (uint32_t)image.size() - offset;
+
+    while (image.size() % 4)
+        image.push_back(0);
+
+    dir = (uint32_t)image.size();
+    image.insert(image.end(), directory.begin(), directory.end());
+    bdPut32(&image[4], dir);
+    bdPut32(&image[dir + at + 8], size);
+
+    return true;
+}
+
+
+inline int  bdCheckResult(const char * test)
+{
+    if  (bdFailures)
+    {
+        fprintf(stderr, "%s: %u failures\n", test, bdFailures);
+        return 1;
+    }
+
+    printf("%s: all checks passed\n", test);
+    return 0;
+}
+
+
+#endif
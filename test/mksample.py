@@ -0,0 +1,77 @@
+#---------------------------------------------------------------------
+#
+#   Writes the sample.tds test fixture: an 'FB09' .tds with nmods
+#   sstModule, sstAlignSym and sstSrcModule subsections, a small
+#   sstGlobalTypes and an sstNames with a few mangled names.
+#
+#   usage: mksample.py out.tds nmods [nnames_extra]
+#
+#   sample.tds is made with: mksample.py sample.tds 3
+#
+#---------------------------------------------------------------------
+
+import struct, sys
+
+out = sys.argv[1]; nmods = int(sys.argv[2]); extra = int(sys.argv[3]) if len(sys.argv) > 3 else 0
+names = []
+def name(s):
+    names.append(s); return len(names)
+mangled = ["@System@AnsiString@$bctr$qqrv", "@Foo@bar$qipxc", "@Sysutils@Exception@$bctr$qqrx17System@AnsiString",
+           "@$xt$14System@TObject", "@std@%vector$i%@size$xqv", "plain_c_name", "@Foo@$basg$qrx3Foo", "@Foo@$bdtr$qv", "@bad@$z"]
+mangled_idx = [name(m) for m in mangled]
+secs = []  # (type, imod, bytes)
+for m in range(nmods):
+    mn = name("module%d.cpp" % m)
+    mod = struct.pack('<HHHHII12x', 0, 0, 1, 0x5643, mn, 1000 + m) + struct.pack('<HHII', 1, 1, 0x100 * m, 0x100)
+    secs.append((0x120, m + 1, mod))
+for m in range(nmods):
+    pn = name("@Foo@func%d$qi" % m); vn = name("arg%d" % m)
+    syms = b''
+    # GPROC32: 7 DWORDs (parent,end,next,len,dbgstart,dbgend,offset), WORD seg, WORD flags, type, name, browser
+    body = struct.pack('<7IHHIII', 0, 0, 0, 16, 1, 15, 0x100 * m, 1, 0, 0x1000, pn, 0)
+    syms += struct.pack('<HH', len(body) + 2, 0x205) + body
+    body = struct.pack('<IIII', 8, 0x74, vn, 0)
+    syms += struct.pack('<HH', len(body) + 2, 0x200) + body
+    syms += struct.pack('<HH', 2, 6)
+    secs.append((0x125, m + 1, struct.pack('<I', 1) + syms))
+for m in range(nmods):
+    fn = name("src%d.cpp" % m)
+    # module header: cFile=1,cSeg=1, baseSrcFile[1], start/end, seg
+    hdr_len = 4 + 4 + 8 + 2
+    hdr_len = (hdr_len + 3) & ~3
+    file_off = hdr_len
+    file_entry_len = 2 + 4 + 4 + 8
+    lines_off = file_off + file_entry_len
+    hdr = struct.pack('<HHI II H', 1, 1, file_off, 0x100 * m, 0x100 * m + 0x10, 1)
+    hdr += b'\0' * (hdr_len - len(hdr))
+    fe = struct.pack('<HIIII', 1, fn, lines_off, 0x100 * m, 0x100 * m + 0x10)
+    lt = struct.pack('<HH', 1, 2) + struct.pack('<II', 0x100 * m, 0x100 * m + 8) + struct.pack('<HH', 10, 11)
+    secs.append((0x127, m + 1, hdr + fe + lt))
+# global types: 0x1000 = pointer to int (0x74), 0x1001 class named "Foo"
+types = []
+types.append(struct.pack('<HHI', 2, 0x0A, 0x74))  # leaf LF_POINTER=2 attrib 0x0A (near32) type int
+cn = name("Foo")
+types.append(struct.pack('<HHHIIIIH', 4, 0, 0, 0, 0, 0, cn, 8))  # leaf CLASS: count,prop,field,derived,vshape,name? approximate
+recs = b''; offs = []
+for t in types:
+    offs.append(len(recs)); recs += struct.pack('<H', len(t)) + t
+gt = struct.pack('<II', 1, len(types)) + b''.join(struct.pack('<I', o) for o in offs) + recs
+secs.append((0x12B, 0xFFFF, gt))
+for i in range(extra):
+    name("@Ns%d@Cls%d@method%d$qqrx17System@AnsiStringi" % (i % 97, i % 1013, i))
+parts = [struct.pack('<I', len(names))]
+for s in names:
+    b = s.encode(); parts.append(struct.pack('<B', min(len(b), 255)) + b + b'\0')
+nm = b''.join(parts)
+secs.append((0x130, 0xFFFF, nm))
+data = bytearray(struct.pack('<II', 0x39304246, 0))
+dirents = []
+for t, im, b in secs:
+    while len(data) % 4: data.append(0)
+    dirents.append(struct.pack('<HHII', t, im, len(data), len(b))); data += b
+while len(data) % 4: data.append(0)
+diroff = len(data)
+data += struct.pack('<HHIII', 16, 12, len(dirents), 0, 0) + b''.join(dirents)
+struct.pack_into('<I', data, 4, diroff)
+open(out, 'wb').write(data)
+print("names", len(names), "bytes", len(data))